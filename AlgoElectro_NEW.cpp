@@ -5,6 +5,8 @@
 #include "omp.h"
 #include "mpi.h"
 #include <algorithm>
+#include <cstdint>
+#include <thread>
 #include <sys/time.h>
 
 #include <sys/types.h>
@@ -16,10 +18,13 @@
 #include <assert.h>
 
 #include "header_with_all_defines.hpp"
+#include "AlignedMemory.hpp"
 
 #define NBR_FACES_CUBE 6
 
 #define DECALAGE_E_SUPP 1
+/// Tag of the sizes of the fields sent to the neighbours of the same node (see init_shared_memory_halo):
+#define TAG_SHARED_HALO_SIZES 31
 
 #include <sys/file.h>
  #define   LOCK_SH   1    /* shared lock */
@@ -71,143 +76,213 @@ void testlock(void) {
 
 
 
-void prepare_array_to_be_sent(
-                double ** Electric_field_to_send,
-                double ** Magnetic_field_to_send,
-                std::vector<size_t> &electric_field_sizes,
-                std::vector<size_t> &magnetic_field_sizes,
-                double *E_x,
-                double *E_y,
-                double *E_z,
-                double *H_x,
-                double *H_y,
-                double *H_z,
-                int    *mpi_rank_neighboor,
-                #ifndef NDEBUG
-                    std::vector<size_t> &size_faces_electric,
-                    std::vector<size_t> &size_faces_magnetic,
-                #endif
-                bool is_electric_to_prepare
-            );
-            
-void use_received_array(
-                double **Electric_field_to_recv,
-                double **Magnetic_field_to_recv,
-                std::vector<size_t> &electric_field_sizes,
-                std::vector<size_t> &magnetic_field_sizes,
-                double *E_x,
-                double *E_y,
-                double *E_z,
-                double *H_x,
-                double *H_y,
-                double *H_z,
-                int    *mpi_rank_neighboor,
-                #ifndef NDEBUG
-                    std::vector<size_t> &size_faces_electric,
-                    std::vector<size_t> &size_faces_magnetic,
-                #endif
-                bool is_electric_to_use
-            );   
-
-void communicate_single_omp_thread(
-                double **Electric_field_to_send,
-                double **Electric_field_to_recv,
-                double **Magnetic_field_to_send,
-                double **Magnetic_field_to_recv,
-                int *mpi_to_who,
-                int  mpi_me,
-                std::vector<size_t> size_faces_electric,
-                std::vector<size_t> size_faces_magnetic,
-                bool is_electric_to_communicate
-);
+/// MPI datatype of the nodes of the fields (double or float):
+template<typename FIELD_TYPE>
+inline MPI_Datatype MPI_datatype_of_field(void);
+
+template<>
+inline MPI_Datatype MPI_datatype_of_field<double>(void){
+    return MPI_DOUBLE;
+}
+
+template<>
+inline MPI_Datatype MPI_datatype_of_field<float>(void){
+    return MPI_FLOAT;
+}
+
+/**
+ * @brief Datatype of the nodes of the two components tangential to the face FACE (among F_x, F_y, F_z)
+ *        exchanged with its neighbour, taken directly in the field arrays (to be used with MPI_BOTTOM).
+ *
+ * The normal component is never used in the ghost planes by the Yee updates, so it is not exchanged.
+ * The plane next to the face is sent (1 or size-2), the ghost plane is received (0 or size-1),
+ * in both cases without the ghost nodes of its edges. The nodes are ordered by component (x, y, z),
+ * then as in the arrays (I first), which is the same order on both sides of the face.
+ * Must be freed with MPI_Type_free.
+ */
+template<typename FIELD_TYPE>
+MPI_Datatype create_halo_face_datatype(
+                unsigned int FACE,
+                bool is_ghost_plane,
+                FIELD_TYPE *F_x,
+                FIELD_TYPE *F_y,
+                FIELD_TYPE *F_z,
+                const std::vector<size_t> *field_sizes[3]
+            )
+{
+    /// Faces 0 and 1 are normal to x, 2 and 3 to y, 4 and 5 to z. Faces 0, 3 and 5 are at the end of the axis:
+    unsigned int direction = FACE / 2;
+    bool         is_end    = FACE == 0 || FACE == 3 || FACE == 5;
+
+    FIELD_TYPE  *F[3] = {F_x,F_y,F_z};
+
+    MPI_Datatype component_types[2];
+    MPI_Aint     component_addresses[2];
+    int          block_lengths[2] = {1,1};
+    unsigned int nbr_components = 0;
+
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        if(c == direction){continue;}
+        const std::vector<size_t> &size = *field_sizes[c];
+
+        /// Subarray in C order (K, J, I), without the ghost nodes of the edges:
+        int sizes   [3];
+        int subsizes[3];
+        int starts  [3];
+        for(unsigned int d = 0 ; d < 3 ; d ++){
+            sizes   [2-d] = static_cast<int>(size[d]);
+            subsizes[2-d] = static_cast<int>(size[d]) - 2*DECALAGE_E_SUPP;
+            starts  [2-d] = DECALAGE_E_SUPP;
+        }
+        subsizes[2-direction] = 1;
+        if(is_end){
+            starts[2-direction] = static_cast<int>(size[direction]) - (is_ghost_plane ? 1 : 2);
+        }else{
+            starts[2-direction] = is_ghost_plane ? 0 : 1;
+        }
 
-void determine_size_face_based_on_direction(
-        char direction,
-        std::vector<size_t> &electric_field_sizes,
-        std::vector<size_t> &magnetic_field_sizes,
-        size_t *size_of_sent_vector_electric,
-        size_t *size_of_sent_vector_magnetic){
+        MPI_Type_create_subarray(3,sizes,subsizes,starts,MPI_ORDER_C,
+            MPI_datatype_of_field<FIELD_TYPE>(),&component_types[nbr_components]);
+        MPI_Get_address(F[c],&component_addresses[nbr_components]);
+        nbr_components ++;
+    }
 
-    /// We don't want to send the neighboors to others, so just do 'minus two' everywhere.
-    size_t SEND_ALL = 2;
+    MPI_Datatype face_type;
+    MPI_Type_create_struct(2,block_lengths,component_addresses,component_types,&face_type);
+    MPI_Type_commit(&face_type);
 
-    /// Reset the sizes of the vectors to be sent to zero:
-    *size_of_sent_vector_electric = 0;
-    *size_of_sent_vector_magnetic = 0;
+    for(unsigned int c = 0 ; c < 2 ; c ++){
+        MPI_Type_free(&component_types[c]);
+    }
 
-    if(direction == 'S' || direction == 'N'){
+    return face_type;
+}
 
-        /// Compute size of the data to be sent for the electric field:
+/**
+ * @brief Datatype of the layers of nodes exchanged with the neighbour of the face FACE when the fields have
+ *        several ghost layers (see GridCreator_NEW::ghost_layers), to be used with MPI_BOTTOM.
+ *
+ * For each array, the nbr_layers layers of this process next to the face are sent, and the nbr_layers
+ * layers at the end of the array are received (is_ghost_layer). The whole face is exchanged, with the ghost
+ * nodes of the other directions. The arrays are in the same order on both sides of the face.
+ * Must be freed with MPI_Type_free.
+ */
+template<typename FIELD_TYPE>
+MPI_Datatype create_ghost_layers_face_datatype(
+                unsigned int FACE,
+                bool is_ghost_layer,
+                const std::vector<GhostLayersArray<FIELD_TYPE> > &arrays
+            )
+{
+    /// Faces 0 and 1 are normal to x, 2 and 3 to y, 4 and 5 to z. Faces 0, 3 and 5 are at the end of the axis:
+    unsigned int direction = FACE / 2;
+    bool         is_end    = FACE == 0 || FACE == 3 || FACE == 5;
+
+    std::vector<MPI_Datatype> array_types    (arrays.size());
+    std::vector<MPI_Aint>     array_addresses(arrays.size());
+    std::vector<int>          block_lengths  (arrays.size(),1);
+
+    for(size_t a = 0 ; a < arrays.size() ; a ++){
+        const size_t *size       = arrays[a].size;
+        size_t        nbr_layers = arrays[a].nbr_layers;
+
+        /// Subarray in C order (K, J, I), with the ghost nodes of the edges:
+        int sizes   [3];
+        int subsizes[3];
+        int starts  [3];
+        for(unsigned int d = 0 ; d < 3 ; d ++){
+            sizes   [2-d] = static_cast<int>(size[d]);
+            subsizes[2-d] = static_cast<int>(size[d]);
+            starts  [2-d] = 0;
+        }
+        subsizes[2-direction] = static_cast<int>(nbr_layers);
+        if(is_end){
+            starts[2-direction] = static_cast<int>(size[direction] - (is_ghost_layer ? 1 : 2) * nbr_layers);
+        }else{
+            starts[2-direction] = is_ghost_layer ? 0 : static_cast<int>(nbr_layers);
+        }
 
-        /// size += size_ex[1]*size_ex[2] (without neighboors):
-        *size_of_sent_vector_electric += (electric_field_sizes[1]-SEND_ALL)    *(electric_field_sizes[2]-SEND_ALL);
-        /// size += size_ey[1]*size_ey[2] (without neighboors):
-        *size_of_sent_vector_electric += (electric_field_sizes[1+3]-SEND_ALL)  *(electric_field_sizes[2+3]-SEND_ALL);
-        /// size += size_ez[1]*size_ez[2] (without neighboors):
-        *size_of_sent_vector_electric += (electric_field_sizes[1+2*3]-SEND_ALL)*(electric_field_sizes[2+2*3]-SEND_ALL);
+        MPI_Type_create_subarray(3,sizes,subsizes,starts,MPI_ORDER_C,
+            MPI_datatype_of_field<FIELD_TYPE>(),&array_types[a]);
+        MPI_Get_address(arrays[a].nodes,&array_addresses[a]);
+    }
 
-        /// Compute size of the data to be sent for the magnetic field:
+    MPI_Datatype face_type;
+    MPI_Type_create_struct(static_cast<int>(arrays.size()),block_lengths.data(),array_addresses.data(),
+        array_types.data(),&face_type);
+    MPI_Type_commit(&face_type);
 
-        /// size += size_hx[1]*size_hx[2] (without neighboors):
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[1]-SEND_ALL)    *(magnetic_field_sizes[2]-SEND_ALL);
-        /// size += size_hy[1]*size_hy[2] (without neighboors):
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[1+3]-SEND_ALL)  *(magnetic_field_sizes[2+3]-SEND_ALL);
-        /// size += size_hz[1]*size_hz[2] (without neighboors):
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[1+2*3]-SEND_ALL)*(magnetic_field_sizes[2+2*3]-SEND_ALL);
+    for(size_t a = 0 ; a < arrays.size() ; a ++){
+        MPI_Type_free(&array_types[a]);
+    }
 
+    return face_type;
+}
 
-    }else if(direction == 'W' || direction == 'E'){
+void init_halo_exchange(
+                const MPI_Datatype *face_to_send,
+                const MPI_Datatype *face_to_recv,
+                int *mpi_to_who,
+                int  mpi_me,
+                int  tag_offset,
+                bool per_face_threads,
+                HaloExchange &halo
+);
 
-        /// Compute size of the data to be sent for the electric field:
+int halo_face_thread(const HaloExchange &halo, unsigned int FACE);
 
-        /// size += size_ex[0]*size_ex[2] (without neighboors):
-        *size_of_sent_vector_electric += (electric_field_sizes[0]-SEND_ALL) * (electric_field_sizes[2]-SEND_ALL);
-        /// size += size_ey[0]*size_ey[2] (without neighboors):
-        *size_of_sent_vector_electric += (electric_field_sizes[3]-SEND_ALL) * (electric_field_sizes[5]-SEND_ALL);
-        /// size += size_ez[0]*size_ez[2] (without neighboors):
-        *size_of_sent_vector_electric += (electric_field_sizes[6]-SEND_ALL) * (electric_field_sizes[8]-SEND_ALL);
+void start_halo_exchange(HaloExchange &halo);
 
-        /// Compute size of the data to be sent for the magnetic field:
+void wait_halo_exchange(HaloExchange &halo);
 
-        /// size += size_hx[0]*size_hx[2] (without neighboors):
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[0]-SEND_ALL)*(magnetic_field_sizes[2]-SEND_ALL);
-        /// size += size_hy[0]*size_hy[2] (without neighboors):
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[3]-SEND_ALL)*(magnetic_field_sizes[5]-SEND_ALL);
-        /// size += size_z[0]*size_hz[2] (without neighboors):
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[6]-SEND_ALL)*(magnetic_field_sizes[8]-SEND_ALL);
+void free_halo_exchange(HaloExchange &halo);
 
-    }else if(direction == 'U' || direction == 'D'){
+template<typename FIELD_TYPE>
+void init_shared_memory_halo(
+                GridCreator_NEW &grid,
+                bool is_electric,
+                MPI_Win progress_window,
+                SharedMemoryHalo<FIELD_TYPE> &halo
+);
 
-        /// Compute size of the data to be sent for the electric field:
+template<typename FIELD_TYPE>
+void start_shared_memory_halo(SharedMemoryHalo<FIELD_TYPE> &halo);
 
-        /// size += size_ex[0]*size_ex[1]:
-        *size_of_sent_vector_electric += (electric_field_sizes[0]-SEND_ALL)*(electric_field_sizes[1]-SEND_ALL);
-        /// size += size_ey[0]*size_ey[1]:
-        *size_of_sent_vector_electric += (electric_field_sizes[3]-SEND_ALL)*(electric_field_sizes[4]-SEND_ALL);
-        /// size += size_ez[0]*size_ez[1]:
-        *size_of_sent_vector_electric += (electric_field_sizes[6]-SEND_ALL)*(electric_field_sizes[7]-SEND_ALL);
+template<typename FIELD_TYPE>
+void wait_shared_memory_halo(SharedMemoryHalo<FIELD_TYPE> &halo);
 
-        /// size += size_ex[0]*size_ex[1]:
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[0]-SEND_ALL)*(magnetic_field_sizes[1]-SEND_ALL);
-        /// size += size_ey[0]*size_ey[1]:
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[3]-SEND_ALL)*(magnetic_field_sizes[4]-SEND_ALL);
-        /// size += size_ez[0]*size_ez[1]:
-        *size_of_sent_vector_magnetic += (magnetic_field_sizes[6]-SEND_ALL)*(magnetic_field_sizes[7]-SEND_ALL);
+/**
+ * @brief Value of the electric field imposed on a source node at time t.
+ */
+inline double source_value(
+        unsigned char        ID_Source,
+        std::vector<double> &local_nodes_inside_source_FREQ,
+        bool                 MODULATE_SOURCE,
+        double               current_time)
+{
+    double gauss     = 1;
+    double frequency = 0;
 
+    if(ID_Source == UCHAR_MAX){
+        frequency = 0;
     }else{
-        fprintf(stderr,"In function %s :: unknown direction ! (has %c) -> ABORTING\n",
-            __FUNCTION__,direction);
-        fprintf(stderr,"In %s:%d\n",__FILE__,__LINE__);
-        #ifdef MPI_COMM_WORLD
-        MPI_Abort(MPI_COMM_WORLD,-1);
-        #else
-        abort();
-        #endif
+
+        frequency = local_nodes_inside_source_FREQ[ID_Source];
+
+        if(MODULATE_SOURCE == true){
+            double period    = 2*M_PI/frequency;
+            double MEAN      = 0*period;
+            double STD       = period/10;
+
+            double t = current_time;
+
+            gauss = exp(-((t-MEAN)*(t-MEAN))/(2*STD*STD));
+        }
     }
 
+    return gauss * sin(2*M_PI*frequency*current_time);
 }
 
-
 /**
  * @brief Compute the smallest time step required for the algorithm statibility.
  */
@@ -254,10 +329,366 @@ double AlgoElectro_NEW::Compute_dt(GridCreator_NEW &mesh){
     return dt;
 }
 
+/**
+ * @brief Compute the update coefficients of one component for each material.
+ *
+ * The properties of each material are read from the nodes (eps_or_mu and conductivity arrays).
+ * All the nodes of a given material must have the same properties, otherwise false is returned
+ * and the caller must use per-node coefficients. Materials not present on this process get zero coefficients.
+ */
+template<typename COEF_TYPE>
+bool AlgoElectro_NEW::compute_coefficients_per_material(
+    const unsigned char *material,
+    const double *eps_or_mu,
+    const double *conductivity,
+    size_t        size,
+    unsigned int  nbr_materials,
+    double        dt,
+    double        delta_1,
+    double        delta_2,
+    COEF_TYPE    *C_self,
+    COEF_TYPE    *C_curl_1,
+    COEF_TYPE    *C_curl_2)
+{
+    /// Properties of each material (eps or mu, and conductivity), and whether it was found:
+    std::vector<double> prop_eps (nbr_materials,0.0);
+    std::vector<double> prop_cond(nbr_materials,0.0);
+    std::vector<char>   found    (nbr_materials,0);
+    bool is_consistent = true;
+    bool is_valid_ID   = true;
+
+    #pragma omp parallel default(none)\
+        shared(material,eps_or_mu,conductivity,size,nbr_materials)\
+        shared(prop_eps,prop_cond,found,is_consistent,is_valid_ID)
+    {
+        std::vector<double> local_eps (nbr_materials,0.0);
+        std::vector<double> local_cond(nbr_materials,0.0);
+        std::vector<char>   local_found(nbr_materials,0);
+        bool local_consistent = true;
+        bool local_valid_ID   = true;
+
+        #pragma omp for schedule(static)
+        for(size_t index = 0 ; index < size ; index ++){
+            unsigned char mat = material[index];
+            if(mat >= nbr_materials){
+                local_valid_ID = false;
+                continue;
+            }
+            if(!local_found[mat]){
+                local_found[mat] = 1;
+                local_eps  [mat] = eps_or_mu[index];
+                local_cond [mat] = conductivity[index];
+            }else if(   local_eps [mat] != eps_or_mu[index]
+                     || local_cond[mat] != conductivity[index]){
+                local_consistent = false;
+            }
+        }
+
+        /// Merge the properties found by each thread:
+        #pragma omp critical
+        {
+            is_consistent = is_consistent && local_consistent;
+            is_valid_ID   = is_valid_ID   && local_valid_ID;
+            for(unsigned int mat = 0 ; mat < nbr_materials ; mat ++){
+                if(!local_found[mat])
+                    continue;
+                if(!found[mat]){
+                    found    [mat] = 1;
+                    prop_eps [mat] = local_eps [mat];
+                    prop_cond[mat] = local_cond[mat];
+                }else if(   prop_eps [mat] != local_eps [mat]
+                         || prop_cond[mat] != local_cond[mat]){
+                    is_consistent = false;
+                }
+            }
+        }
+    }
+
+    if(!is_valid_ID){
+        DISPLAY_ERROR_ABORT(
+            "A node has a material ID larger than the number of materials (%u).",
+            nbr_materials
+        );
+    }
+
+    if(!is_consistent){
+        return false;
+    }
+
+    /// Same formulas as for per-node coefficients:
+    for(unsigned int mat = 0 ; mat < nbr_materials ; mat ++){
+        if(!found[mat]){
+            C_self  [mat] = 0.0;
+            C_curl_1[mat] = 0.0;
+            C_curl_2[mat] = 0.0;
+            continue;
+        }
+        double COEF = prop_cond[mat] * dt / (2.0 * prop_eps[mat]);
+
+        C_self  [mat] = (1-COEF) / (1+COEF);
+        C_curl_1[mat] = 1 / ( 1 + COEF) * dt / (prop_eps[mat] * delta_1);
+        C_curl_2[mat] = 1 / ( 1 + COEF) * dt / (prop_eps[mat] * delta_2);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Advance the fields by times.size() steps with temporal blocking.
+ *
+ * One step on the plane K is: H(K), E(K), sources of the plane K and ABC of the plane K.
+ * H(K) needs E(K) and E(K+1) of the previous step, and E(K) needs H(K-1) and H(K). Hence, the step tau
+ * on the plane K can be done as soon as the step tau-1 is done on the plane K+1 and the step tau on
+ * the plane K-1. The planes are swept with a wavefront: at the position 'front', the step tau is done
+ * on the plane K = front - 2*tau. All the (tau,K) of the same front are independent, so that each front
+ * needs only three barriers. The 2*times.size() planes of the front stay in cache between the steps.
+ *
+ * The result is identical to times.size() calls to the normal update. The fields must not depend on the
+ * ghost layers received during the block: no MPI neighbour, or no exchange of the (several) ghost layers
+ * before the last step of the block. [K_beg,K_end) must contain the planes of range_H and range_E.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+void AlgoElectro_NEW::update_temporal_block(
+    GridCreator_NEW &grid,
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_H[3],
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_E[3],
+    const YeeRange range_H[3],
+    const YeeRange range_E[3],
+    const size_t *tile_size,
+    bool USE_TILES,
+    bool COEFFICIENTS_PER_MATERIAL,
+    std::vector<size_t> *local_nodes_inside_source_NUMBER,
+    std::vector<unsigned char> *ID_Source,
+    std::vector<double> &local_nodes_inside_source_FREQ,
+    std::vector<std::vector<size_t> > *sources_in_plane,
+    bool MODULATE_SOURCE,
+    FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+    FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+    FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+    FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+    FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+    FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+    double dt,
+    const std::vector<double> &times,
+    size_t K_beg,
+    size_t K_end)
+{
+    size_t nbr_steps  = times.size();
+    size_t nbr_fronts = (K_end - K_beg) + 2 * (nbr_steps - 1);
+
+    for(size_t front = 0 ; front < nbr_fronts ; front ++){
+
+        /// Magnetic field of all the planes of the front:
+        for(size_t tau = 0 ; tau < nbr_steps ; tau ++){
+            if(front < 2*tau || front - 2*tau >= K_end - K_beg){continue;}
+            size_t K = K_beg + front - 2*tau;
+
+            YeeRange range_plane[3];
+            for(unsigned int c = 0 ; c < 3 ; c ++){
+                range_plane[c] = range_H[c];
+                range_plane[c].K_beg = std::max(range_H[c].K_beg,K);
+                range_plane[c].K_end = std::min(range_H[c].K_end,K+1);
+            }
+            if(USE_TILES){
+                update_yee_field_tiled(Yee_H,COEFFICIENTS_PER_MATERIAL,range_plane,tile_size);
+            }else{
+                for(unsigned int c = 0 ; c < 3 ; c ++){
+                    update_yee_component(Yee_H[c],COEFFICIENTS_PER_MATERIAL,range_plane[c]);
+                }
+            }
+        }
+        #pragma omp barrier
+
+        /// Electric field of all the planes of the front:
+        for(size_t tau = 0 ; tau < nbr_steps ; tau ++){
+            if(front < 2*tau || front - 2*tau >= K_end - K_beg){continue;}
+            size_t K = K_beg + front - 2*tau;
+
+            YeeRange range_plane[3];
+            for(unsigned int c = 0 ; c < 3 ; c ++){
+                range_plane[c] = range_E[c];
+                range_plane[c].K_beg = std::max(range_E[c].K_beg,K);
+                range_plane[c].K_end = std::min(range_E[c].K_end,K+1);
+            }
+            if(USE_TILES){
+                update_yee_field_tiled(Yee_E,COEFFICIENTS_PER_MATERIAL,range_plane,tile_size);
+            }else{
+                for(unsigned int c = 0 ; c < 3 ; c ++){
+                    update_yee_component(Yee_E[c],COEFFICIENTS_PER_MATERIAL,range_plane[c]);
+                }
+            }
+        }
+        #pragma omp barrier
+
+        /// Sources and ABC, one thread per plane of the front (implicit barrier at the end):
+        #pragma omp for schedule(static,1)
+        for(size_t tau = 0 ; tau < nbr_steps ; tau ++){
+            if(front < 2*tau || front - 2*tau >= K_end - K_beg){continue;}
+            size_t K = K_beg + front - 2*tau;
+
+            for(int c = 2 ; c >= 0 ; c --){
+                if(K >= sources_in_plane[c].size()){continue;}
+                for(size_t n = 0 ; n < sources_in_plane[c][K].size() ; n ++){
+                    size_t it    = sources_in_plane[c][K][n];
+                    size_t index = local_nodes_inside_source_NUMBER[c][it];
+                    Yee_E[c].field[index] = source_value(
+                        ID_Source[c][it],
+                        local_nodes_inside_source_FREQ,
+                        MODULATE_SOURCE,
+                        times[tau]);
+                }
+            }
+
+            this->abc_on_planes(grid,
+                Yee_E[0].field, Yee_E[1].field, Yee_E[2].field,
+                Eyx0, Ezx0,
+                Eyx1, Ezx1,
+                Exy0, Ezy0,
+                Exy1, Ezy1,
+                Exz0, Eyz0,
+                Exz1, Eyz1,
+                dt,
+                K,
+                K+1
+            );
+        }
+    }
+}
+
+/**
+ * @brief Wait until 'counter' reaches 'step' (spin for a while, then yield the CPU).
+ */
+inline void wait_for_slab_step(const std::atomic<size_t> &counter, size_t step){
+    unsigned int nbr_spins = 0;
+    while(counter.load(std::memory_order_acquire) < step){
+        if(++nbr_spins > 1024){
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief Advance the fields by times.size() steps, each thread updating its own slab of planes.
+ *
+ * The calling thread owns the planes K_beg_slab <= K < K_end_slab (slab number 'slab' out of nbr_slabs,
+ * in increasing K). One step on the slab is: H, then E, the sources and the ABC of the slab.
+ * H(K) needs E(K) and E(K+1) of the previous step, and E(K) needs H(K-1) and H(K). Hence, the only
+ * dependencies between slabs are:
+ *      - H(step) of the slab needs E(step-1) of the next slab (which must also have been used
+ *        before being overwritten);
+ *      - E(step) of the slab needs H(step) of the previous slab (same remark).
+ * Each slab publishes the last step of its H and E updates in progress[slab], and only waits for
+ * the counters of its two neighbour slabs: there is no barrier of the whole team between the steps.
+ * Each slab must have at least two planes, so that the ABC of the faces z0 and z1 (done with the
+ * planes 2 and size_z-2) stays inside one slab.
+ *
+ * The result is identical to times.size() calls to the normal update. The fields must not depend on
+ * the ghost layers received during the block (no MPI neighbour, or no exchange of the ghost layers before
+ * the last step of the block). The team must be synchronised before and after the call. first_step is
+ * the number of steps done before the block.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+void AlgoElectro_NEW::update_slab_pipeline(
+    GridCreator_NEW &grid,
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_H[3],
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_E[3],
+    const YeeRange range_H[3],
+    const YeeRange range_E[3],
+    const size_t *tile_size,
+    bool COEFFICIENTS_PER_MATERIAL,
+    std::vector<size_t> *local_nodes_inside_source_NUMBER,
+    std::vector<unsigned char> *ID_Source,
+    std::vector<double> &local_nodes_inside_source_FREQ,
+    std::vector<std::vector<size_t> > *sources_in_plane,
+    bool MODULATE_SOURCE,
+    FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+    FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+    FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+    FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+    FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+    FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+    double dt,
+    const std::vector<double> &times,
+    size_t first_step,
+    SlabProgress *progress,
+    size_t slab,
+    size_t nbr_slabs,
+    size_t K_beg_slab,
+    size_t K_end_slab)
+{
+    /// The team is synchronised before the block: the counters start from first_step.
+    progress[slab].H_done.store(first_step,std::memory_order_release);
+    progress[slab].E_done.store(first_step,std::memory_order_release);
+
+    /// Nodes of the slab (empty range if the slab does not intersect the range of the component):
+    YeeRange range_H_slab[3];
+    YeeRange range_E_slab[3];
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        range_H_slab[c] = range_H[c];
+        range_H_slab[c].K_beg = std::max(range_H[c].K_beg,K_beg_slab);
+        range_H_slab[c].K_end = std::max(range_H_slab[c].K_beg,std::min(range_H[c].K_end,K_end_slab));
+        range_E_slab[c] = range_E[c];
+        range_E_slab[c].K_beg = std::max(range_E[c].K_beg,K_beg_slab);
+        range_E_slab[c].K_end = std::max(range_E_slab[c].K_beg,std::min(range_E[c].K_end,K_end_slab));
+    }
+
+    for(size_t tau = 0 ; tau < times.size() ; tau ++){
+
+        size_t step = first_step + tau + 1;
+
+        /// Magnetic field, once the next slab has done the electric field of the previous step:
+        if(slab + 1 < nbr_slabs){
+            wait_for_slab_step(progress[slab+1].E_done,step-1);
+        }
+        update_yee_field_by_this_thread(Yee_H,COEFFICIENTS_PER_MATERIAL,range_H_slab,tile_size);
+        progress[slab].H_done.store(step,std::memory_order_release);
+
+        /// Electric field, once the previous slab has done the magnetic field of this step:
+        if(slab > 0){
+            wait_for_slab_step(progress[slab-1].H_done,step);
+        }
+        update_yee_field_by_this_thread(Yee_E,COEFFICIENTS_PER_MATERIAL,range_E_slab,tile_size);
+
+        /// Sources of the planes of the slab:
+        for(int c = 2 ; c >= 0 ; c --){
+            size_t K_end_sources = std::min(K_end_slab,sources_in_plane[c].size());
+            for(size_t K = K_beg_slab ; K < K_end_sources ; K ++){
+                for(size_t n = 0 ; n < sources_in_plane[c][K].size() ; n ++){
+                    size_t it    = sources_in_plane[c][K][n];
+                    size_t index = local_nodes_inside_source_NUMBER[c][it];
+                    Yee_E[c].field[index] = source_value(
+                        ID_Source[c][it],
+                        local_nodes_inside_source_FREQ,
+                        MODULATE_SOURCE,
+                        times[tau]);
+                }
+            }
+        }
+
+        /// ABC of the planes of the slab:
+        this->abc_on_planes(grid,
+            Yee_E[0].field, Yee_E[1].field, Yee_E[2].field,
+            Eyx0, Ezx0,
+            Eyx1, Ezx1,
+            Exy0, Ezy0,
+            Exy1, Ezy1,
+            Exz0, Eyz0,
+            Exz1, Eyz1,
+            dt,
+            K_beg_slab,
+            K_end_slab
+        );
+        progress[slab].E_done.store(step,std::memory_order_release);
+    }
+}
+
 /**
  * @brief This is the electromagnetic algorithm (FDTD scheme).
+ *
+ * The fields are stored as FIELD_TYPE, and the coefficients as COEF_TYPE (see YeeComponent).
  */
-void AlgoElectro_NEW::update(
+template<typename FIELD_TYPE, typename COEF_TYPE>
+void AlgoElectro_NEW::update_fields(
     GridCreator_NEW &grid,
     InterfaceToParaviewer &interfaceParaview)
 {
@@ -288,61 +719,19 @@ void AlgoElectro_NEW::update(
     // In the object grid, set the properties mu, eps, magnetic cond. and electric cond. for each node:
     grid.Initialize_Electromagnetic_Properties("AIR_AT_INIT_TEMP");
 
-    /* Set the coefficients for the electromagnetic update algorithm */
-
     size_t size;
-    
-    //size_t M = grid.sizes_EH[0];
-    //size_t N = grid.sizes_EH[1];
-    //size_t P = grid.sizes_EH[2];
-
-    // Magnetic field Hx:
-    size = grid.size_Hx[0] * grid.size_Hx[1] * grid.size_Hx[2];
-    double *C_hxh   = new double[size]();
-    double *C_hxe_1 = new double[size]();
-    double *C_hxe_2 = new double[size]();
-
-    // Magnetic field Hy:
-    size = grid.size_Hy[0] * grid.size_Hy[1] * grid.size_Hy[2];
-    double *C_hyh   = new double[size]();
-    double *C_hye_1 = new double[size]();
-    double *C_hye_2 = new double[size]();
-
-    // Magnetic field Hz:
-    size = grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2];
-    double *C_hzh   = new double[size]();
-    double *C_hze_1 = new double[size]();
-    double *C_hze_2 = new double[size]();
-
-    // Electric field Ex:
-    size = grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2];
-    double *C_exe   = new double[size]();
-    double *C_exh_1 = new double[size]();
-    double *C_exh_2 = new double[size]();
-
-    // Electric field Ey:
-    size = grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]; 
-    double *C_eye   = new double[size]();
-    double *C_eyh_1 = new double[size]();
-    double *C_eyh_2 = new double[size]();
-
-    // Electric field Ez:
-    size = grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2];
-    double *C_eze   = new double[size]();
-    double *C_ezh_1 = new double[size]();
-    double *C_ezh_2 = new double[size]();
-
 
     /**
      * @brief Allocation of memory for ABC conditions:
+     *        (stored plane by plane for the faces x and y, row by row for the faces z, see abc_xy_faces_on_planes)
      */
 
     // ABC Old Tangential Field Ey at the extrmities of x of the grid:
     size = (grid.size_Ey[1]-2)*(grid.size_Ey[2]-2);
-    double *Eyx0    = NULL;
-    double *Eyx1    = NULL;
-    Eyx0 = new double[size]();   
-    Eyx1 = new double[size]();
+    FIELD_TYPE *Eyx0    = NULL;
+    FIELD_TYPE *Eyx1    = NULL;
+    Eyx0 = new_aligned_array<FIELD_TYPE>(size);   
+    Eyx1 = new_aligned_array<FIELD_TYPE>(size);
     //std::fill_n(Eyx0, size, 0);
     //std::fill_n(Eyx1, size, 0);
 
@@ -351,10 +740,10 @@ void AlgoElectro_NEW::update(
 
     // ABC Old Tangential Field Ez at the extrmities of x of the grid:
     size = (grid.size_Ez[1]-2)*(grid.size_Ez[2]-2);
-    double *Ezx0    = NULL;
-    double *Ezx1    = NULL;
-    Ezx0 = new double[size]();  
-    Ezx1 = new double[size]();
+    FIELD_TYPE *Ezx0    = NULL;
+    FIELD_TYPE *Ezx1    = NULL;
+    Ezx0 = new_aligned_array<FIELD_TYPE>(size);  
+    Ezx1 = new_aligned_array<FIELD_TYPE>(size);
     //std::fill_n(Ezx0, size, 0);
     //std::fill_n(Ezx1, size, 0);
 
@@ -363,10 +752,10 @@ void AlgoElectro_NEW::update(
 
     // ABC Old Tangential Field Ex at the extrmities of y of the grid:
     size = (grid.size_Ex[0]-2)*(grid.size_Ex[2]-2);
-    double *Exy0    = NULL;
-    double *Exy1    = NULL;
-    Exy0 = new double[size]();    
-    Exy1 = new double[size]();
+    FIELD_TYPE *Exy0    = NULL;
+    FIELD_TYPE *Exy1    = NULL;
+    Exy0 = new_aligned_array<FIELD_TYPE>(size);    
+    Exy1 = new_aligned_array<FIELD_TYPE>(size);
     //std::fill_n(Exy0, size, 0);
     //std::fill_n(Exy1, size, 0);
 
@@ -375,10 +764,10 @@ void AlgoElectro_NEW::update(
 
     // ABC Old Tangential Field Ez at the extrmities of y of the grid:
     size = (grid.size_Ez[0]-2)*(grid.size_Ez[2]-2);
-    double *Ezy0    = NULL;    
-    double *Ezy1    = NULL;
-    Ezy0 = new double[size]();
-    Ezy1 = new double[size]();
+    FIELD_TYPE *Ezy0    = NULL;    
+    FIELD_TYPE *Ezy1    = NULL;
+    Ezy0 = new_aligned_array<FIELD_TYPE>(size);
+    Ezy1 = new_aligned_array<FIELD_TYPE>(size);
     //std::fill_n(Ezy0, size, 0);
     //std::fill_n(Ezy1, size, 0);
     // std::vector<double> Ezy0(size, 0.0);
@@ -386,10 +775,10 @@ void AlgoElectro_NEW::update(
 
     // ABC Old Tangential Field Ex at the extrmities of z of the grid:
     size = (grid.size_Ex[0]-2)*(grid.size_Ex[1]-2);
-    double *Exz0    = NULL;
-    double *Exz1    = NULL;
-    Exz0 = new double[size]();
-    Exz1 = new double[size]();
+    FIELD_TYPE *Exz0    = NULL;
+    FIELD_TYPE *Exz1    = NULL;
+    Exz0 = new_aligned_array<FIELD_TYPE>(size);
+    Exz1 = new_aligned_array<FIELD_TYPE>(size);
     //std::fill_n(Exz0, size, 0);
     //std::fill_n(Exz1, size, 0);
     
@@ -398,23 +787,366 @@ void AlgoElectro_NEW::update(
 
     // ABC Old Tangential Field Ey at the extrmities of z of the grid:
     size = (grid.size_Ey[0]-2)*(grid.size_Ey[1]-2);
-    double *Eyz0    = NULL;
-    double *Eyz1    = NULL;
-    Eyz0 = new double[size]();    
-    Eyz1 = new double[size]();    
+    FIELD_TYPE *Eyz0    = NULL;
+    FIELD_TYPE *Eyz1    = NULL;
+    Eyz0 = new_aligned_array<FIELD_TYPE>(size);    
+    Eyz1 = new_aligned_array<FIELD_TYPE>(size);    
     //std::fill_n(Eyz0, size, 0);
     //std::fill_n(Eyz1, size, 0);
     // std::vector<double> Eyz0(size, 0.0);
     // std::vector<double> Eyz1(size, 0.0);
 
+    /// Clean the output:
+    fflush(stdout);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if(omp_get_thread_num() == 0 
+        && grid.MPI_communicator.isRootProcess() != INT_MIN)
+        {
+            printf(">>> FDTD scheme started with time step of %.15lf seconds.\n",
+                dt);
+        }
+
+    /// Instruction set of the Yee kernels: the best one supported by the CPU, unless the input file asks for another one.
+    YeeSimdISA SIMD_ISA = yee_detect_simd_isa();
+    if(grid.input_parser.ELECTRO_SIMD != "AUTO"){
+        YeeSimdISA asked_ISA = YEE_SIMD_SCALAR;
+        if(grid.input_parser.ELECTRO_SIMD == "AVX2"){
+            asked_ISA = YEE_SIMD_AVX2;
+        }else if(grid.input_parser.ELECTRO_SIMD == "AVX512"){
+            asked_ISA = YEE_SIMD_AVX512;
+        }
+        if(asked_ISA > SIMD_ISA){
+            DISPLAY_WARNING(
+                "[MPI %d] The CPU does not support %s. Using %s instead.\n",
+                grid.MPI_communicator.getRank(),
+                yee_simd_isa_name(asked_ISA),
+                yee_simd_isa_name(SIMD_ISA)
+            );
+        }else{
+            SIMD_ISA = asked_ISA;
+        }
+    }
+    if(grid.MPI_communicator.isRootProcess() != INT_MIN){
+        printf(">>> Yee kernels use the %s instruction set (%s precision).\n",
+            yee_simd_isa_name(SIMD_ISA),
+            grid.input_parser.ELECTRO_PRECISION.c_str());
+    }
+
+
+    ////////////////////////////////////////////////
+    // UPDATE WHILE LOOP - PARALLELIZED WITH      //
+    // OPENMP THREADS    - MINIMUM 6 OPENMP       //
+    // THREADS ARE REQUIRED FOR MPI COMMUNICATION //
+    // TO WORK.                                   //
+    //////////////////////////////////////////////// 
+
+    /// Set OMP_DYNAMIC=false:
+    this->check_OMP_DYNAMIC_envVar();
+
+
+    /// Progress of the slab of each thread (only used with SYNCHRONISATION=NEIGHBOURS):
+    SlabProgress *slab_progress = new SlabProgress[omp_get_max_threads()];
+
+    /**
+     * The steps are done by update_fields_until_step. With REBALANCING_PERIOD > 0 and several processes
+     * along Z, it stops every REBALANCING_PERIOD steps: planes along Z are then moved between the
+     * processes if their compute times are too different (see MPI_REBALANCING_ALONG_Z), and the
+     * update goes on with the new planes of each process.
+     */
+    size_t currentStep        = 0;
+    double total_while_iter   = 0.0;
+    size_t REBALANCING_PERIOD = grid.input_parser.ELECTRO_REBALANCING_PERIOD;
+    bool   CAN_REBALANCE      = REBALANCING_PERIOD > 0 && grid.MPI_communicator.MPI_MAX_POSI[2] > 0;
+    bool   planes_moved       = false;
+
+    grid.profiler.addTimingInputToDictionnary("ELECTRO_COMPUTE",true);
+    if(CAN_REBALANCE){
+        grid.profiler.addTimingInputToDictionnary("ELECTRO_REBALANCING",true);
+    }
+
+    while(current_time < grid.input_parser.get_stopTime()
+            && currentStep < grid.input_parser.maxStepsForOneCycleOfElectro){
+
+        size_t first_step = currentStep;
+        size_t last_step  = grid.input_parser.maxStepsForOneCycleOfElectro;
+        if(CAN_REBALANCE){
+            last_step = std::min(last_step,currentStep + REBALANCING_PERIOD);
+        }
+
+        double compute_time = grid.profiler.getTimingInput("ELECTRO_COMPUTE");
+
+        this->update_fields_until_step<FIELD_TYPE,COEF_TYPE>(
+            grid,
+            interfaceParaview,
+            dt,
+            SIMD_ISA,
+            Eyx0, Ezx0,
+            Eyx1, Ezx1,
+            Exy0, Ezy0,
+            Exy1, Ezy1,
+            Exz0, Eyz0,
+            Exz1, Eyz1,
+            slab_progress,
+            planes_moved,
+            last_step,
+            &currentStep,
+            &current_time,
+            &total_while_iter
+        );
+        planes_moved = false;
+
+        if(    CAN_REBALANCE
+            && currentStep > first_step
+            && currentStep  < grid.input_parser.maxStepsForOneCycleOfElectro
+            && current_time < grid.input_parser.get_stopTime()){
+
+            double time_rebalancing = omp_get_wtime();
+
+            /// Compute time per step of this process since the last rebalancing:
+            compute_time = (grid.profiler.getTimingInput("ELECTRO_COMPUTE") - compute_time)
+                            / (currentStep - first_step);
+
+            long planes_from_below = 0;
+            long planes_from_above = 0;
+            if(grid.MPI_communicator.MPI_REBALANCING_ALONG_Z(
+                    grid,compute_time,&planes_from_below,&planes_from_above)){
+
+                /// The ABC of the faces x and y is stored plane by plane (the ABC of the faces z does not change).
+                /// Moved with the sizes of the fields before the planes are moved:
+                const int *RankNeighbour = grid.MPI_communicator.RankNeighbour;
+                migrate_planes_along_z(Eyx0,grid.size_Ey[1]-2,grid.size_Ey[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+                migrate_planes_along_z(Eyx1,grid.size_Ey[1]-2,grid.size_Ey[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+                migrate_planes_along_z(Ezx0,grid.size_Ez[1]-2,grid.size_Ez[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+                migrate_planes_along_z(Ezx1,grid.size_Ez[1]-2,grid.size_Ez[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+                migrate_planes_along_z(Exy0,grid.size_Ex[0]-2,grid.size_Ex[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+                migrate_planes_along_z(Exy1,grid.size_Ex[0]-2,grid.size_Ex[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+                migrate_planes_along_z(Ezy0,grid.size_Ez[0]-2,grid.size_Ez[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+                migrate_planes_along_z(Ezy1,grid.size_Ez[0]-2,grid.size_Ez[2]-2,0,planes_from_below,planes_from_above,RankNeighbour);
+
+                /// Fields, materials and properties of the nodes:
+                grid.migrate_planes_along_z(planes_from_below,planes_from_above);
+
+                /// The outputs are written with the new extents of the processes:
+                interfaceParaview.initializeAll();
+
+                planes_moved = true;
+            }
+
+            grid.profiler.incrementTimingInput("ELECTRO_REBALANCING",omp_get_wtime() - time_rebalancing);
+        }
+    }
+
+    /// The files of the last outputs, written by the output thread, are complete when the solver returns:
+    interfaceParaview.waitForOutputs();
+
+    /* FREE MEMORY */
+
+    delete[] slab_progress;
+
+
+    /**
+     * @brief Freeing memory of ABC conditions.
+     * 
+     * Note: delete_aligned_array checks for NULLPTR so no need to do 
+     *      if(ptr != NULL) {delete_aligned_array(ptr);}
+     */
+    delete_aligned_array(Eyx0);
+    delete_aligned_array(Eyx1);
+    delete_aligned_array(Ezx0);
+    delete_aligned_array(Ezx1);
+    delete_aligned_array(Exy0);
+    delete_aligned_array(Exy1);
+    delete_aligned_array(Ezy0);
+    delete_aligned_array(Ezy1);
+    delete_aligned_array(Exz0);
+    delete_aligned_array(Exz1);
+    delete_aligned_array(Eyz0);
+    delete_aligned_array(Eyz1);
+
+    /// Compute total elapsed time inside UPDATE:
+    gettimeofday(&end, NULL);
+
+    double delta = end.tv_sec  - start.tv_sec + 
+                        (end.tv_usec - start.tv_usec) / 1.e6;
+
+    grid.profiler.incrementTimingInput("AlgoElectro_NEW_UPDATE_gettimeofday",delta);
+    //std::cout << "AlgoElectro_NEW_UPDATE => Time: " << delta << " s" << std::endl;
+}
 
+/**
+ * @brief Steps of the electromagnetic algorithm, from the step *step to the step last_step (excluded)
+ *        or the stop time, with the current planes of this process.
+ *
+ * The coefficients, the nodes of the sources and the exchanges of the halos depend on the planes of the
+ * process: they are set up at each call. The step, the simulation time and the time spent in the
+ * while loop are updated. If refresh_electric_halos is true (the planes changed since the last call),
+ * the ghost nodes of E are exchanged before the first step.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+void AlgoElectro_NEW::update_fields_until_step(
+    GridCreator_NEW &grid,
+    InterfaceToParaviewer &interfaceParaview,
+    double dt,
+    YeeSimdISA SIMD_ISA,
+    FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+    FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+    FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+    FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+    FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+    FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+    SlabProgress *slab_progress,
+    bool refresh_electric_halos,
+    size_t last_step,
+    size_t *step,
+    double *simulation_time,
+    double *time_in_while)
+{
+    /// Step and simulation time at the beginning, and at the end (set by the master thread):
+    size_t first_step             = *step;
+    double current_time           = *simulation_time;
+    double first_total_while_iter = *time_in_while;
+    size_t step_at_end            = first_step;
+    double total_while_iter_at_end = first_total_while_iter;
 
+    /* Set the coefficients for the electromagnetic update algorithm */
 
+    size_t size;
+    
+    //size_t M = grid.sizes_EH[0];
+    //size_t N = grid.sizes_EH[1];
+    //size_t P = grid.sizes_EH[2];
 
+    /**
+     * The coefficients are either stored for each node (18 arrays as large as the fields),
+     * or for each material (18 small tables, indexed through the material of each node).
+     */
+    bool COEFFICIENTS_PER_MATERIAL = grid.input_parser.ELECTRO_COEFFICIENTS_PER_MATERIAL;
+
+    COEF_TYPE *C_hxh   = NULL, *C_hxe_1 = NULL, *C_hxe_2 = NULL;
+    COEF_TYPE *C_hyh   = NULL, *C_hye_1 = NULL, *C_hye_2 = NULL;
+    COEF_TYPE *C_hzh   = NULL, *C_hze_1 = NULL, *C_hze_2 = NULL;
+    COEF_TYPE *C_exe   = NULL, *C_exh_1 = NULL, *C_exh_2 = NULL;
+    COEF_TYPE *C_eye   = NULL, *C_eyh_1 = NULL, *C_eyh_2 = NULL;
+    COEF_TYPE *C_eze   = NULL, *C_ezh_1 = NULL, *C_ezh_2 = NULL;
+
+    if(COEFFICIENTS_PER_MATERIAL){
+
+        size = grid.materials.numberOfMaterials;
+
+        C_hxh   = new_aligned_array<COEF_TYPE>(size);
+        C_hxe_1 = new_aligned_array<COEF_TYPE>(size);
+        C_hxe_2 = new_aligned_array<COEF_TYPE>(size);
+        C_hyh   = new_aligned_array<COEF_TYPE>(size);
+        C_hye_1 = new_aligned_array<COEF_TYPE>(size);
+        C_hye_2 = new_aligned_array<COEF_TYPE>(size);
+        C_hzh   = new_aligned_array<COEF_TYPE>(size);
+        C_hze_1 = new_aligned_array<COEF_TYPE>(size);
+        C_hze_2 = new_aligned_array<COEF_TYPE>(size);
+        C_exe   = new_aligned_array<COEF_TYPE>(size);
+        C_exh_1 = new_aligned_array<COEF_TYPE>(size);
+        C_exh_2 = new_aligned_array<COEF_TYPE>(size);
+        C_eye   = new_aligned_array<COEF_TYPE>(size);
+        C_eyh_1 = new_aligned_array<COEF_TYPE>(size);
+        C_eyh_2 = new_aligned_array<COEF_TYPE>(size);
+        C_eze   = new_aligned_array<COEF_TYPE>(size);
+        C_ezh_1 = new_aligned_array<COEF_TYPE>(size);
+        C_ezh_2 = new_aligned_array<COEF_TYPE>(size);
+
+        std::vector<double> &delta = grid.delta_Electromagn;
+        bool is_ok = true;
+
+        is_ok = is_ok && this->compute_coefficients_per_material(
+            grid.E_x_material, grid.E_x_eps, grid.E_x_electrical_cond,
+            grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2], size, dt,
+            delta[1], delta[2], C_exe, C_exh_1, C_exh_2);
+
+        is_ok = is_ok && this->compute_coefficients_per_material(
+            grid.E_y_material, grid.E_y_eps, grid.E_y_electrical_cond,
+            grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2], size, dt,
+            delta[2], delta[0], C_eye, C_eyh_1, C_eyh_2);
+
+        is_ok = is_ok && this->compute_coefficients_per_material(
+            grid.E_z_material, grid.E_z_eps, grid.E_z_electrical_cond,
+            grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2], size, dt,
+            delta[0], delta[1], C_eze, C_ezh_1, C_ezh_2);
+
+        is_ok = is_ok && this->compute_coefficients_per_material(
+            grid.H_x_material, grid.H_x_mu, grid.H_x_magnetic_cond,
+            grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2], size, dt,
+            delta[2], delta[1], C_hxh, C_hxe_1, C_hxe_2);
+
+        is_ok = is_ok && this->compute_coefficients_per_material(
+            grid.H_y_material, grid.H_y_mu, grid.H_y_magnetic_cond,
+            grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2], size, dt,
+            delta[0], delta[2], C_hyh, C_hye_1, C_hye_2);
+
+        is_ok = is_ok && this->compute_coefficients_per_material(
+            grid.H_z_material, grid.H_z_mu, grid.H_z_magnetic_cond,
+            grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2], size, dt,
+            delta[1], delta[0], C_hzh, C_hze_1, C_hze_2);
+
+        if(!is_ok){
+            /// Some nodes of the same material have different properties. Go back to per-node coefficients.
+            DISPLAY_WARNING(
+                "[MPI %d] Nodes of the same material have different properties."
+                " The coefficients are stored per node instead of per material.\n",
+                grid.MPI_communicator.getRank()
+            );
+            delete_aligned_array(C_hxh); delete_aligned_array(C_hxe_1); delete_aligned_array(C_hxe_2);
+            delete_aligned_array(C_hyh); delete_aligned_array(C_hye_1); delete_aligned_array(C_hye_2);
+            delete_aligned_array(C_hzh); delete_aligned_array(C_hze_1); delete_aligned_array(C_hze_2);
+            delete_aligned_array(C_exe); delete_aligned_array(C_exh_1); delete_aligned_array(C_exh_2);
+            delete_aligned_array(C_eye); delete_aligned_array(C_eyh_1); delete_aligned_array(C_eyh_2);
+            delete_aligned_array(C_eze); delete_aligned_array(C_ezh_1); delete_aligned_array(C_ezh_2);
+            COEFFICIENTS_PER_MATERIAL = false;
+        }
+    }
 
+    if(!COEFFICIENTS_PER_MATERIAL){
+        /// Set to zero by the threads updating the nodes, so that each thread's tiles are on its NUMA node
+        /// (first touch, see first_touch_zero_yee and the field arrays in GridCreator_NEW::meshInitialization):
+        YeeRange range_H[3];
+        YeeRange range_E[3];
+        YeeRange range_E_interior[3];
+        YeeRange range_E_shell[3][6];
+        grid.get_yee_ranges(range_H,range_E,range_E_interior,range_E_shell);
+        const YeeRange *range_E_tiled = grid.ghost_layers > 1 ? range_E : range_E_interior;
+        const size_t   *tile_size     = grid.input_parser.ELECTRO_TILE_SIZE;
+
+        // Magnetic field Hx:
+        C_hxh   = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hx.data(),range_H,0,tile_size);
+        C_hxe_1 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hx.data(),range_H,0,tile_size);
+        C_hxe_2 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hx.data(),range_H,0,tile_size);
+
+        // Magnetic field Hy:
+        C_hyh   = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hy.data(),range_H,1,tile_size);
+        C_hye_1 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hy.data(),range_H,1,tile_size);
+        C_hye_2 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hy.data(),range_H,1,tile_size);
+
+        // Magnetic field Hz:
+        C_hzh   = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hz.data(),range_H,2,tile_size);
+        C_hze_1 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hz.data(),range_H,2,tile_size);
+        C_hze_2 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Hz.data(),range_H,2,tile_size);
+
+        // Electric field Ex:
+        C_exe   = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ex.data(),range_E_tiled,0,tile_size);
+        C_exh_1 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ex.data(),range_E_tiled,0,tile_size);
+        C_exh_2 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ex.data(),range_E_tiled,0,tile_size);
+
+        // Electric field Ey:
+        C_eye   = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ey.data(),range_E_tiled,1,tile_size);
+        C_eyh_1 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ey.data(),range_E_tiled,1,tile_size);
+        C_eyh_2 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ey.data(),range_E_tiled,1,tile_size);
+
+        // Electric field Ez:
+        C_eze   = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ez.data(),range_E_tiled,2,tile_size);
+        C_ezh_1 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ez.data(),range_E_tiled,2,tile_size);
+        C_ezh_2 = new_yee_array_first_touch<COEF_TYPE>(grid.size_Ez.data(),range_E_tiled,2,tile_size);
+    }
 
 
-    /* COMPUTING COEFFICIENTS */
+    /* COMPUTING COEFFICIENTS (ONLY FOR PER-NODE COEFFICIENTS) */
+    if(!COEFFICIENTS_PER_MATERIAL)
     #pragma omp parallel default(none)\
 		firstprivate(C_exe,C_exh_1,C_exh_2)\
 		firstprivate(C_eye,C_eyh_1,C_eyh_2)\
@@ -627,86 +1359,295 @@ void AlgoElectro_NEW::update(
     /// Assign frequencies:
     local_nodes_inside_source_FREQ = grid.input_parser.source.frequency;
     
-    /// Clean the output:
-    fflush(stdout);
-    MPI_Barrier(MPI_COMM_WORLD);
-    if(omp_get_thread_num() == 0 
-        && grid.MPI_communicator.isRootProcess() != INT_MIN)
+    /**
+     * Rows of nodes whose coefficients are uniform (e.g. air), for each component. They are updated
+     * with a constant-coefficient kernel, which does not load the coefficients of each node.
+     */
+    unsigned char *uniform_row_Hx = new_aligned_array<unsigned char>(grid.size_Hx[1]*grid.size_Hx[2]);
+    unsigned char *uniform_row_Hy = new_aligned_array<unsigned char>(grid.size_Hy[1]*grid.size_Hy[2]);
+    unsigned char *uniform_row_Hz = new_aligned_array<unsigned char>(grid.size_Hz[1]*grid.size_Hz[2]);
+    unsigned char *uniform_row_Ex = new_aligned_array<unsigned char>(grid.size_Ex[1]*grid.size_Ex[2]);
+    unsigned char *uniform_row_Ey = new_aligned_array<unsigned char>(grid.size_Ey[1]*grid.size_Ey[2]);
+    unsigned char *uniform_row_Ez = new_aligned_array<unsigned char>(grid.size_Ez[1]*grid.size_Ez[2]);
+
+    size_t nbr_uniform_rows = 0;
+    size_t nbr_rows         = 0;
+
+    nbr_uniform_rows += classify_yee_uniform_rows(C_hxh, C_hxe_1, C_hxe_2,
+        COEFFICIENTS_PER_MATERIAL ? grid.H_x_material : NULL, grid.size_Hx.data(), uniform_row_Hx);
+    nbr_uniform_rows += classify_yee_uniform_rows(C_hyh, C_hye_1, C_hye_2,
+        COEFFICIENTS_PER_MATERIAL ? grid.H_y_material : NULL, grid.size_Hy.data(), uniform_row_Hy);
+    nbr_uniform_rows += classify_yee_uniform_rows(C_hzh, C_hze_1, C_hze_2,
+        COEFFICIENTS_PER_MATERIAL ? grid.H_z_material : NULL, grid.size_Hz.data(), uniform_row_Hz);
+    nbr_uniform_rows += classify_yee_uniform_rows(C_exe, C_exh_1, C_exh_2,
+        COEFFICIENTS_PER_MATERIAL ? grid.E_x_material : NULL, grid.size_Ex.data(), uniform_row_Ex);
+    nbr_uniform_rows += classify_yee_uniform_rows(C_eye, C_eyh_1, C_eyh_2,
+        COEFFICIENTS_PER_MATERIAL ? grid.E_y_material : NULL, grid.size_Ey.data(), uniform_row_Ey);
+    nbr_uniform_rows += classify_yee_uniform_rows(C_eze, C_ezh_1, C_ezh_2,
+        COEFFICIENTS_PER_MATERIAL ? grid.E_z_material : NULL, grid.size_Ez.data(), uniform_row_Ez);
+
+    nbr_rows = grid.size_Hx[1]*grid.size_Hx[2] + grid.size_Hy[1]*grid.size_Hy[2]
+             + grid.size_Hz[1]*grid.size_Hz[2] + grid.size_Ex[1]*grid.size_Ex[2]
+             + grid.size_Ey[1]*grid.size_Ey[2] + grid.size_Ez[1]*grid.size_Ez[2];
+
+    if(first_step == 0 && grid.MPI_communicator.isRootProcess() != INT_MIN){
+        printf(">>> [MPI %d] %zu rows out of %zu (%.1lf%%) have uniform coefficients.\n",
+            grid.MPI_communicator.getRank(),
+            nbr_uniform_rows, nbr_rows,
+            nbr_rows > 0 ? 100.0 * nbr_uniform_rows / nbr_rows : 0.0);
+    }
+
+    /**
+     * NUMA placement: node of the CPU running each thread, and node of the first page of the thread's
+     * nodes of Ex (its first tile of the E update, see first_touch_zero_yee). Both are the same when the
+     * first touch worked and the threads are pinned (e.g. OMP_PROC_BIND=close, OMP_PLACES=cores).
+     * This is the partition of the tiled sweeps: with the temporal blocking or the slab pipeline, the
+     * threads share the planes differently and may work on pages of another NUMA node.
+     */
+    std::vector<int> numa_node_of_thread(omp_get_max_threads(),-1);
+    std::vector<int> numa_node_of_tile  (omp_get_max_threads(),-1);
+    {
+        FIELD_TYPE *E_fields[3];
+        FIELD_TYPE *H_fields[3];
+        grid.get_field_arrays(E_fields,H_fields);
+
+        YeeRange range_H[3];
+        YeeRange range_E[3];
+        YeeRange range_E_interior[3];
+        YeeRange range_E_shell[3][6];
+        grid.get_yee_ranges(range_H,range_E,range_E_interior,range_E_shell);
+        const YeeRange *range_E_tiled = grid.ghost_layers > 1 ? range_E : range_E_interior;
+
+        #pragma omp parallel num_threads(omp_get_max_threads()) default(none)\
+            shared(grid,E_fields,range_E_tiled,numa_node_of_thread,numa_node_of_tile)
         {
-            printf(">>> FDTD scheme started with time step of %.15lf seconds.\n",
-                dt);
+            size_t thread      = omp_get_thread_num();
+            size_t nbr_threads = omp_get_num_threads();
+            size_t nbr_nodes   = grid.size_Ex[0] * grid.size_Ex[1] * grid.size_Ex[2];
+            size_t first_node  = first_node_of_thread_yee(grid.size_Ex.data(),range_E_tiled,0,
+                                    grid.input_parser.ELECTRO_TILE_SIZE,thread,nbr_threads);
+
+            numa_node_of_thread[thread] = numa_node_of_current_cpu();
+            if(first_node < nbr_nodes){
+                numa_node_of_tile[thread] = numa_node_of_address(E_fields[0] + first_node);
+            }
+        }
+    }
+    if(first_step == 0 && grid.MPI_communicator.isRootProcess() != INT_MIN){
+        size_t nbr_local_tiles = 0;
+        printf(">>> [MPI %d] NUMA node of each thread (CPU/first tile):",grid.MPI_communicator.getRank());
+        for(size_t thread = 0 ; thread < numa_node_of_thread.size() ; thread ++){
+            printf(" %zu:%d/%d",thread,numa_node_of_thread[thread],numa_node_of_tile[thread]);
+            if(numa_node_of_thread[thread] == numa_node_of_tile[thread]
+                && numa_node_of_tile[thread] >= 0){
+                nbr_local_tiles ++;
+            }
         }
+        printf("\n>>> [MPI %d] %zu threads out of %zu work on tiles of their own NUMA node.\n",
+            grid.MPI_communicator.getRank(),
+            nbr_local_tiles, numa_node_of_thread.size());
+    }
 
 
 
 
-    ////////////////////////////////////////////////
-    // UPDATE WHILE LOOP - PARALLELIZED WITH      //
-    // OPENMP THREADS    - MINIMUM 6 OPENMP       //
-    // THREADS ARE REQUIRED FOR MPI COMMUNICATION //
-    // TO WORK.                                   //
-    //////////////////////////////////////////////// 
-
-    /// Set OMP_DYNAMIC=false:
-    this->check_OMP_DYNAMIC_envVar();
-
-
     /**
-     * The following arrays contain the electric field nodes to be sent and received.
-     * 6 is for the number of faces.
+     * Datatypes of the nodes exchanged with the neighbour of each face (MPI_DATATYPE_NULL if no
+     * neighbour), for the electric and the magnetic fields. The messages are sent from and
+     * received in the field arrays, without staging buffers.
+     *
+     * Only the ghost nodes read by the Yee updates are exchanged. H(i) uses E(i) and E(i+1), so
+     * only the ghost planes of E at the end of the axes are used (faces 0, 3 and 5): E is sent
+     * to the neighbours of the faces 1, 2 and 4. E(i) uses H(i-1) and H(i), so H is sent the other
+     * way, to the neighbours of the faces 0, 3 and 5. In both cases, only the two tangential
+     * components are exchanged (see create_halo_face_datatype).
      */
-    double **Electric_field_to_send = (double**) calloc(NBR_FACES_CUBE,sizeof(double*));
-    double **Electric_field_to_recv = (double**) calloc(NBR_FACES_CUBE,sizeof(double*));
+    /**
+     * Neighbours on the same node, when the fields are in shared memory (see GridCreator_NEW::fields_in_shared_memory):
+     * their ghost planes are copied straight from their fields (see SharedMemoryHalo), without messages.
+     * halo_progress_window has the progress of the exchanges of each process of the node (electric, magnetic).
+     */
+    MPI_Win halo_progress_window = MPI_WIN_NULL;
+    if(grid.fields_in_shared_memory){
+        HaloProgress *halo_progress = NULL;
+        MPI_Win_allocate_shared(2*sizeof(HaloProgress),sizeof(HaloProgress),MPI_INFO_NULL,
+            grid.node_communicator,&halo_progress,&halo_progress_window);
+        new (&halo_progress[0]) HaloProgress();
+        new (&halo_progress[1]) HaloProgress();
+        /// The counters of all the processes are set before being read:
+        MPI_Barrier(grid.node_communicator);
+
+        if(first_step == 0 && grid.MPI_communicator.isRootProcess() != INT_MIN){
+            int nbr_processes_in_node = 1;
+            MPI_Comm_size(grid.node_communicator,&nbr_processes_in_node);
+            printf(">>> Halos of the MPI processes of the same node (%d on the node of MPI %d)"
+                   " copied through the shared memory.\n",
+                nbr_processes_in_node,grid.MPI_communicator.getRank());
+        }
+    }
+    SharedMemoryHalo<FIELD_TYPE> electric_shared_halo;
+    SharedMemoryHalo<FIELD_TYPE> magnetic_shared_halo;
+    init_shared_memory_halo(grid,true ,halo_progress_window,electric_shared_halo);
+    init_shared_memory_halo(grid,false,halo_progress_window,magnetic_shared_halo);
+
+    MPI_Datatype electric_face_to_send[NBR_FACES_CUBE];
+    MPI_Datatype electric_face_to_recv[NBR_FACES_CUBE];
+    MPI_Datatype magnetic_face_to_send[NBR_FACES_CUBE];
+    MPI_Datatype magnetic_face_to_recv[NBR_FACES_CUBE];
+    {
+        FIELD_TYPE *E_fields[3];
+        FIELD_TYPE *H_fields[3];
+        grid.get_field_arrays(E_fields,H_fields);
+        const std::vector<size_t> *electric_field_sizes[3] = {&grid.size_Ex,&grid.size_Ey,&grid.size_Ez};
+        const std::vector<size_t> *magnetic_field_sizes[3] = {&grid.size_Hx,&grid.size_Hy,&grid.size_Hz};
+
+        for(unsigned int i = 0 ; i < NBR_FACES_CUBE ; i ++){
+            electric_face_to_send[i] = MPI_DATATYPE_NULL;
+            electric_face_to_recv[i] = MPI_DATATYPE_NULL;
+            magnetic_face_to_send[i] = MPI_DATATYPE_NULL;
+            magnetic_face_to_recv[i] = MPI_DATATYPE_NULL;
+            if(grid.MPI_communicator.RankNeighbour[i] == -1){continue;}
+            /// Neighbour on the same node, in shared memory:
+            if(grid.rank_in_node(grid.MPI_communicator.RankNeighbour[i]) >= 0){continue;}
+            /// Several ghost layers, exchanged every ghost_layers steps (see ghost_layers_halo_requests):
+            if(grid.ghost_layers > 1){continue;}
+
+            bool is_end_of_axis = i == 0 || i == 3 || i == 5;
+            if(is_end_of_axis){
+                electric_face_to_recv[i] = create_halo_face_datatype(i,true,
+                    E_fields[0],E_fields[1],E_fields[2],electric_field_sizes);
+                magnetic_face_to_send[i] = create_halo_face_datatype(i,false,
+                    H_fields[0],H_fields[1],H_fields[2],magnetic_field_sizes);
+            }else{
+                electric_face_to_send[i] = create_halo_face_datatype(i,false,
+                    E_fields[0],E_fields[1],E_fields[2],electric_field_sizes);
+                magnetic_face_to_recv[i] = create_halo_face_datatype(i,true,
+                    H_fields[0],H_fields[1],H_fields[2],magnetic_field_sizes);
+            }
+        }
+    }
 
-    double **Magnetic_field_to_send = (double**) calloc(NBR_FACES_CUBE,sizeof(double*));
-    double **Magnetic_field_to_recv = (double**) calloc(NBR_FACES_CUBE,sizeof(double*));
+    /**
+     * The neighbours and the faces are the same at each step: the requests of the exchanges are
+     * created once (persistent requests), and only started and waited for at each step.
+     */
+    /// With HALO_THREADS=PER_FACE, the faces are exchanged concurrently by several threads (see halo_face_thread):
+    bool PER_FACE_HALO_THREADS =
+               grid.input_parser.ELECTRO_HALO_THREADS == "PER_FACE"
+            && grid.MPI_communicator.get_provided_thread_support() == MPI_THREAD_MULTIPLE;
+    if(first_step == 0 && grid.input_parser.ELECTRO_HALO_THREADS == "PER_FACE" && !PER_FACE_HALO_THREADS
+            && grid.MPI_communicator.isRootProcess() != INT_MIN){
+        DISPLAY_WARNING(
+            "HALO_THREADS=PER_FACE needs MPI_THREAD_MULTIPLE. The master thread exchanges all the faces.\n"
+        );
+    }
+    HaloExchange electric_halo_requests;
+    HaloExchange magnetic_halo_requests;
+    init_halo_exchange(
+        electric_face_to_send,
+        electric_face_to_recv,
+        grid.MPI_communicator.RankNeighbour,
+        grid.MPI_communicator.getRank(),
+        0,
+        PER_FACE_HALO_THREADS,
+        electric_halo_requests
+    );
+    init_halo_exchange(
+        magnetic_face_to_send,
+        magnetic_face_to_recv,
+        grid.MPI_communicator.RankNeighbour,
+        grid.MPI_communicator.getRank(),
+        NBR_FACES_CUBE,
+        PER_FACE_HALO_THREADS,
+        magnetic_halo_requests
+    );
 
     /**
-     * Initialize Electric_field_to_send/recv when it is appropriate:
+     * With several ghost layers (see GridCreator_NEW::ghost_layers), the halos of E and H are exchanged
+     * together once every ghost_layers steps, at the end of the step (after the ABC). In between, the
+     * ghost layers are updated by this process as its own nodes: the nodes which are not up to date go
+     * one node further from the array ends at each step, and only reach the nodes of this process after
+     * ghost_layers steps. The three components are exchanged, with the old tangential fields of the faces
+     * of the ABC along the face (their first and last layers are not stored, so one layer less).
+     * The directions are exchanged one after the other (x, y, then z), each with the ghost layers of the
+     * previous ones, so that the ghost nodes of the edges and corners come from the diagonal neighbours.
+     * One set of persistent requests per direction.
      */
-    std::vector<char> DIRECTIONS = {'S','N','W','E','D','U'};
-
-    std::vector<size_t> electric_field_sizes = {
-            grid.size_Ex[0],
-            grid.size_Ex[1],
-            grid.size_Ex[2],
-            grid.size_Ey[0],
-            grid.size_Ey[1],
-            grid.size_Ey[2],
-            grid.size_Ez[0],
-            grid.size_Ez[1],
-            grid.size_Ez[2]
-        };
-    std::vector<size_t> magnetic_field_sizes = {
-            grid.size_Hx[0],
-            grid.size_Hx[1],
-            grid.size_Hx[2],
-            grid.size_Hy[0],
-            grid.size_Hy[1],
-            grid.size_Hy[2],
-            grid.size_Hz[0],
-            grid.size_Hz[1],
-            grid.size_Hz[2]
-        };
-
-    std::vector<size_t> size_faces_electric(6);
-    std::vector<size_t> size_faces_magnetic(6);
+    MPI_Datatype ghost_layers_to_send[NBR_FACES_CUBE];
+    MPI_Datatype ghost_layers_to_recv[NBR_FACES_CUBE];
+    HaloExchange ghost_layers_halo_requests[3];
+    {
+        FIELD_TYPE *E_fields[3];
+        FIELD_TYPE *H_fields[3];
+        grid.get_field_arrays(E_fields,H_fields);
+        FIELD_TYPE *fields[6] = {E_fields[0],E_fields[1],E_fields[2],H_fields[0],H_fields[1],H_fields[2]};
+        const std::vector<size_t> *field_sizes[6] = {&grid.size_Ex,&grid.size_Ey,&grid.size_Ez,
+                                                     &grid.size_Hx,&grid.size_Hy,&grid.size_Hz};
+
+        /// Old tangential fields of the faces x0, x1, y0, y1, z0 and z1 of the ABC, with their components:
+        FIELD_TYPE *abc_fields[6][2] = {{Eyx0,Ezx0},{Eyx1,Ezx1},{Exy0,Ezy0},{Exy1,Ezy1},{Exz0,Eyz0},{Exz1,Eyz1}};
+        const std::vector<size_t> *abc_sizes[6][2] = {
+            {&grid.size_Ey,&grid.size_Ez},{&grid.size_Ey,&grid.size_Ez},
+            {&grid.size_Ex,&grid.size_Ez},{&grid.size_Ex,&grid.size_Ez},
+            {&grid.size_Ex,&grid.size_Ey},{&grid.size_Ex,&grid.size_Ey}};
+        /// Faces x0, x1, y0, y1, z0, z1 of the ABC in the numbering of the faces of the neighbours:
+        const unsigned int abc_face[6] = {1,0,2,3,4,5};
+
+        for(unsigned int i = 0 ; i < NBR_FACES_CUBE ; i ++){
+            ghost_layers_to_send[i] = MPI_DATATYPE_NULL;
+            ghost_layers_to_recv[i] = MPI_DATATYPE_NULL;
+            if(grid.MPI_communicator.RankNeighbour[i] == -1 || grid.ghost_layers == 1){continue;}
+
+            std::vector<GhostLayersArray<FIELD_TYPE> > arrays;
+            for(unsigned int c = 0 ; c < 6 ; c ++){
+                GhostLayersArray<FIELD_TYPE> array;
+                array.nodes      = fields[c];
+                array.size[0]    = (*field_sizes[c])[0];
+                array.size[1]    = (*field_sizes[c])[1];
+                array.size[2]    = (*field_sizes[c])[2];
+                array.nbr_layers = grid.ghost_layers;
+                arrays.push_back(array);
+            }
+            /// The neighbour has the same faces of the ABC along the other directions:
+            for(unsigned int f = 0 ; f < 6 ; f ++){
+                unsigned int normal = abc_face[f] / 2;
+                if(normal == i / 2 || grid.MPI_communicator.RankNeighbour[abc_face[f]] != -1){continue;}
+                for(unsigned int c = 0 ; c < 2 ; c ++){
+                    GhostLayersArray<FIELD_TYPE> array;
+                    array.nodes = abc_fields[f][c];
+                    for(unsigned int d = 0 ; d < 3 ; d ++){
+                        array.size[d] = d == normal ? 1 : (*abc_sizes[f][c])[d] - 2;
+                    }
+                    array.nbr_layers = grid.ghost_layers - 1;
+                    arrays.push_back(array);
+                }
+            }
 
-    for(unsigned int i = 0 ; i < NBR_FACES_CUBE ; i ++){
-        if(grid.MPI_communicator.RankNeighbour[i] != -1){
-            char dir = DIRECTIONS[i];
-
-            determine_size_face_based_on_direction(
-                                dir,
-                                electric_field_sizes,
-                                magnetic_field_sizes,
-                                &size_faces_electric[i],
-                                &size_faces_magnetic[i]);
-
-            Electric_field_to_send[i] = (double*) calloc(size_faces_electric[i],sizeof(double));
-            Electric_field_to_recv[i] = (double*) calloc(size_faces_electric[i],sizeof(double));
-            Magnetic_field_to_send[i] = (double*) calloc(size_faces_magnetic[i],sizeof(double));
-            Magnetic_field_to_recv[i] = (double*) calloc(size_faces_magnetic[i],sizeof(double));
+            ghost_layers_to_send[i] = create_ghost_layers_face_datatype(i,false,arrays);
+            ghost_layers_to_recv[i] = create_ghost_layers_face_datatype(i,true ,arrays);
+        }
+
+        for(unsigned int direction = 0 ; direction < 3 ; direction ++){
+            MPI_Datatype to_send[NBR_FACES_CUBE];
+            MPI_Datatype to_recv[NBR_FACES_CUBE];
+            for(unsigned int i = 0 ; i < NBR_FACES_CUBE ; i ++){
+                to_send[i] = i / 2 == direction ? ghost_layers_to_send[i] : MPI_DATATYPE_NULL;
+                to_recv[i] = i / 2 == direction ? ghost_layers_to_recv[i] : MPI_DATATYPE_NULL;
+            }
+            init_halo_exchange(
+                to_send,
+                to_recv,
+                grid.MPI_communicator.RankNeighbour,
+                grid.MPI_communicator.getRank(),
+                0,
+                PER_FACE_HALO_THREADS,
+                ghost_layers_halo_requests[direction]
+            );
+        }
+
+        if(first_step == 0 && grid.ghost_layers > 1 && grid.MPI_communicator.isRootProcess() != INT_MIN){
+            printf(">>> %zu ghost layers: the halos are exchanged once every %zu steps.\n",
+                grid.ghost_layers,grid.ghost_layers);
         }
     }
 
@@ -728,7 +1669,8 @@ void AlgoElectro_NEW::update(
 
 
     #pragma omp parallel num_threads(omp_get_max_threads()) default(none)\
-        shared(grid,current_time,end,start)\
+        shared(grid,current_time,step_at_end,total_while_iter_at_end)\
+        firstprivate(first_step,last_step,first_total_while_iter,refresh_electric_halos)\
         firstprivate(local_nodes_inside_source_NUMBER)\
         firstprivate(local_nodes_inside_source_FREQ,ID_Source)\
         shared(interfaceParaview)\
@@ -738,11 +1680,15 @@ void AlgoElectro_NEW::update(
         firstprivate(C_exe,C_exh_1,C_exh_2)\
         firstprivate(C_eye,C_eyh_1,C_eyh_2)\
         firstprivate(C_eze,C_ezh_1,C_ezh_2)\
+        firstprivate(COEFFICIENTS_PER_MATERIAL,SIMD_ISA)\
+        firstprivate(uniform_row_Hx,uniform_row_Hy,uniform_row_Hz)\
+        firstprivate(uniform_row_Ex,uniform_row_Ey,uniform_row_Ez)\
+        firstprivate(slab_progress)\
         shared(ompi_mpi_comm_world,ompi_mpi_int)\
-        firstprivate(Electric_field_to_send,Electric_field_to_recv)\
-        firstprivate(Magnetic_field_to_send,Magnetic_field_to_recv)\
-        firstprivate(electric_field_sizes,magnetic_field_sizes,dt)\
-        firstprivate(size_faces_electric,size_faces_magnetic)\
+        shared(electric_halo_requests,magnetic_halo_requests)\
+        shared(electric_shared_halo,magnetic_shared_halo)\
+        shared(ghost_layers_halo_requests)\
+        firstprivate(dt)\
         firstprivate(Eyx0, Eyx1)\
         firstprivate(Ezx0, Ezx1)\
         firstprivate(Exy0, Exy1)\
@@ -757,73 +1703,203 @@ void AlgoElectro_NEW::update(
         }
 
         // Temporary pointers, to avoid doing grid.sthg !
-        double *H_x_tmp = grid.H_x;
-        double *H_y_tmp = grid.H_y;
-        double *H_z_tmp = grid.H_z;
-        double *E_x_tmp = grid.E_x;
-        double *E_y_tmp = grid.E_y;
-        double *E_z_tmp = grid.E_z;
+        FIELD_TYPE *E_tmp[3];
+        FIELD_TYPE *H_tmp[3];
+        grid.get_field_arrays(E_tmp,H_tmp);
+        FIELD_TYPE *H_x_tmp = H_tmp[0];
+        FIELD_TYPE *H_y_tmp = H_tmp[1];
+        FIELD_TYPE *H_z_tmp = H_tmp[2];
+        FIELD_TYPE *E_x_tmp = E_tmp[0];
+        FIELD_TYPE *E_y_tmp = E_tmp[1];
+        FIELD_TYPE *E_z_tmp = E_tmp[2];
 
         size_t index;
-        size_t index_1Plus;
-        size_t index_1Moins;
-        size_t index_2Plus;
-        size_t index_2Moins;
-        size_t size_x;
-        size_t size_y;
-        size_t size_x_1;
-        size_t size_y_1;
-        size_t size_x_2;
-        size_t size_y_2;
-
-        size_t currentStep = 0;
 
         /**
-         * Important for the electric field update !
+         * Description of the six updates of the Yee scheme.
+         * The curl of the magnetic field uses the nodes (+1) and (0) of the electric field.
+         * The curl of the electric field uses the nodes (0) and (-1) of the magnetic field.
+         * The nodes used by each component are given by its stencil (see YeeStencil).
          */
-        size_t IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDX = 0;
-        size_t IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDY = 0;
-        size_t IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDZ = 0;
-
-        size_t IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDX = 0;
-        size_t IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDY = 0;
-        size_t IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDZ = 0;
+        // Hx(mm,nn,pp) uses Ey(mm,nn,pp+1) - Ey(mm,nn,pp) and Ez(mm,nn+1,pp) - Ez(mm,nn,pp):
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_Hx = make_yee_component(
+            YEE_HX,
+            H_x_tmp, grid.size_Hx.data(),
+            E_y_tmp, grid.size_Ey.data(),
+            E_z_tmp, grid.size_Ez.data(),
+            C_hxh, C_hxe_1, C_hxe_2, grid.H_x_material,
+            uniform_row_Hx, SIMD_ISA);
+
+        // Hy(mm,nn,pp) uses Ez(mm+1,nn,pp) - Ez(mm,nn,pp) and Ex(mm,nn,pp+1) - Ex(mm,nn,pp):
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_Hy = make_yee_component(
+            YEE_HY,
+            H_y_tmp, grid.size_Hy.data(),
+            E_z_tmp, grid.size_Ez.data(),
+            E_x_tmp, grid.size_Ex.data(),
+            C_hyh, C_hye_1, C_hye_2, grid.H_y_material,
+            uniform_row_Hy, SIMD_ISA);
+
+        // Hz(mm,nn,pp) uses Ex(mm,nn+1,pp) - Ex(mm,nn,pp) and Ey(mm+1,nn,pp) - Ey(mm,nn,pp):
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_Hz = make_yee_component(
+            YEE_HZ,
+            H_z_tmp, grid.size_Hz.data(),
+            E_x_tmp, grid.size_Ex.data(),
+            E_y_tmp, grid.size_Ey.data(),
+            C_hzh, C_hze_1, C_hze_2, grid.H_z_material,
+            uniform_row_Hz, SIMD_ISA);
+
+        // Ex(mm,nn,pp) uses Hz(mm,nn,pp) - Hz(mm,nn-1,pp) and Hy(mm,nn,pp) - Hy(mm,nn,pp-1):
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_Ex = make_yee_component(
+            YEE_EX,
+            E_x_tmp, grid.size_Ex.data(),
+            H_z_tmp, grid.size_Hz.data(),
+            H_y_tmp, grid.size_Hy.data(),
+            C_exe, C_exh_1, C_exh_2, grid.E_x_material,
+            uniform_row_Ex, SIMD_ISA);
+
+        // Ey(mm,nn,pp) uses Hx(mm,nn,pp) - Hx(mm,nn,pp-1) and Hz(mm,nn,pp) - Hz(mm-1,nn,pp):
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_Ey = make_yee_component(
+            YEE_EY,
+            E_y_tmp, grid.size_Ey.data(),
+            H_x_tmp, grid.size_Hx.data(),
+            H_z_tmp, grid.size_Hz.data(),
+            C_eye, C_eyh_1, C_eyh_2, grid.E_y_material,
+            uniform_row_Ey, SIMD_ISA);
+
+        // Ez(mm,nn,pp) uses Hy(mm,nn,pp) - Hy(mm-1,nn,pp) and Hx(mm,nn,pp) - Hx(mm,nn-1,pp):
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_Ez = make_yee_component(
+            YEE_EZ,
+            E_z_tmp, grid.size_Ez.data(),
+            H_y_tmp, grid.size_Hy.data(),
+            H_x_tmp, grid.size_Hx.data(),
+            C_eze, C_ezh_1, C_ezh_2, grid.E_z_material,
+            uniform_row_Ez, SIMD_ISA);
+
+        size_t currentStep = first_step;
 
-        if(grid.MPI_communicator.MPI_POSITION[0] == grid.MPI_communicator.MPI_MAX_POSI[0]){
-            IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDX = 1;
-        }
+        /**
+         * Nodes updated for each component (see GridCreator_NEW::get_yee_ranges). With MPI neighbours,
+         * the halos of H are exchanged while the interior of E is updated, the shell is updated once
+         * they are received.
+         */
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_H[3] = {Yee_Hx,Yee_Hy,Yee_Hz};
+        YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_E[3] = {Yee_Ex,Yee_Ey,Yee_Ez};
+        YeeRange range_H[3];
+        YeeRange range_E[3];
+        YeeRange range_E_interior[3];
+        YeeRange range_E_shell[3][6];
+        grid.get_yee_ranges(range_H,range_E,range_E_interior,range_E_shell);
+        std::vector<size_t> *size_E[3] = {&grid.size_Ex,&grid.size_Ey,&grid.size_Ez};
+
+        /// Tiles of the H and E updates (no tiling if the three sizes are 0):
+        const size_t *tile_size = grid.input_parser.ELECTRO_TILE_SIZE;
+        bool USE_TILES = tile_size[0] != 0 || tile_size[1] != 0 || tile_size[2] != 0;
 
-        if(grid.MPI_communicator.MPI_POSITION[1] == grid.MPI_communicator.MPI_MAX_POSI[1]){
-            IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDY = 1;
+        bool has_neighboor = false;
+        for(unsigned int ii =  0; ii < NBR_FACES_CUBE ; ii ++){
+            if(grid.MPI_communicator.RankNeighbour[ii] != -1){
+                has_neighboor = true;
+                break;
+            }
         }
 
-        if(grid.MPI_communicator.MPI_POSITION[2] == grid.MPI_communicator.MPI_MAX_POSI[2]){
-            IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDZ = 1;
-        }
+        /// Halos exchanged every ghost_layers steps instead of at each half step (see ghost_layers_halo_requests):
+        bool HAS_GHOST_LAYERS = has_neighboor && grid.ghost_layers > 1;
+        /// With neighbours, the halos exchanged at each half step:
+        bool HAS_HALF_STEP_HALOS = has_neighboor && !HAS_GHOST_LAYERS;
 
-        if(grid.MPI_communicator.MPI_POSITION[0] == 0){
-            IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDX = 1;
+        /**
+         * Temporal blocking: several steps are done plane by plane (see update_temporal_block).
+         * The block only uses the nodes of this process and its ghost layers: with MPI neighbours, it is
+         * only used with several ghost layers (at least TEMPORAL_BLOCKING_DEPTH), and the blocks stop on
+         * the steps after which the ghost layers are exchanged. The ghost planes updated along K (H before
+         * this process, E after it) are swept with the planes of this process.
+         * It is not used if points are probed (they are probed at each step).
+         */
+        size_t TEMPORAL_BLOCKING_DEPTH = grid.input_parser.ELECTRO_TEMPORAL_BLOCKING_DEPTH;
+        size_t K_beg_temporal_block    = 1;
+        size_t K_end_temporal_block    = 1;
+        for(unsigned int c = 0 ; c < 3 ; c ++){
+            K_beg_temporal_block = std::min(K_beg_temporal_block,range_H[c].K_beg);
+            K_beg_temporal_block = std::min(K_beg_temporal_block,range_E[c].K_beg);
+            K_end_temporal_block = std::max(K_end_temporal_block,range_H[c].K_end);
+            K_end_temporal_block = std::max(K_end_temporal_block,range_E[c].K_end);
+            K_end_temporal_block = std::max(K_end_temporal_block,(*size_E[c])[2]-1);
         }
+        bool CAN_USE_TEMPORAL_BLOCKING =
+                   TEMPORAL_BLOCKING_DEPTH > 1
+                && (!has_neighboor || (HAS_GHOST_LAYERS && grid.ghost_layers >= TEMPORAL_BLOCKING_DEPTH))
+                && grid.input_parser.points_to_be_probed.empty()
+                && K_end_temporal_block - K_beg_temporal_block >= 4;
 
-        if(grid.MPI_communicator.MPI_POSITION[1] == 0){
-            IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDY = 1;
+        /**
+         * Synchronisation with the neighbour slabs (SYNCHRONISATION=NEIGHBOURS, see update_slab_pipeline):
+         * each thread owns a slab of at least two planes, for the whole run, and the steps between two
+         * outputs are done without barrier of the whole team. As the temporal blocking, it is used with
+         * MPI neighbours when they have several ghost layers, between two exchanges of the ghost layers.
+         */
+        bool ASKS_FOR_SLAB_PIPELINE = grid.input_parser.ELECTRO_SYNCHRONISATION == "NEIGHBOURS";
+        bool CAN_USE_SLAB_PIPELINE  =
+                   ASKS_FOR_SLAB_PIPELINE
+                && !CAN_USE_TEMPORAL_BLOCKING
+                && (!has_neighboor || HAS_GHOST_LAYERS)
+                && grid.input_parser.points_to_be_probed.empty()
+                && K_end_temporal_block - K_beg_temporal_block >= 2;
+
+        /// Slab of this thread (threads beyond nbr_slabs have no slab):
+        size_t nbr_planes = K_end_temporal_block - K_beg_temporal_block;
+        size_t nbr_slabs  = std::min((size_t)omp_get_num_threads(),nbr_planes / 2);
+        size_t slab       = omp_get_thread_num();
+        size_t K_beg_slab = K_beg_temporal_block;
+        size_t K_end_slab = K_beg_temporal_block;
+        if(CAN_USE_SLAB_PIPELINE && slab < nbr_slabs){
+            K_beg_slab = K_beg_temporal_block + omp_static_chunk_begin(nbr_planes,slab  ,nbr_slabs);
+            K_end_slab = K_beg_temporal_block + omp_static_chunk_begin(nbr_planes,slab+1,nbr_slabs);
         }
 
-        if(grid.MPI_communicator.MPI_POSITION[2] == 0){
-            IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDZ = 1;
+        #pragma omp master
+        {
+            if(first_step == 0 && TEMPORAL_BLOCKING_DEPTH > 1 && !CAN_USE_TEMPORAL_BLOCKING){
+                printf("%s>>> %s!!! WARNING !!!%s [MPI %d] TEMPORAL_BLOCKING_DEPTH=%zu is not used"
+                       " (MPI neighbours with less ghost layers than the depth, probed points or too few planes)."
+                       " Using one step at a time instead.%s\n",
+                        ANSI_COLOR_RED,
+                        ANSI_COLOR_YELLOW,
+                        ANSI_COLOR_GREEN,
+                        grid.MPI_communicator.getRank(),
+                        TEMPORAL_BLOCKING_DEPTH,
+                        ANSI_COLOR_RESET);
+            }
+            if(first_step == 0 && ASKS_FOR_SLAB_PIPELINE && !CAN_USE_SLAB_PIPELINE){
+                printf("%s>>> %s!!! WARNING !!!%s [MPI %d] SYNCHRONISATION=NEIGHBOURS is not used"
+                       " (MPI neighbours with one ghost layer, probed points or temporal blocking)."
+                       " Using barriers instead.%s\n",
+                        ANSI_COLOR_RED,
+                        ANSI_COLOR_YELLOW,
+                        ANSI_COLOR_GREEN,
+                        grid.MPI_communicator.getRank(),
+                        ANSI_COLOR_RESET);
+            }
+            if(first_step == 0 && CAN_USE_SLAB_PIPELINE && grid.MPI_communicator.isRootProcess() != INT_MIN){
+                printf(">>> [MPI %d] Threads synchronised with their neighbours (%zu slabs of about %zu planes).\n",
+                    grid.MPI_communicator.getRank(),
+                    nbr_slabs, nbr_planes / nbr_slabs);
+            }
         }
 
-        bool has_neighboor = false;
-        for(unsigned int ii =  0; ii < NBR_FACES_CUBE ; ii ++){
-            if(grid.MPI_communicator.RankNeighbour[ii] != -1){
-                has_neighboor = true;
-                break;
+        /// Nodes of the sources, sorted by plane K:
+        std::vector<std::vector<size_t> > sources_in_plane[3];
+        if(CAN_USE_TEMPORAL_BLOCKING || CAN_USE_SLAB_PIPELINE){
+            for(unsigned int c = 0 ; c < 3 ; c ++){
+                size_t size_plane = (*size_E[c])[0] * (*size_E[c])[1];
+                sources_in_plane[c].resize((*size_E[c])[2]);
+                for(size_t it = 0 ; it < local_nodes_inside_source_NUMBER[c].size() ; it ++){
+                    size_t K = local_nodes_inside_source_NUMBER[c][it] / size_plane;
+                    sources_in_plane[c][K].push_back(it);
+                }
             }
         }
 
-        // Some indexing variables:
-        size_t I,J,K;
-
         /// Variables to monitore the time spent communicating:
         struct timeval start_mpi_comm;
         struct timeval end___mpi_comm;
@@ -832,25 +1908,27 @@ void AlgoElectro_NEW::update(
         /// Variables to compute the time taken by each iteration:
         struct timeval start_while_iter;
         struct timeval end___while_iter;
-        double         total_while_iter = 0.0;
+        double         total_while_iter = first_total_while_iter;
+
+        /// The planes of this process changed (see MPI_REBALANCING_ALONG_Z): the ghost nodes of E read by
+        /// the first update of H are exchanged again.
+        if(refresh_electric_halos && has_neighboor){
+            start_halo_exchange(electric_halo_requests);
+            #pragma omp master
+            {
+                start_shared_memory_halo(electric_shared_halo);
+                wait_shared_memory_halo(electric_shared_halo);
+            }
+            wait_halo_exchange(electric_halo_requests);
+            #pragma omp barrier
+        }
 
         while(current_time < grid.input_parser.get_stopTime()
-                && currentStep < grid.input_parser.maxStepsForOneCycleOfElectro){
+                && currentStep < grid.input_parser.maxStepsForOneCycleOfElectro
+                && currentStep < last_step){
 
             gettimeofday( &start_while_iter , NULL);
 
-            // Updating the magnetic field Hx.
-            // Don't update neighboors ! Start at 1. Go to size-1.
-
-            size_x = grid.size_Hx[0];
-            size_y = grid.size_Hx[1];
-
-            size_x_1 = grid.size_Ey[0];
-            size_y_1 = grid.size_Ey[1];
-
-            size_x_2 = grid.size_Ez[0];
-            size_y_2 = grid.size_Ez[1];
-
             #ifndef NDEBUG
                 #pragma omp master
                 printf("%s>>> %s!!! WARNING !!!%s 'NDEBUG' is not defied. You are in debug mode."
@@ -862,560 +1940,291 @@ void AlgoElectro_NEW::update(
                         ANSI_COLOR_RESET);
             #endif
 
-            #pragma omp for schedule(static) collapse(3) nowait
-            for (K = 1 ; K < grid.size_Hx[2]-1 ; K++){
-                for(J = 1 ; J < grid.size_Hx[1]-1 ; J ++){
-                    for(I = 1 ; I < grid.size_Hx[0]-1 ; I++){
-
-                        // Hx(mm, nn, pp):
-                        index        = I + size_x   * ( J     + size_y   * K);
-                        // Ey(mm, nn, pp + 1):
-                        index_1Plus  = I + size_x_1 * ( J     + size_y_1 * (K+1));
-                        // Ey(mm, nn, pp):
-                        index_1Moins = I + size_x_1 * ( J     + size_y_1 * K);
-                        // Ez(mm, nn + 1, pp):
-                        index_2Plus  = I + size_x_2 * ( (J+1) + size_y_2 * K);
-                        // Ez(mm, nn, pp):
-                        index_2Moins = I + size_x_2 * ( J     + size_y_2 * K);
-                        
-
-                        ASSERT(index,<,grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2]);
-                        ASSERT(index_1Plus,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
-                        ASSERT(index_1Moins,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
-                        ASSERT(index_2Plus,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
-                        ASSERT(index_2Moins,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
-
-                        H_x_tmp[index] = C_hxh[index] * H_x_tmp[index]
-                                + C_hxe_1[index] * (E_y_tmp[index_1Plus] - E_y_tmp[index_1Moins])
-                                - C_hxe_2[index] * (E_z_tmp[index_2Plus] - E_z_tmp[index_2Moins]);
-
-                    }
-                }
-            }
-
-            // Updating the magnetic field Hy.
-            // Don't update neighboors ! Start at 1. Go to size-1.
-
-            size_x = grid.size_Hy[0];
-            size_y = grid.size_Hy[1];
-
-            size_x_1 = grid.size_Ez[0];
-            size_y_1 = grid.size_Ez[1];
-
-            size_x_2 = grid.size_Ex[0];
-            size_y_2 = grid.size_Ex[1];
-
-            #pragma omp for schedule(static) collapse(3) nowait
-            for(K = 1 ; K < grid.size_Hy[2]-1 ; K ++){
-                for(J = 1 ; J < grid.size_Hy[1]-1 ; J ++){
-                    for(I = 1; I < grid.size_Hy[0]-1 ; I ++){
-
-                        index        = I   + size_x   * ( J  + size_y   * K);
-                        // Ez(mm + 1, nn, pp):
-                        index_1Plus  = I+1 + size_x_1 * ( J  + size_y_1 * K);
-                        // Ez(mm, nn, pp)
-                        index_1Moins = I   + size_x_1 * ( J  + size_y_1 * K);
-                        // Ex(mm, nn, pp + 1):
-                        index_2Plus  = I   + size_x_2 * ( J  + size_y_2 * (K+1));
-                        // Ex(mm, nn, pp):
-                        index_2Moins = I   + size_x_2 * ( J  + size_y_2 * K);
-
-                        ASSERT(index,<,grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2]);
-                        ASSERT(index_2Plus,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
-                        ASSERT(index_2Moins,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
-                        ASSERT(index_1Plus,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
-                        ASSERT(index_1Moins,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
-
-                        H_y_tmp[index] = C_hyh[index] * H_y_tmp[index]
-                                + C_hye_1[index] * (E_z_tmp[index_1Plus] - E_z_tmp[index_1Moins])
-                                - C_hye_2[index] * (E_x_tmp[index_2Plus] - E_x_tmp[index_2Moins]);
-
-                    }
-                }
-            }
-
-            // Updating the magnetic field Hz.
-            // Don't update neighboors ! Start at 1. Go to size-1.
-
-            size_x = grid.size_Hz[0];
-            size_y = grid.size_Hz[1];
-
-            size_x_1 = grid.size_Ex[0];
-            size_y_1 = grid.size_Ex[1];
-
-            size_x_2 = grid.size_Ey[0];
-            size_y_2 = grid.size_Ey[1];
-
-            #pragma omp for schedule(static) collapse(3) nowait
-            for(K = 1 ; K < grid.size_Hz[2]-1  ; K ++){
-                for(J = 1 ; J < grid.size_Hz[1]-1 ; J ++){
-                    for(I = 1 ; I < grid.size_Hz[0]-1 ; I ++){
-
-                        index        = I   + size_x   * ( J     + size_y   * K);
-                        // Ex(mm, nn + 1, pp)
-                        index_1Plus  = I   + size_x_1 * ( (J+1) + size_y_1 * K);
-                        // Ex(mm, nn, pp)
-                        index_1Moins = I   + size_x_1 * ( J     + size_y_1 * K);
-                        // Ey(mm + 1, nn, pp)
-                        index_2Plus  = I+1 + size_x_2 * ( J     + size_y_2 * K);
-                        // Ey(mm, nn, pp)
-                        index_2Moins = I   + size_x_2 * ( J     + size_y_2 * K);
-
-                        ASSERT(index,<,grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2]);
-                        ASSERT(index_1Plus,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
-                        ASSERT(index_1Moins,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
-                        ASSERT(index_2Plus,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
-                        ASSERT(index_2Moins,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
-
-                        H_z_tmp[index] = C_hzh[index] * H_z_tmp[index]
-                                + C_hze_1[index] * (E_x_tmp[index_1Plus] - E_x_tmp[index_1Moins])
-                                - C_hze_2[index] * (E_y_tmp[index_2Plus] - E_y_tmp[index_2Moins]);
-
-                    }
+            /// Number of steps done in this iteration (more than one with temporal blocking or slabs):
+            size_t block_depth = 1;
+            std::vector<double> block_times;
+            if(CAN_USE_TEMPORAL_BLOCKING || CAN_USE_SLAB_PIPELINE){
+                /// The master thread updates current_time at the end of the previous iteration:
+                #pragma omp barrier
+                block_depth = last_step - currentStep;
+                if(CAN_USE_TEMPORAL_BLOCKING){
+                    block_depth = std::min(TEMPORAL_BLOCKING_DEPTH,block_depth);
+                }
+                /// Stop the block on the steps where the fields are written:
+                if(grid.input_parser.SAMPLING_FREQ_ELECTRO > 0){
+                    block_depth = std::min(block_depth,
+                        grid.input_parser.SAMPLING_FREQ_ELECTRO
+                            - currentStep % grid.input_parser.SAMPLING_FREQ_ELECTRO);
+                }
+                /// Stop the block on the steps after which the ghost layers are exchanged:
+                if(HAS_GHOST_LAYERS){
+                    block_depth = std::min(block_depth,
+                        grid.ghost_layers - currentStep % grid.ghost_layers);
+                }
+                /// Simulation time of each step of the block:
+                double time_step = current_time;
+                while(block_times.size() < block_depth && time_step < grid.input_parser.get_stopTime()){
+                    block_times.push_back(time_step);
+                    time_step += dt;
+                }
+                block_depth = block_times.size();
+            }
+
+            if(block_depth > 1 && CAN_USE_SLAB_PIPELINE){
+
+                if(slab < nbr_slabs){
+                    this->update_slab_pipeline(
+                        grid,
+                        Yee_H, Yee_E,
+                        range_H, range_E,
+                        tile_size,
+                        COEFFICIENTS_PER_MATERIAL,
+                        local_nodes_inside_source_NUMBER,
+                        ID_Source,
+                        local_nodes_inside_source_FREQ,
+                        sources_in_plane,
+                        MODULATE_SOURCE,
+                        Eyx0, Ezx0,
+                        Eyx1, Ezx1,
+                        Exy0, Ezy0,
+                        Exy1, Ezy1,
+                        Exz0, Eyz0,
+                        Exz1, Eyz1,
+                        dt,
+                        block_times,
+                        currentStep,
+                        slab_progress,
+                        slab,
+                        nbr_slabs,
+                        K_beg_slab,
+                        K_end_slab
+                    );
                 }
-            }
-
-            /////////////////////////////////////////////////////
-            /// OPENMP barrier because we must ensure all the ///
-            /// magnetic fields have been updated.            ///
-            /////////////////////////////////////////////////////
-            #pragma omp barrier
-
+                #pragma omp barrier
 
-            /////////////////////////
-            /// MPI COMMUNICATION ///
-            /////////////////////////
-            gettimeofday( &start_mpi_comm, NULL);
-            /// Prepare the array to send:
-            if(has_neighboor){
-                prepare_array_to_be_sent(
-                    Electric_field_to_send,
-                    Magnetic_field_to_send,
-                    electric_field_sizes,
-                    magnetic_field_sizes,
-                    E_x_tmp,
-                    E_y_tmp,
-                    E_z_tmp,
-                    H_x_tmp,
-                    H_y_tmp,
-                    H_z_tmp,
-                    grid.MPI_communicator.RankNeighbour,
-                    #ifndef NDEBUG
-                        size_faces_electric,
-                        size_faces_magnetic,
-                    #endif
-                    false /* false : tells the function we want to deal with magnetic field only */
+                /// The last step of the block is finalized below, as a normal step:
+                currentStep += block_depth - 1;
+                #pragma omp master
+                {
+                    current_time = block_times[block_depth-1];
+                }
+
+            }else if(block_depth > 1){
+
+                this->update_temporal_block(
+                    grid,
+                    Yee_H, Yee_E,
+                    range_H, range_E,
+                    tile_size, USE_TILES,
+                    COEFFICIENTS_PER_MATERIAL,
+                    local_nodes_inside_source_NUMBER,
+                    ID_Source,
+                    local_nodes_inside_source_FREQ,
+                    sources_in_plane,
+                    MODULATE_SOURCE,
+                    Eyx0, Ezx0,
+                    Eyx1, Ezx1,
+                    Exy0, Ezy0,
+                    Exy1, Ezy1,
+                    Exz0, Eyz0,
+                    Exz1, Eyz1,
+                    dt,
+                    block_times,
+                    K_beg_temporal_block,
+                    K_end_temporal_block
                 );
-
-                /// Wait all omp threads:
                 #pragma omp barrier
 
-                /// Only the master thread communicates:
+                /// The last step of the block is finalized below, as a normal step:
+                currentStep += block_depth - 1;
                 #pragma omp master
                 {
-                    communicate_single_omp_thread(
-                        Electric_field_to_send,
-                        Electric_field_to_recv,
-                        Magnetic_field_to_send,
-                        Magnetic_field_to_recv,
-                        grid.MPI_communicator.RankNeighbour,
-                        grid.MPI_communicator.getRank(),
-                        size_faces_electric,
-                        size_faces_magnetic,
-                        false /* false : tells the function we want to deal with magnetic field only */
-                    );
+                    current_time = block_times[block_depth-1];
                 }
 
-                /// Other threads wait for the communication to be done:
-                #pragma omp barrier
-
-                /// Fill in the matrix of electric field with what was received:
-                use_received_array(
-                    Electric_field_to_recv,
-                    Magnetic_field_to_recv,
-                    electric_field_sizes,
-                    magnetic_field_sizes,
-                    E_x_tmp,
-                    E_y_tmp,
-                    E_z_tmp,
-                    H_x_tmp,
-                    H_y_tmp,
-                    H_z_tmp,
-                    grid.MPI_communicator.RankNeighbour,
-                    #ifndef NDEBUG
-                        size_faces_electric,
-                        size_faces_magnetic,
-                    #endif
-                    false /* false : tells the function we want to deal with magnetic field only */
-                );           
-
-                #pragma omp barrier
-            }
-            gettimeofday( &end___mpi_comm , NULL);
-            total_mpi_comm += end___mpi_comm.tv_sec  - start_mpi_comm.tv_sec + 
-                                (end___mpi_comm.tv_usec - start_mpi_comm.tv_usec) / 1.e6;
-            /////////////////////////
-            ///      END OF       ///
-            /// MPI COMMUNICATION ///
-            /////////////////////////
-
-
-
-            // Updating the electric field Ex.
-            // Don't update neighboors ! Start at 1. Go to size-1.
-
-            size_x = grid.size_Ex[0];
-            size_y = grid.size_Ex[1];
-
-            size_x_1 = grid.size_Hz[0];
-            size_y_1 = grid.size_Hz[1];
-
-            size_x_2 = grid.size_Hy[0];
-            size_y_2 = grid.size_Hy[1];
-
-
-            #pragma omp for schedule(static) collapse(3) nowait
-            for(K = 1 + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDZ ;
-                    K < grid.size_Ex[2]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDZ ; 
-                    K ++){
-                for(J = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDY ; 
-                        J < grid.size_Ex[1]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDY ; 
-                        J ++){
-                    for(I = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDX; 
-                            I < grid.size_Ex[0]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDX; 
-                            I ++){
-
-                        index        = I   + size_x   * ( J     + size_y   * K);
-                        // Hz(mm, nn, pp)
-                        index_1Plus  = I
-                                   + size_x_1 * ( J
-                                        + size_y_1 * (K));
-                        // Hz(mm, nn - 1, pp)
-                        index_1Moins = I
-                                   + size_x_1 * ( J-1
-                                      + size_y_1 * (K));
-                        // Hy(mm, nn, pp)
-                        index_2Plus  = I 
-                                   + size_x_2 * ( J
-                                        + size_y_2 * (K));
-                        // Hy(mm, nn, pp - 1)
-                        index_2Moins = I 
-                                   + size_x_2 * ( J 
-                                        + size_y_2 * (K-1 ));
-
-                        ASSERT(index,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
-                        ASSERT(index_1Plus,<,grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2]);
-                        ASSERT(index_1Moins,<,grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2]);
-                        ASSERT(index_2Plus,<,grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2]);
-                        ASSERT(index_2Moins,<,grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2]);
-
-                        E_x_tmp[index] = C_exe[index] * E_x_tmp[index]
-                                + C_exh_1[index] * (H_z_tmp[index_1Plus] - H_z_tmp[index_1Moins])
-                                - C_exh_2[index] * (H_y_tmp[index_2Plus] - H_y_tmp[index_2Moins]);
+            }else{
 
+                // Updating the magnetic field (Hx, Hy, Hz):
+                if(USE_TILES){
+                    update_yee_field_tiled(Yee_H,COEFFICIENTS_PER_MATERIAL,range_H,tile_size);
+                }else{
+                    for(unsigned int c = 0 ; c < 3 ; c ++){
+                        update_yee_component(Yee_H[c],COEFFICIENTS_PER_MATERIAL,range_H[c]);
                     }
                 }
-            }
+                /////////////////////////////////////////////////////
+                /// OPENMP barrier because we must ensure all the ///
+                /// magnetic fields have been updated.            ///
+                /////////////////////////////////////////////////////
+                #pragma omp barrier
 
-            // Updating the electric field Ey.
-            // Don't update neighboors ! Start at 1. Go to size-1.
-
-            size_x = grid.size_Ey[0];
-            size_y = grid.size_Ey[1];
-
-            size_x_1 = grid.size_Hx[0];
-            size_y_1 = grid.size_Hx[1];
-
-            size_x_2 = grid.size_Hz[0];
-            size_y_2 = grid.size_Hz[1];
-
-            #pragma omp for schedule(static) collapse(3) nowait
-            for(K = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDZ ; K < grid.size_Ey[2]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDZ ; K ++){
-                for(J = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDY; J < grid.size_Ey[1]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDY ; J ++){
-                    for(I = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDX ; I < grid.size_Ey[0]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDX ; I ++){
-
-                        index        = I   + size_x   * ( J     + size_y   * K);
-                        // Hx(mm, nn, pp)
-                        index_1Plus  = I 
-                               + size_x_1 * ( J 
-                                    + size_y_1 * (K ));
-                        // Hx(mm, nn, pp - 1)
-                        index_1Moins = I 
-                                    + size_x_1 * ( J 
-                                         + size_y_1 * (K-1 ));
-                        // Hz(mm, nn, pp)
-                        index_2Plus  = I
-                                    + size_x_2 * ( J 
-                                         + size_y_2 * (K ));
-                        // Hz(mm - 1, nn, pp)
-                        index_2Moins = I-1 
-                                    + size_x_2 * ( J 
-                                         + size_y_2 * (K ));
-
-                        ASSERT(index,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
-                        ASSERT(index_2Plus,<,grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2]);
-                        ASSERT(index_2Moins,<,grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2]);
-                        ASSERT(index_1Plus,<,grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2]);
-                        ASSERT(index_1Moins,<,grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2]);
-
-                        E_y_tmp[index] = C_eye[index] * E_y_tmp[index]
-                                + C_eyh_1[index] * (H_x_tmp[index_1Plus] - H_x_tmp[index_1Moins])
-                                - C_eyh_2[index] * (H_z_tmp[index_2Plus] - H_z_tmp[index_2Moins]);
 
+                /////////////////////////
+                /// MPI COMMUNICATION ///
+                /////////////////////////
+                /// The halos of H are sent and received while the interior of E is updated.
+                gettimeofday( &start_mpi_comm, NULL);
+                if(HAS_HALF_STEP_HALOS){
+                    /// The messages are started by the threads of their faces, the copies from the
+                    /// shared memory by the master thread:
+                    start_halo_exchange(magnetic_halo_requests);
+                    #pragma omp master
+                    start_shared_memory_halo(magnetic_shared_halo);
+                }
+                gettimeofday( &end___mpi_comm , NULL);
+                total_mpi_comm += end___mpi_comm.tv_sec  - start_mpi_comm.tv_sec + 
+                                    (end___mpi_comm.tv_usec - start_mpi_comm.tv_usec) / 1.e6;
+
+                // Updating the electric field (Ex, Ey, Ez).
+                // The nodes of the boundary of the whole domain are done by the ABC.
+                // With neighbours, only the nodes which do not use the halos of H are updated here.
+                const YeeRange *range_E_no_halo = HAS_HALF_STEP_HALOS ? range_E_interior : range_E;
+                if(USE_TILES){
+                    update_yee_field_tiled(Yee_E,COEFFICIENTS_PER_MATERIAL,range_E_no_halo,tile_size);
+                }else{
+                    for(unsigned int c = 0 ; c < 3 ; c ++){
+                        update_yee_component(Yee_E[c],COEFFICIENTS_PER_MATERIAL,range_E_no_halo[c]);
                     }
                 }
-            }
 
-            // Updating the electric field Ez.
-            // Don't update neighboors ! Start at 1. Go to size-1.
-
-            size_x = grid.size_Ez[0];
-            size_y = grid.size_Ez[1];
-
-            size_x_1 = grid.size_Hy[0];
-            size_y_1 = grid.size_Hy[1];
-
-            size_x_2 = grid.size_Hx[0];
-            size_y_2 = grid.size_Hx[1];
-
-            #pragma omp for schedule(static) collapse(3) nowait
-            for(K = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDZ; K < grid.size_Ez[2]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDZ ; K ++){
-                for(J = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDY ; J < grid.size_Ez[1]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDY ; J ++){
-                    for(I = 1  + IS_THE_FIRST_MPI_FOR_ELECRIC_FIELDX ; I < grid.size_Ez[0]-1 - IS_THE_LAST_MPI_FOR_ELECTRIC_FIELDX ; I ++){
-
-                        index        = I   + size_x   * ( J     + size_y   * K);
-                        // Hy(mm, nn, pp)
-                        index_1Plus  = I 
-                                + size_x_1 * ( J 
-                                        + size_y_1 * (K ));
-                        // Hy(mm - 1, nn, pp)
-                        index_1Moins = I-1 
-                                + size_x_1 * ( J 
-                                        + size_y_1 * (K ));
-                        // Hx(mm, nn, pp)
-                        index_2Plus  = I 
-                                + size_x_2 * ( J 
-                                        + size_y_2 * (K));
-                        // Hx(mm, nn - 1, pp)
-                        index_2Moins = I 
-                                + size_x_2 * ( J-1 
-                                        + size_y_2 * (K ));
-
-                        ASSERT(index,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
-                        ASSERT(index_1Plus,<,grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2]);
-                        ASSERT(index_1Moins,<,grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2]);
-                        ASSERT(index_2Plus,<,grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2]);
-                        ASSERT(index_2Moins,<,grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2]);
-
-                        E_z_tmp[index] = C_eze[index] * E_z_tmp[index]
-                                + C_ezh_1[index] * (H_y_tmp[index_1Plus] - H_y_tmp[index_1Moins])
-                                - C_ezh_2[index] * (H_x_tmp[index_2Plus] - H_x_tmp[index_2Moins]);
+                gettimeofday( &start_mpi_comm, NULL);
+                if(HAS_HALF_STEP_HALOS){
+                    #pragma omp master
+                    wait_shared_memory_halo(magnetic_shared_halo);
+                    wait_halo_exchange(magnetic_halo_requests);
+
+                    /// Other threads wait for the communication (and the interior of E) to be done:
+                    #pragma omp barrier
+                }
+                gettimeofday( &end___mpi_comm , NULL);
+                total_mpi_comm += end___mpi_comm.tv_sec  - start_mpi_comm.tv_sec + 
+                                    (end___mpi_comm.tv_usec - start_mpi_comm.tv_usec) / 1.e6;
+                /////////////////////////
+                ///      END OF       ///
+                /// MPI COMMUNICATION ///
+                /////////////////////////
+
+                /// Nodes of E next to the faces with a neighbour (they use the received halos of H):
+                if(HAS_HALF_STEP_HALOS){
+                    for(unsigned int c = 0 ; c < 3 ; c ++){
+                        for(unsigned int side = 0 ; side < 6 ; side ++){
+                            update_yee_component(Yee_E[c],COEFFICIENTS_PER_MATERIAL,range_E_shell[c][side]);
+                        }
                     }
                 }
-            }
-            #pragma omp barrier
-
-            ////////////////////////////
-            /// IMPOSING THE SOURCES ///
-            ////////////////////////////
-            #pragma omp for schedule(static) nowait
-            for(size_t it = 0 ; it < local_nodes_inside_source_NUMBER[2].size() ; it ++){
-
-                index = local_nodes_inside_source_NUMBER[2][it];
-                ASSERT(index,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
-
-                double gauss     = 1;
-                double frequency = 0;
-
-                if(ID_Source[2][it] == UCHAR_MAX){
-                    frequency = 0;
-                }else{
-
-                    frequency = local_nodes_inside_source_FREQ[ID_Source[2][it]];
-
-                    if(MODULATE_SOURCE == true){
-                        double period    = 2*M_PI/frequency;
-                        double MEAN      = 0*period;
-                        double STD       = period/10;
-                                        
-                        double t = current_time;
-                        
-                        gauss = exp(-((t-MEAN)*(t-MEAN))/(2*STD*STD));
-                    }
-
-                }                
-
-                E_z_tmp[index] = gauss * sin(2*M_PI*frequency*current_time);
-
-            }
-
-
-            #pragma omp for schedule(static) nowait
-            for(size_t it = 0 ; it < local_nodes_inside_source_NUMBER[1].size() ; it ++){
-
-                index = local_nodes_inside_source_NUMBER[1][it];
-                ASSERT(index,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
-
-                double gauss     = 1;
-                double frequency = 0;
+                #pragma omp barrier
 
-                if(ID_Source[1][it] == UCHAR_MAX){
-                    frequency = 0;
-                }else{
+                ////////////////////////////
+                /// IMPOSING THE SOURCES ///
+                ////////////////////////////
+                #pragma omp for schedule(static) nowait
+                for(size_t it = 0 ; it < local_nodes_inside_source_NUMBER[2].size() ; it ++){
 
-                    frequency = local_nodes_inside_source_FREQ[ID_Source[1][it]];
+                    index = local_nodes_inside_source_NUMBER[2][it];
+                    ASSERT(index,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
 
-                    if(MODULATE_SOURCE == true){
-                        double period    = 2*M_PI/frequency;
-                        double MEAN      = 0*period;
-                        double STD       = period/10;
-                                        
-                        double t = current_time;
-                        
-                        gauss = exp(-((t-MEAN)*(t-MEAN))/(2*STD*STD));
-                    }
+                    E_z_tmp[index] = source_value(
+                        ID_Source[2][it],
+                        local_nodes_inside_source_FREQ,
+                        MODULATE_SOURCE,
+                        current_time);
                 }
 
-                E_y_tmp[index] = gauss * sin(2*M_PI*frequency*current_time);
-            }
 
-            #pragma omp for schedule(static) nowait
-            for(size_t it = 0 ; it < local_nodes_inside_source_NUMBER[0].size() ; it ++){
+                #pragma omp for schedule(static) nowait
+                for(size_t it = 0 ; it < local_nodes_inside_source_NUMBER[1].size() ; it ++){
 
-                index = local_nodes_inside_source_NUMBER[0][it];
-                ASSERT(index,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
+                    index = local_nodes_inside_source_NUMBER[1][it];
+                    ASSERT(index,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
 
-                double gauss     = 1;
-                double frequency = 0;
+                    E_y_tmp[index] = source_value(
+                        ID_Source[1][it],
+                        local_nodes_inside_source_FREQ,
+                        MODULATE_SOURCE,
+                        current_time);
+                }
 
-                if(ID_Source[0][it] == UCHAR_MAX){
-                    frequency = 0;
-                }else{
+                #pragma omp for schedule(static) nowait
+                for(size_t it = 0 ; it < local_nodes_inside_source_NUMBER[0].size() ; it ++){
 
-                    frequency = local_nodes_inside_source_FREQ[ID_Source[0][it]];
+                    index = local_nodes_inside_source_NUMBER[0][it];
+                    ASSERT(index,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
 
-                    if(MODULATE_SOURCE == true){
-                        double period    = 2*M_PI/frequency;
-                        double MEAN      = 0*period;
-                        double STD       = period/10;
-                                        
-                        double t = current_time;
-                        
-                        gauss = exp(-((t-MEAN)*(t-MEAN))/(2*STD*STD));
-                    }
+                    E_x_tmp[index] = source_value(
+                        ID_Source[0][it],
+                        local_nodes_inside_source_FREQ,
+                        MODULATE_SOURCE,
+                        current_time);
                 }
 
-                E_x_tmp[index] = gauss * sin(2*M_PI*frequency*current_time);
-            }
-
             
             
-            /////////////////////////
-            /// MPI COMMUNICATION ///
-            /////////////////////////
-
-            /// Wait all OPENMP threads to be sure computations are done for this step:
-            #pragma omp barrier
-            gettimeofday( &start_mpi_comm , NULL);
-            /// Prepare the array to send:
-            if(has_neighboor){
-                prepare_array_to_be_sent(
-                    Electric_field_to_send,
-                    Magnetic_field_to_send,
-                    electric_field_sizes,
-                    magnetic_field_sizes,
-                    E_x_tmp,
-                    E_y_tmp,
-                    E_z_tmp,
-                    H_x_tmp,
-                    H_y_tmp,
-                    H_z_tmp,
-                    grid.MPI_communicator.RankNeighbour,
-                    #ifndef NDEBUG
-                        size_faces_electric,
-                        size_faces_magnetic,
-                    #endif
-                    true // True : telling the function we communicate only electric field
-                );
+                /////////////////////////
+                /// MPI COMMUNICATION ///
+                /////////////////////////
+                /// The planes next to the faces are sent straight from the fields, so the ABC (which
+                /// updates some of their nodes) is only applied once they are sent, as before.
 
-                /// Wait all omp threads:
+                /// Wait all OPENMP threads to be sure computations are done for this step:
                 #pragma omp barrier
-
-                /// Only the master thread communicates:
-                #pragma omp master
-                {
-                    communicate_single_omp_thread(
-                        Electric_field_to_send,
-                        Electric_field_to_recv,
-                        Magnetic_field_to_send,
-                        Magnetic_field_to_recv,
-                        grid.MPI_communicator.RankNeighbour,
-                        grid.MPI_communicator.getRank(),
-                        size_faces_electric,
-                        size_faces_magnetic,
-                        true
+                gettimeofday( &start_mpi_comm , NULL);
+                if(HAS_HALF_STEP_HALOS){
+                    start_halo_exchange(electric_halo_requests);
+                    #pragma omp master
+                    {
+                        start_shared_memory_halo(electric_shared_halo);
+                        wait_shared_memory_halo(electric_shared_halo);
+                    }
+                    wait_halo_exchange(electric_halo_requests);
+
+                    /// Other threads wait for the communication to be done:
+                    #pragma omp barrier
+                }
+                gettimeofday( &end___mpi_comm , NULL);
+                total_mpi_comm += end___mpi_comm.tv_sec  - start_mpi_comm.tv_sec + 
+                                    (end___mpi_comm.tv_usec - start_mpi_comm.tv_usec) / 1.e6;
+
+                /////////////////////////
+                ///      END OF       ///
+                /// MPI COMMUNICATION ///
+                /////////////////////////
+
+                /// The ABC is shared by the threads (faces x and y by planes, then faces z by rows):
+                this->abc(grid,
+                    E_x_tmp, E_y_tmp, E_z_tmp, 
+                    Eyx0, Ezx0, 
+                    Eyx1, Ezx1, 
+                    Exy0, Ezy0, 
+                    Exy1, Ezy1, 
+                    Exz0, Eyz0, 
+                    Exz1, Eyz1,
+                    dt
                     );
-                }
-
-                /// Other threads wait for the communication to be done:
-                #pragma omp barrier
-
-                /// Fill in the matrix of electric field with what was received:
-                use_received_array(
-                    Electric_field_to_recv,
-                    Magnetic_field_to_recv,
-                    electric_field_sizes,
-                    magnetic_field_sizes,
-                    E_x_tmp,
-                    E_y_tmp,
-                    E_z_tmp,
-                    H_x_tmp,
-                    H_y_tmp,
-                    H_z_tmp,
-                    grid.MPI_communicator.RankNeighbour,
-                    #ifndef NDEBUG
-                        size_faces_electric,
-                        size_faces_magnetic,
-                    #endif
-                    true // True : telling the function that we communicate electric field only.
-                );           
-
                 #pragma omp barrier
-
             }
 
-           
-            gettimeofday( &end___mpi_comm , NULL);
-            total_mpi_comm += end___mpi_comm.tv_sec  - start_mpi_comm.tv_sec + 
-                                (end___mpi_comm.tv_usec - start_mpi_comm.tv_usec) / 1.e6;
-
-            /////////////////////////
-            ///      END OF       ///
-            /// MPI COMMUNICATION ///
-            /////////////////////////
-            
-            #pragma omp barrier
-            #pragma omp master
-            {
-            this->abc(grid,
-                E_x_tmp, E_y_tmp, E_z_tmp, 
-                Eyx0, Ezx0, 
-                Eyx1, Ezx1, 
-                Exy0, Ezy0, 
-                Exy1, Ezy1, 
-                Exz0, Eyz0, 
-                Exz1, Eyz1,
-                dt
-                );
+            /// Several ghost layers: exchange of all the ghost layers, every ghost_layers steps
+            /// (currentStep is the last step done, the blocks stop on these steps):
+            if(HAS_GHOST_LAYERS && (currentStep + 1) % grid.ghost_layers == 0){
+                gettimeofday( &start_mpi_comm , NULL);
+                for(unsigned int direction = 0 ; direction < 3 ; direction ++){
+                    start_halo_exchange(ghost_layers_halo_requests[direction]);
+                    wait_halo_exchange(ghost_layers_halo_requests[direction]);
+                    /// The next direction sends the ghost layers received here:
+                    #pragma omp barrier
+                }
+                gettimeofday( &end___mpi_comm , NULL);
+                total_mpi_comm += end___mpi_comm.tv_sec  - start_mpi_comm.tv_sec +
+                                    (end___mpi_comm.tv_usec - start_mpi_comm.tv_usec) / 1.e6;
             }
-            #pragma omp barrier
 
             #pragma omp master
 
 
             gettimeofday( &end___while_iter , NULL);
-            total_while_iter += end___while_iter.tv_sec  - start_while_iter.tv_sec + 
+            double time_of_iter = end___while_iter.tv_sec  - start_while_iter.tv_sec + 
                                 (end___while_iter.tv_usec - start_while_iter.tv_usec) / 1.e6;
+            total_while_iter += time_of_iter;
 
             currentStep ++;
 
@@ -1424,6 +2233,7 @@ void AlgoElectro_NEW::update(
             #pragma omp master
             {
                 /// PROBE POINTS IF NECESSARY
+                double time_probing = omp_get_wtime();
                 if(!grid.input_parser.points_to_be_probed.empty()){
                     for(size_t curr_pt = 0 ; curr_pt < grid.input_parser.points_to_be_probed.size();
                                 curr_pt ++)
@@ -1450,8 +2260,10 @@ void AlgoElectro_NEW::update(
                         }
                 }
 
-                /// If this is the first step, add some inputs to the profiler:
-                if(currentStep == 1){
+                time_probing = omp_get_wtime() - time_probing;
+
+                /// If this is the first iteration, add some inputs to the profiler:
+                if(currentStep == block_depth){
                     grid.profiler.addTimingInputToDictionnary("ELECTRO_WRITING_OUTPUTS",true);
                     grid.profiler.addTimingInputToDictionnary("ELECTRO_MPI_COMM",true);
                 }
@@ -1480,6 +2292,9 @@ void AlgoElectro_NEW::update(
 
                 grid.profiler.incrementTimingInput("ELECTRO_MPI_COMM",total_mpi_comm);
 
+                /// Compute time of this process (without the MPI communications), used to rebalance the planes:
+                grid.profiler.incrementTimingInput("ELECTRO_COMPUTE",time_of_iter - total_mpi_comm + time_probing);
+
                 if(    grid.MPI_communicator.isRootProcess() != INT_MIN 
                     && currentStep == grid.input_parser.maxStepsForOneCycleOfElectro){
                         printf("%s[MPI %d - Electro - Update - step %zu]%s\n"
@@ -1512,100 +2327,124 @@ void AlgoElectro_NEW::update(
                 total_mpi_comm = 0;
 
                 current_time += dt;
-                
+
+            }
+
+            /// The fields are copied by the master thread on the output steps, before being updated again:
+            if( (currentStep%grid.input_parser.SAMPLING_FREQ_ELECTRO) == 0 ){
+                #pragma omp barrier
             }
-                        
+
         } /* END OF WHILE LOOP */
 
+        #pragma omp master
+        {
+            step_at_end             = currentStep;
+            total_while_iter_at_end = total_while_iter;
+        }
+
     }/* END OF PARALLEL REGION */
 
+    *step            = step_at_end;
+    *simulation_time = current_time;
+    *time_in_while   = total_while_iter_at_end;
+
 
     /* FREE MEMORY */
     
     delete[] local_nodes_inside_source_NUMBER;
     delete[] ID_Source;
+
+    delete_aligned_array(uniform_row_Hx);
+    delete_aligned_array(uniform_row_Hy);
+    delete_aligned_array(uniform_row_Hz);
+    delete_aligned_array(uniform_row_Ex);
+    delete_aligned_array(uniform_row_Ey);
+    delete_aligned_array(uniform_row_Ez);
     
     // Free H_x coefficients:
     size = grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2];
-    delete[] C_hxh;
-    delete[] C_hxe_1;
-    delete[] C_hxe_2;
+    delete_aligned_array(C_hxh);
+    delete_aligned_array(C_hxe_1);
+    delete_aligned_array(C_hxe_2);
 
 
     // Free H_y coefficents:
     size = grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2];
-    delete[] C_hyh;
-    delete[] C_hye_1;
-    delete[] C_hye_2;
+    delete_aligned_array(C_hyh);
+    delete_aligned_array(C_hye_1);
+    delete_aligned_array(C_hye_2);
 
     // Free H_z coefficients:
     size = grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2];
-    delete[] C_hzh;
-    delete[] C_hze_1;
-    delete[] C_hze_2;
+    delete_aligned_array(C_hzh);
+    delete_aligned_array(C_hze_1);
+    delete_aligned_array(C_hze_2);
 
     // Free E_x coefficients:
     size = grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2];
-    delete[] C_exe;
-    delete[] C_exh_1;
-    delete[] C_exh_2;
+    delete_aligned_array(C_exe);
+    delete_aligned_array(C_exh_1);
+    delete_aligned_array(C_exh_2);
 
     // Free E_y coefficients:
     size = grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2];
-    delete[] C_eye;
-    delete[] C_eyh_1;
-    delete[] C_eyh_2;
+    delete_aligned_array(C_eye);
+    delete_aligned_array(C_eyh_1);
+    delete_aligned_array(C_eyh_2);
 
     // Free E_z coefficients:
     size = grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2];
-    delete[] C_eze;
-    delete[] C_ezh_1;
-    delete[] C_ezh_2;
-
-    /**
-     * @brief Freeing memory of ABC conditions.
-     * 
-     * Note: The delete[] checks for NULLPTR so no need to do 
-     *      if(ptr != NULL) {delete[] ptr;}
-     * but simply do delete[] ptr;
-     */
-    delete[] Eyx0;
-    delete[] Eyx1;
-    delete[] Ezx0;
-    delete[] Ezx1;
-    delete[] Exy0;
-    delete[] Exy1;
-    delete[] Ezy0;
-    delete[] Ezy1;
-    delete[] Exz0;
-    delete[] Exz1;
-    delete[] Eyz0;
-    delete[] Eyz1;
-
-    /// Free electric and magnetic fields:
+    delete_aligned_array(C_eze);
+    delete_aligned_array(C_ezh_1);
+    delete_aligned_array(C_ezh_2);
+
+    /// Free the requests of the exchanges, then the datatypes of the faces:
+    free_halo_exchange(electric_halo_requests);
+    free_halo_exchange(magnetic_halo_requests);
+    for(unsigned int direction = 0 ; direction < 3 ; direction ++){
+        free_halo_exchange(ghost_layers_halo_requests[direction]);
+    }
+    if(halo_progress_window != MPI_WIN_NULL){
+        MPI_Win_free(&halo_progress_window);
+    }
     for(unsigned int i = 0 ; i < NBR_FACES_CUBE ; i ++){
-        if(Electric_field_to_send[i] != NULL)
-            free(Electric_field_to_send[i]);
-        if(Electric_field_to_recv[i] != NULL)
-            free(Electric_field_to_recv[i]);
-        if(Magnetic_field_to_recv[i] != NULL)
-            free(Magnetic_field_to_recv[i]);
-        if(Magnetic_field_to_send[i] != NULL)
-            free(Magnetic_field_to_send[i]);
+        if(electric_face_to_send[i] != MPI_DATATYPE_NULL)
+            MPI_Type_free(&electric_face_to_send[i]);
+        if(electric_face_to_recv[i] != MPI_DATATYPE_NULL)
+            MPI_Type_free(&electric_face_to_recv[i]);
+        if(magnetic_face_to_send[i] != MPI_DATATYPE_NULL)
+            MPI_Type_free(&magnetic_face_to_send[i]);
+        if(magnetic_face_to_recv[i] != MPI_DATATYPE_NULL)
+            MPI_Type_free(&magnetic_face_to_recv[i]);
+        if(ghost_layers_to_send[i] != MPI_DATATYPE_NULL)
+            MPI_Type_free(&ghost_layers_to_send[i]);
+        if(ghost_layers_to_recv[i] != MPI_DATATYPE_NULL)
+            MPI_Type_free(&ghost_layers_to_recv[i]);
     }
-    if(Electric_field_to_send != NULL){free(Electric_field_to_send);}
-    if(Electric_field_to_recv != NULL){free(Electric_field_to_recv);}
-    if(Magnetic_field_to_send != NULL){free(Magnetic_field_to_send);}
-    if(Magnetic_field_to_recv != NULL){free(Magnetic_field_to_recv);}
-
-    /// Compute total elapsed time inside UPDATE:
-    gettimeofday(&end, NULL);
 
-    double delta = end.tv_sec  - start.tv_sec + 
-                        (end.tv_usec - start.tv_usec) / 1.e6;
+}
 
-    grid.profiler.incrementTimingInput("AlgoElectro_NEW_UPDATE_gettimeofday",delta);
-    //std::cout << "AlgoElectro_NEW_UPDATE => Time: " << delta << " s" << std::endl;
+/**
+ * @brief This is the electromagnetic algorithm (FDTD scheme).
+ *
+ * Calls update_fields with the precision asked in the input file ($ELECTRO_SOLVER PRECISION):
+ *      DOUBLE : double fields and coefficients,
+ *      FLOAT  : float fields and coefficients (half the memory and bandwidth),
+ *      MIXED  : float fields, double coefficients. The update is computed in double, so that
+ *               the loss terms are accumulated in double before the result is stored in float.
+ */
+void AlgoElectro_NEW::update(
+    GridCreator_NEW &grid,
+    InterfaceToParaviewer &interfaceParaview)
+{
+    if(grid.input_parser.ELECTRO_PRECISION == "FLOAT"){
+        this->update_fields<float,float>(grid,interfaceParaview);
+    }else if(grid.input_parser.ELECTRO_PRECISION == "MIXED"){
+        this->update_fields<float,double>(grid,interfaceParaview);
+    }else{
+        this->update_fields<double,double>(grid,interfaceParaview);
+    }
 }
 
 void AlgoElectro_NEW::check_OMP_DYNAMIC_envVar(void){
@@ -1630,61 +2469,189 @@ void AlgoElectro_NEW::check_OMP_DYNAMIC_envVar(void){
 
 
 
+/**
+ * @brief Mur ABC on all the faces, shared by the threads of the team.
+ *
+ * Must be called by all the threads of the parallel region (it contains orphaned 'omp for').
+ * The faces x0, x1, y0 and y1 only use the plane of the node they update: the planes are shared
+ * by the threads, each plane getting its four faces in the same order as abc_on_planes.
+ * The faces z0 and z1 use the planes 1, 2, size_z-3 and size_z-2, so they are applied after the
+ * implicit barrier of the first loop, shared by rows j. The last loop has no barrier: the caller
+ * must put one before using the fields.
+ */
+template<typename FIELD_TYPE>
 void AlgoElectro_NEW::abc(   GridCreator_NEW &grid, 
-            double *Ex, double *Ey, double *Ez,  
-            double *Eyx0, double *Ezx0, 
-            double *Eyx1, double *Ezx1, 
-            double *Exy0, double *Ezy0, 
-            double *Exy1, double *Ezy1, 
-            double *Exz0, double *Eyz0,
-            double *Exz1, double *Eyz1,
+            FIELD_TYPE *Ex, FIELD_TYPE *Ey, FIELD_TYPE *Ez,  
+            FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0, 
+            FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1, 
+            FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0, 
+            FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1, 
+            FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+            FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
             double dt
         )
 {
-    size_t i, j, k;
-
-
-    std::vector<double> delta_Electromagn = grid.delta_Electromagn;
-    size_t size_x =0 , size_y = 0, size_z = 0; 
-    size_t index, index_1Plus, index_1Moins, indexTmp;
-    double c, abccoef;
+    const std::vector<double> &delta_Electromagn = grid.delta_Electromagn;
 
+    #pragma omp master
+    {
     printf("omp_get _num_threads() = %d ", omp_get_num_threads());
-
-
-// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
-// !!!!!!!!!!!!!!!! A MODIFIER !!!!!!!!!!!!!!!!!!!!!!!!! |
-// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
     printf("Attention pas la bonne vitesse de la lumière (line %d)\n",__LINE__);
-    c = 299792458;                                   //  |
-// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
-// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
-
-
-
-    
-
-
-    /*  Dans cette section, on va considérer que les dimensions dans chaque direction
-        seront correctement donnee sans correction a appliquer:
-        - Plus de "-1" 
-        - Tous les indices ont la même expression 
-        Par contre, une correction sera appliquee en prenant en compte le colonnes 
-        untiles a la communication:
-        - "-2" à size_x,y,z uniquement dans "IndexTmp"
-        Il restera a discuter des equations BC sur les aretes d'intersections qui, 
-        quoiqu'il advienne causeront des refections d'onde.
-    */
-
     printf("delta t = %.15lf\n", dt);
     printf("E_y_eps = %f\n", delta_Electromagn[0]);
     printf("delta_Electromagn[1] = %f\n", delta_Electromagn[1]);
     printf("delta_Electromagn[2] = %f\n", delta_Electromagn[2]);
     printf("delta_Electromagn[0] = %f\n", delta_Electromagn[0]);
+    }
 
+    /// Faces x0, x1, y0 and y1, plane by plane:
+    size_t nbr_planes = std::max(grid.size_Ex[2],std::max(grid.size_Ey[2],grid.size_Ez[2]));
+
+    #pragma omp for schedule(static)
+    for(size_t k = 1 ; k < nbr_planes - 1 ; k ++){
+        this->abc_xy_faces_on_planes(grid,
+            Ex, Ey, Ez,
+            Eyx0, Ezx0,
+            Eyx1, Ezx1,
+            Exy0, Ezy0,
+            Exy1, Ezy1,
+            dt,
+            k,
+            k+1
+        );
+    }
 
+    /// Faces z0 and z1, row by row:
+    size_t nbr_rows = std::max(grid.size_Ex[1],grid.size_Ey[1]);
+
+    #pragma omp for schedule(static) nowait
+    for(size_t j = 1 ; j < nbr_rows - 1 ; j ++){
+        this->abc_z_faces_on_rows(grid,
+            Ex, Ey,
+            Exz0, Eyz0,
+            Exz1, Eyz1,
+            dt,
+            true,
+            true,
+            j,
+            j+1
+        );
+    }
+}
 
-    /* ABC at "x0" */
+/**
+ * @brief Mur ABC, restricted to the planes K_beg <= k < K_end.
+ *
+ * The faces x0, x1, y0 and y1 are updated plane by plane. The face z0 is updated with the
+ * plane k = 2, and the face z1 with the plane k = size_z-2, which are the last planes they use.
+ */
+template<typename FIELD_TYPE>
+void AlgoElectro_NEW::abc_on_planes(   GridCreator_NEW &grid, 
+            FIELD_TYPE *Ex, FIELD_TYPE *Ey, FIELD_TYPE *Ez,  
+            FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0, 
+            FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1, 
+            FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0, 
+            FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1, 
+            FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+            FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+            double dt,
+            size_t K_beg,
+            size_t K_end
+        )
+{
+    this->abc_xy_faces_on_planes(grid,
+        Ex, Ey, Ez,
+        Eyx0, Ezx0,
+        Eyx1, Ezx1,
+        Exy0, Ezy0,
+        Exy1, Ezy1,
+        dt,
+        K_beg,
+        K_end
+    );
+
+    bool apply_z0 = K_beg <= 2 && 2 < K_end;
+    bool apply_z1 = K_beg <= grid.size_Ex[2]-2 && grid.size_Ex[2]-2 < K_end;
+
+    if(apply_z0 || apply_z1){
+        this->abc_z_faces_on_rows(grid,
+            Ex, Ey,
+            Exz0, Eyz0,
+            Exz1, Eyz1,
+            dt,
+            apply_z0,
+            apply_z1,
+            0,
+            SIZE_MAX
+        );
+    }
+}
+
+/**
+ * @brief Mur update of 'nbr_nodes' nodes of a face, 'stride' elements apart in the field:
+ *          field = old + abccoef * (neighbour - field), then old = neighbour.
+ *        'old' is contiguous. With stride = 1, the loop is vectorized.
+ */
+template<typename FIELD_TYPE>
+static inline void mur_abc_on_nodes(
+            FIELD_TYPE       * __restrict__ field,
+            const FIELD_TYPE * __restrict__ neighbour,
+            FIELD_TYPE       * __restrict__ old,
+            size_t nbr_nodes,
+            size_t stride,
+            double abccoef
+        )
+{
+    for(size_t n = 0 ; n < nbr_nodes ; n ++){
+        field[n*stride] = old[n] + abccoef * (neighbour[n*stride] - field[n*stride]);
+        old[n]          = neighbour[n*stride];
+    }
+}
+
+/**
+ * @brief Mur ABC on the faces x0, x1, y0 and y1, restricted to the planes K_beg <= k < K_end.
+ *
+ * Each node only uses its own plane. In a plane, the y faces are looped along i (unit stride) and the
+ * x faces along j. The old tangential fields are stored plane by plane: (k-1)*(size_y-2)+(j-1) for
+ * the x faces, (k-1)*(size_x-2)+(i-1) for the y faces.
+ */
+template<typename FIELD_TYPE>
+void AlgoElectro_NEW::abc_xy_faces_on_planes(   GridCreator_NEW &grid, 
+            FIELD_TYPE *Ex, FIELD_TYPE *Ey, FIELD_TYPE *Ez,  
+            FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0, 
+            FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1, 
+            FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0, 
+            FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1, 
+            double dt,
+            size_t K_beg,
+            size_t K_end
+        )
+{
+    size_t i, j, k;
+
+    const std::vector<double> &delta_Electromagn = grid.delta_Electromagn;
+    size_t size_x =0 , size_y = 0, size_z = 0; 
+    double c, abccoef;
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
+// !!!!!!!!!!!!!!!! A MODIFIER !!!!!!!!!!!!!!!!!!!!!!!!! |
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
+    c = 299792458;                                   //  |
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
+
+    /*  Dans cette section, on va considérer que les dimensions dans chaque direction
+        seront correctement donnee sans correction a appliquer:
+        - Plus de "-1" 
+        - Tous les indices ont la même expression 
+        Par contre, une correction sera appliquee en prenant en compte le colonnes 
+        untiles a la communication:
+        - "-2" à size_x,y,z uniquement dans "IndexTmp"
+        Il restera a discuter des equations BC sur les aretes d'intersections qui, 
+        quoiqu'il advienne causeront des refections d'onde.
+    */
+
+    /* ABC at "x0" */
 
     if(grid.MPI_communicator.RankNeighbour[1] == -1){
         i = 1;
@@ -1693,41 +2660,41 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
         size_y = grid.size_Ey[1];
         size_z = grid.size_Ey[2];
 
-
-        for (j = 1; j < size_y - 1; j++) // Peut-etre inverser les boucles
-            for (k = 1; k < size_z -1 ; k++) {
-                index = i + size_x * ( j + size_y * k);
-                index_1Plus = i+1 + size_x * (j + size_y *k);
-                indexTmp = (j-1) * (size_z -2) + (k-1);
-                // c = 1/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[1] -1) / (c*dt/delta_Electromagn[1] +1);
-                Ey[index] = Eyx0[indexTmp] +
-                    abccoef * (Ey[index_1Plus] - Ey[index]);
-                Eyx0[indexTmp] = Ey[index_1Plus];
-            }
-
-    
+        // c = 1/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[1] -1) / (c*dt/delta_Electromagn[1] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ey[i   + size_x * (1 + size_y * k)],
+                &Ey[i+1 + size_x * (1 + size_y * k)],
+                &Eyx0[(k-1) * (size_y - 2)],
+                size_y - 2,
+                size_x,
+                abccoef
+            );
+        }
 
         size_x = grid.size_Ez[0];
         size_y = grid.size_Ez[1];
         size_z = grid.size_Ez[2];
 
-        for (j = 1; j < size_y - 1 ; j++)
-            for (k = 1; k < size_z - 1; k++) {
-                index = i + size_x * ( j + size_y * k);
-                index_1Plus = i+1 + size_x * (j + size_y *k);
-                indexTmp = (j-1) * (size_z -2) + (k-1);
-                // c = 1/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ez[index] = Ezx0[indexTmp] +
-                    abccoef * (Ez[index_1Plus] - Ez[index]);
-                Ezx0[indexTmp] = Ez[index_1Plus];
-
-            }
+        // c = 1/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ez[i   + size_x * (1 + size_y * k)],
+                &Ez[i+1 + size_x * (1 + size_y * k)],
+                &Ezx0[(k-1) * (size_y - 2)],
+                size_y - 2,
+                size_x,
+                abccoef
+            );
+        }
 
     } // End if
 
-/* ABC at "x1" */   
+    /* ABC at "x1" */   
 
     if(grid.MPI_communicator.RankNeighbour[0] == -1){
         
@@ -1737,19 +2704,19 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
 
         i = size_x - 2;
 
-        for (j = 1; j < size_y - 1; j++) // -1 not to take the last column which is to send
-            for (k = 1; k < size_z - 1; k++) { // -1 not to take the last column
-                index = i + size_x * ( j + size_y * k); //
-                index_1Moins = i-1 + size_x * (j + size_y *k);
-                indexTmp = (j-1) * (size_z - 2) + (k-1) ;
-                // c = 1.0/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ey[index] = Eyx1[indexTmp] +
-                    abccoef * (Ey[index_1Moins] - Ey[index]);
-                Eyx1[indexTmp] = Ey[index_1Moins];
-            }
-
-        
+        // c = 1.0/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ey[i   + size_x * (1 + size_y * k)],
+                &Ey[i-1 + size_x * (1 + size_y * k)],
+                &Eyx1[(k-1) * (size_y - 2)],
+                size_y - 2,
+                size_x,
+                abccoef
+            );
+        }
 
         size_x = grid.size_Ez[0];
         size_y = grid.size_Ez[1];
@@ -1757,17 +2724,19 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
         
         i = size_x - 2;
 
-        for ( j = 1; j < size_y - 1; j++) 
-            for (k = 1; k < size_z -  1; k++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Moins = i-1 + size_x * (j + size_y *k);
-                indexTmp = (j-1) * (size_z - 2) + (k-1) ;
-                // c = 1.0/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ez[index] = Ezx1[indexTmp] +
-                    abccoef * (Ez[index_1Moins] - Ez[index]);
-                Ezx1[indexTmp] = Ez[index_1Moins];
-            }
+        // c = 1.0/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ez[i   + size_x * (1 + size_y * k)],
+                &Ez[i-1 + size_x * (1 + size_y * k)],
+                &Ezx1[(k-1) * (size_y - 2)],
+                size_y - 2,
+                size_x,
+                abccoef
+            );
+        }
 
     } // End if
 
@@ -1780,38 +2749,39 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
         size_y = grid.size_Ex[1];
         size_z = grid.size_Ex[2];
 
-        for (i = 1; i < size_x - 1; i++)
-            for (k = 1; k < size_z - 1; k++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Plus = i + size_x * ((j+1) + size_y *k);
-                indexTmp = (i-1) * (size_z - 2) + (k-1) ;
-                // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ex[index] = Exy0[indexTmp] +
-                    abccoef * (Ex[index_1Plus] - Ex[index]);
-                Exy0[indexTmp] = Ex[index_1Plus];
- 
-            }
+        // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ex[1 + size_x * (j     + size_y * k)],
+                &Ex[1 + size_x * ((j+1) + size_y * k)],
+                &Exy0[(k-1) * (size_x - 2)],
+                size_x - 2,
+                (size_t)1,
+                abccoef
+            );
+        }
         
         size_x = grid.size_Ez[0];
         size_y = grid.size_Ez[1];
         size_z = grid.size_Ez[2];
 
-        for (i = 1; i < size_x - 1; i++)
-            for (k = 1; k < size_z - 1; k++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Plus = i + size_x * ((j+1) + size_y *k);
-                indexTmp = (i-1) * (size_z - 2) + (k-1) ;
-                // c = 1.0/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ez[index] = Ezy0[indexTmp] +
-                    abccoef * (Ez[index_1Plus] - Ez[index]);
-                Ezy0[indexTmp] = Ez[index_1Plus];
-            }
+        // c = 1.0/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ez[1 + size_x * (j     + size_y * k)],
+                &Ez[1 + size_x * ((j+1) + size_y * k)],
+                &Ezy0[(k-1) * (size_x - 2)],
+                size_x - 2,
+                (size_t)1,
+                abccoef
+            );
+        }
     } //End if
 
-
-    
     /* ABC at "y1" */
 
     if(grid.MPI_communicator.RankNeighbour[3] == -1){
@@ -1822,18 +2792,19 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
 
         j = size_y - 2;
 
-        for (i = 1; i < size_x - 1; i++)
-            for (k = 1; k < size_z -1; k++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Moins = i + size_x * ((j-1) + size_y *k);
-                indexTmp = (i-1) * (size_z - 2) + (k-1) ;
-                // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ex[index] = Exy1[indexTmp] +
-                    abccoef * (Ex[index_1Moins] - Ex[index]);
-                Exy1[indexTmp] = Ex[index_1Moins];
-
-            }
+        // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ex[1 + size_x * (j     + size_y * k)],
+                &Ex[1 + size_x * ((j-1) + size_y * k)],
+                &Exy1[(k-1) * (size_x - 2)],
+                size_x - 2,
+                (size_t)1,
+                abccoef
+            );
+        }
 
         size_x = grid.size_Ez[0];
         size_y = grid.size_Ez[1];
@@ -1841,68 +2812,100 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
 
         j = size_y - 2;
 
-        for (i = 1; i < size_x - 1; i++)
-            for (k = 1; k < size_z - 1; k++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Moins = i + size_x * ((j-1) + size_y *k);
-                indexTmp = (i-1) * (size_z - 2) + (k-1) ;
-                // c = 1.0/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ez[index] = Ezy1[indexTmp] +
-                abccoef * (Ez[index_1Moins] - Ez[index]);
-                Ezy1[indexTmp] = Ez[index_1Moins];
-
-            }
+        // c = 1.0/(sqrt(grid.E_z_eps[index]*grid.H_z_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (k = std::max((size_t)1,K_beg); k < std::min(size_z - 1,K_end); k++){
+            mur_abc_on_nodes(
+                &Ez[1 + size_x * (j     + size_y * k)],
+                &Ez[1 + size_x * ((j-1) + size_y * k)],
+                &Ezy1[(k-1) * (size_x - 2)],
+                size_x - 2,
+                (size_t)1,
+                abccoef
+            );
+        }
     } // End if
 
+    return;
+}
+
+/**
+ * @brief Mur ABC on the faces z0 (if apply_z0) and z1 (if apply_z1), restricted to the rows J_beg <= j < J_end.
+ *
+ * Each node only uses its own row (i varies, unit stride). The old tangential fields are stored
+ * row by row: (j-1)*(size_x-2)+(i-1).
+ */
+template<typename FIELD_TYPE>
+void AlgoElectro_NEW::abc_z_faces_on_rows(   GridCreator_NEW &grid, 
+            FIELD_TYPE *Ex, FIELD_TYPE *Ey,
+            FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+            FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+            double dt,
+            bool apply_z0,
+            bool apply_z1,
+            size_t J_beg,
+            size_t J_end
+        )
+{
+    size_t i, j, k;
+
+    const std::vector<double> &delta_Electromagn = grid.delta_Electromagn;
+    size_t size_x =0 , size_y = 0, size_z = 0; 
+    size_t index, index_1Plus, indexTmp;
+    double c, abccoef;
 
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
+// !!!!!!!!!!!!!!!! A MODIFIER !!!!!!!!!!!!!!!!!!!!!!!!! |
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
+    c = 299792458;                                   //  |
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! |
 
     /* ABC at "z0" (bottom) */
 
-    if(grid.MPI_communicator.RankNeighbour[4] == -1){
+    if(grid.MPI_communicator.RankNeighbour[4] == -1 && apply_z0){
         k = 1;
 
-
         size_x = grid.size_Ex[0];
         size_y = grid.size_Ex[1];
         size_z = grid.size_Ex[2];
 
-        for (i = 1; i < size_x - 1; i++)
-            for (j = 1; j < size_y -1 ; j++) {
+        // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (j = std::max((size_t)1,J_beg); j < std::min(size_y - 1,J_end); j++)
+            for (i = 1; i < size_x - 1; i++) {
                 index = i + size_x * ( j + size_y * k); //
                 index_1Plus = i + size_x * (j + size_y *(k+1));
-                indexTmp = (i-1) * (size_y - 2) + (j-1) ;
-                // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+                indexTmp = (j-1) * (size_x - 2) + (i-1) ;
                 Ex[index] = Exz0[indexTmp] +
                 abccoef * (Ex[index] - Ex[index]);
                 Exz0[indexTmp] = Ex[index_1Plus];
- 
             }
 
         size_x = grid.size_Ey[0];
         size_y = grid.size_Ey[1];
         size_z = grid.size_Ey[2];
 
-        for (i = 1; i < size_x - 1; i++)
-            for (j = 1; j < size_y - 1; j++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Plus = i + size_x * (j + size_y *(k+1));
-                indexTmp = (i-1) * (size_y - 2) + (j-1) ;
-                // c = 1.0/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ey[index] = Eyz0[indexTmp] +
-                abccoef * (Ey[index_1Plus] - Ey[index]);
-                Eyz0[indexTmp] = Ey[index_1Plus];
-
-            }
+        // c = 1.0/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (j = std::max((size_t)1,J_beg); j < std::min(size_y - 1,J_end); j++){
+            mur_abc_on_nodes(
+                &Ey[1 + size_x * (j + size_y * k)],
+                &Ey[1 + size_x * (j + size_y * (k+1))],
+                &Eyz0[(j-1) * (size_x - 2)],
+                size_x - 2,
+                (size_t)1,
+                abccoef
+            );
+        }
     } //End if
 
-
-
     /* ABC at "z1" (top) */
 
-    if(grid.MPI_communicator.RankNeighbour[5] == -1){
+    if(grid.MPI_communicator.RankNeighbour[5] == -1 && apply_z1){
 
         size_x = grid.size_Ex[0];
         size_y = grid.size_Ex[1];
@@ -1910,18 +2913,19 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
 
         k = size_z - 2;
 
-        for (i = 1; i < size_x - 1; i++)
-            for (j = 1; j < size_y - 1; j++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Moins = i + size_x * (j + size_y *(k-1));
-                indexTmp = (i-1) * (size_y - 2) + (j-1) ;
-                // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ex[index] = Exz1[indexTmp] +
-                abccoef * (Ex[index_1Moins] - Ex[index]);
-                Exz1[indexTmp] = Ex[index_1Moins];
-
-            }
+        // c = 1.0/(sqrt(grid.E_x_eps[index]*grid.H_x_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (j = std::max((size_t)1,J_beg); j < std::min(size_y - 1,J_end); j++){
+            mur_abc_on_nodes(
+                &Ex[1 + size_x * (j + size_y * k)],
+                &Ex[1 + size_x * (j + size_y * (k-1))],
+                &Exz1[(j-1) * (size_x - 2)],
+                size_x - 2,
+                (size_t)1,
+                abccoef
+            );
+        }
 
         size_x = grid.size_Ey[0];
         size_y = grid.size_Ey[1];
@@ -1929,22 +2933,22 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
 
         k = size_z - 2;
 
-        for (i = 1; i < size_x - 1; i++)
-            for (j = 1; j < size_y - 1; j++) {
-                index = i + size_x * ( j + size_y * k); //
-                index_1Moins = i + size_x * (j + size_y *(k-1));
-                indexTmp = (i-1) * (size_y - 2) + (j-1) ;
-                // c = 1.0/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
-                abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
-                Ey[index] = Eyz1[indexTmp] +
-                abccoef * (Ey[index_1Moins] - Ey[index]);
-                Eyz1[indexTmp] = Ey[index_1Moins];
-
-            }
+        // c = 1.0/(sqrt(grid.E_y_eps[index]*grid.H_y_mu[index]));
+        abccoef = (c*dt/delta_Electromagn[2] -1) / (c*dt/delta_Electromagn[2] +1);
+
+        for (j = std::max((size_t)1,J_beg); j < std::min(size_y - 1,J_end); j++){
+            mur_abc_on_nodes(
+                &Ey[1 + size_x * (j + size_y * k)],
+                &Ey[1 + size_x * (j + size_y * (k-1))],
+                &Eyz1[(j-1) * (size_x - 2)],
+                size_x - 2,
+                (size_t)1,
+                abccoef
+            );
+        }
 
     } // End if 
 
-
     return;
 }    
 
@@ -1952,1886 +2956,335 @@ void AlgoElectro_NEW::abc(   GridCreator_NEW &grid,
 
 
 
-void prepare_array_to_be_sent(
-                double ** Electric_field_to_send,
-                double ** Magnetic_field_to_send,
-                std::vector<size_t> &electric_field_sizes,
-                std::vector<size_t> &magnetic_field_sizes,
-                double *E_x,
-                double *E_y,
-                double *E_z,
-                double *H_x,
-                double *H_y,
-                double *H_z,
-                int    *mpi_rank_neighboor,
-                #ifndef NDEBUG
-                    std::vector<size_t> &size_faces_electric,
-                    std::vector<size_t> &size_faces_magnetic,
-                #endif
-                bool is_electric_to_prepare
+/**
+ * Creates the persistent requests of the exchange of one field (electric or magnetic) with the
+ * neighbours, face by face: MPI_Recv_init into the ghost planes, then MPI_Send_init of the planes
+ * next to the face, for each face with a neighbour and a datatype (MPI_DATATYPE_NULL if nothing is
+ * received, or sent, on this face), straight from the field arrays (see create_halo_face_datatype).
+ * The messages sent on the face FACE have the tag tag_offset + FACE, so that the exchanges of
+ * different fields never match each other.
+ * The exchange is then done at each step by start_halo_exchange and wait_halo_exchange,
+ * and the requests are freed by free_halo_exchange.
+ */
+void init_halo_exchange(
+                const MPI_Datatype *face_to_send,
+                const MPI_Datatype *face_to_recv,
+                int *mpi_to_who,
+                int  mpi_me,
+                int  tag_offset,
+                bool per_face_threads,
+                HaloExchange &halo
             )
 {
-    /////////////////////////////////////////////////////////
-    /// CONVENTION FOR COMMUNICATION                      ///
-    /// 1) OMP thread(0) communicates with SOUTH. (face 0)///
-    /// 2) OMP thread(1) communicates with NORTH. (face 1)///
-    /// 3) OMP thread(2) communicates with WEST.  (face 2)///
-    /// 3) OMP thread(3) communicates with EAST.  (face 3)///
-    /// 4) OMP thread(4) communicates with DOWN.  (face 4)///
-    /// 5) OMP thread(5) communicates with UP.    (face 5)///
-    /////////////////////////////////////////////////////////
-
-    size_t DECAL = DECALAGE_E_SUPP;
-
-    //if(direction == 'W'){
-    /// The W direction corresponds to (-y) axis. Denoted by face number 2 (numbering starting from 0).
-    if(mpi_rank_neighboor[2] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_prepare){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    index   = i + electric_field_sizes[0] * ( 1 + electric_field_sizes[1] * k );
-                    
-                    counter = i-DECAL + (k-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_electric[2]);
-
-                    Electric_field_to_send[2][counter] = E_x[index];    
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    index   = i + magnetic_field_sizes[0] * ( 1 + magnetic_field_sizes[1] * k );
-                    
-                    counter = i-DECAL + (k-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_magnetic[2]);
-
-                    Magnetic_field_to_send[2][counter] = H_x[index];
-
-                    //printf("Electric_field_to_send[2][%zu] = %lf\n",counter,Electric_field_to_send[2][counter]);
-                }
-            }
-        }
-
-        if(is_electric_to_prepare){
-            /// Put E_y:
-            /// Offset due to already put inside the face[2]:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+3] * ( 1 + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
-                    
-                    ASSERT( counter ,<, size_faces_electric[2]);
-
-                    Electric_field_to_send[2][counter] = E_y[index];
+    #ifndef NDEBUG
+        printf("[MPI %d] - NEIGHBOORS [%d,%d,%d,%d,%d,%d]\n",
+            mpi_me,
+            mpi_to_who[0],mpi_to_who[1],mpi_to_who[2],mpi_to_who[3],
+            mpi_to_who[4],mpi_to_who[5]);
+        fflush(stdout);
+    #endif
 
-                    //printf("Electric_field_to_send[2][%zu] = %lf\n",counter,Electric_field_to_send[2][counter]);
+    halo.per_face_threads = per_face_threads;
+    int nbr_requests = 0;
 
-                }
-            }
-        }else{
-            /// Put H_y:
-            /// Offset due to already put inside the face[2]:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+3] * ( 1 + magnetic_field_sizes[1+3] * k );
+    /// LOOP OVER THE 6 FACES:
+    for(unsigned int FACE = 0 ; FACE < NBR_FACES_CUBE ; FACE ++){
 
-                    counter = counter_prev_magn + (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-                    
-                    ASSERT( counter ,<, size_faces_magnetic[2]);
+        halo.face_begin[FACE] = nbr_requests;
 
-                    Magnetic_field_to_send[2][counter] = H_y[index];
+        // If it is -1, then no need to communicate ! Just continue.
+        if(mpi_to_who[FACE] == -1){continue;}
 
-                }
-            }
+        if(mpi_to_who[FACE] == mpi_me){
+            fprintf(stderr,"In function %s :: no way to communicate between MPI %d and"
+                            " MPI %d, on face %d. Aborting.\n",
+                            __FUNCTION__,mpi_me,mpi_to_who[FACE],FACE);
+            fprintf(stderr,"In %s:%d\n",__FILE__,__LINE__);
+            #ifdef MPI_COMM_WORLD
+                MPI_Abort(MPI_COMM_WORLD,-1);
+            #else
+                abort();
+            #endif
         }
 
-        if(is_electric_to_prepare){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+2*3] * ( 1 + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+2*3]-2*DECAL);
+        if(face_to_recv[FACE] != MPI_DATATYPE_NULL){
+            /// The neighbour sends its opposite face, with the number of this face as tag:
+            int neighboorComm = -1;
 
-                    ASSERT( counter ,<, size_faces_electric[2]);
+            if( FACE == 0 ){ neighboorComm = 1; }
+            if( FACE == 1 ){ neighboorComm = 0; }
+            if( FACE == 2 ){ neighboorComm = 3; }
+            if( FACE == 3 ){ neighboorComm = 2; }
+            if( FACE == 4 ){ neighboorComm = 5; }
+            if( FACE == 5 ){ neighboorComm = 4; }
 
-                    Electric_field_to_send[2][counter] = E_z[index];
-
-                    //printf("Electric_field_to_send[2][%zu] = %lf\n",counter,Electric_field_to_send[2][counter]);
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+2*3] * ( 1 + magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0+2*3]-2*DECAL);
+            #ifndef NDEBUG
+                printf("[MPI %d - FACE %d] recv from [MPI %d] | recvTag %d\n",
+                        mpi_me,
+                        FACE,
+                        mpi_to_who[FACE],
+                        tag_offset + neighboorComm);
+            #endif
 
-                    ASSERT( counter ,<, size_faces_magnetic[2]);
+            MPI_Recv_init(
+                    MPI_BOTTOM,
+                    1,
+                    face_to_recv[FACE],
+                    mpi_to_who[FACE],
+                    tag_offset + neighboorComm,
+                    MPI_COMM_WORLD,
+                    &halo.requests[nbr_requests]
+            );
+            nbr_requests ++;
+        }
 
-                    Magnetic_field_to_send[2][counter] = H_z[index];
+        if(face_to_send[FACE] != MPI_DATATYPE_NULL){
+            #ifndef NDEBUG
+                printf("[MPI %d - FACE %d] send to   [MPI %d] | sendTag %d\n",
+                        mpi_me,
+                        FACE,
+                        mpi_to_who[FACE],
+                        tag_offset + FACE);
+            #endif
 
-                }
-            }
+            MPI_Send_init(
+                    MPI_BOTTOM,
+                    1,
+                    face_to_send[FACE],
+                    mpi_to_who[FACE],
+                    tag_offset + FACE,
+                    MPI_COMM_WORLD,
+                    &halo.requests[nbr_requests]
+            );
+            nbr_requests ++;
         }
     }
-    //if(direction == 'E'){
-    /// The E direction corresponds to (+y) axis. Denoted by face number 3 (numbering starting from 0).
-    if(mpi_rank_neighboor[3] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_prepare){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-2 !!!!!
-                     * En fait, si on avait itér sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3]-1 ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-2 !!!
-                     */
-                    index      = i + electric_field_sizes[0] * ( electric_field_sizes[1]-2 + electric_field_sizes[1] * k );
-
-                    counter = (i-DECAL) + (k-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_electric[3]);
-
-                    Electric_field_to_send[3][counter] = E_x[index];
-
-                }
-            }
-        }else{
-            /// Put = H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-2 !!!!!
-                     * En fait, si on avait itér sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3]-1 ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-2 !!!
-                     */
-                    index      = i + magnetic_field_sizes[0] * ( magnetic_field_sizes[1]-2 +
-                                    magnetic_field_sizes[1] * k );
-
-                    counter = (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_magnetic[3]);
-
-                    Magnetic_field_to_send[3][counter] = H_x[index];
+    halo.face_begin[NBR_FACES_CUBE] = nbr_requests;
+}
 
-                }
-            }
+/**
+ * OpenMP thread which starts and waits for the requests of the face FACE (-1 if the face has none).
+ * With per_face_threads, the faces with requests are given in turn to the threads of the team,
+ * otherwise the master thread has all of them.
+ */
+int halo_face_thread(const HaloExchange &halo, unsigned int FACE){
+    if(halo.face_begin[FACE] == halo.face_begin[FACE+1]){
+        return -1;
+    }
+    if(!halo.per_face_threads){
+        return 0;
+    }
+    int nbr_faces_before = 0;
+    for(unsigned int f = 0 ; f < FACE ; f ++){
+        if(halo.face_begin[f] != halo.face_begin[f+1]){
+            nbr_faces_before ++;
         }
+    }
+    return nbr_faces_before % omp_get_num_threads();
+}
 
-        if(is_electric_to_prepare){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-2 !!!!!
-                     * En fait, si on avait itér sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3]-1 ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-2 !!!
-                     */
-                    index = i + electric_field_sizes[0+3] * ( electric_field_sizes[1+3]-2 + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
+/**
+ * Starts the exchange created by init_halo_exchange. Called by all the threads of the team, each
+ * one starting the requests of its faces (see halo_face_thread). The sent planes must not be
+ * modified, nor the ghost planes used, before all the threads return from wait_halo_exchange.
+ */
+void start_halo_exchange(HaloExchange &halo){
+    int thread = omp_get_thread_num();
+    for(unsigned int FACE = 0 ; FACE < NBR_FACES_CUBE ; FACE ++){
+        if(halo_face_thread(halo,FACE) == thread){
+            MPI_Startall(halo.face_begin[FACE+1] - halo.face_begin[FACE],&halo.requests[halo.face_begin[FACE]]);
+        }
+    }
+}
 
-                    ASSERT( counter ,< ,size_faces_electric[3]);
+/**
+ * Waits for the requests of the faces started by this thread in start_halo_exchange (called by all
+ * the threads of the team, the other faces are only done once all the threads have returned).
+ */
+void wait_halo_exchange(HaloExchange &halo){
+    int thread = omp_get_thread_num();
+    for(unsigned int FACE = 0 ; FACE < NBR_FACES_CUBE ; FACE ++){
+        if(halo_face_thread(halo,FACE) == thread){
+            MPI_Waitall(halo.face_begin[FACE+1] - halo.face_begin[FACE],&halo.requests[halo.face_begin[FACE]],
+                MPI_STATUSES_IGNORE);
+        }
+    }
+}
 
-                    Electric_field_to_send[3][counter] = E_y[index];
+/**
+ * Frees the persistent requests created by init_halo_exchange (no exchange must be in progress).
+ */
+void free_halo_exchange(HaloExchange &halo){
+    for(int r = 0 ; r < halo.face_begin[NBR_FACES_CUBE] ; r ++){
+        MPI_Request_free(&halo.requests[r]);
+    }
+}
 
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-2 !!!!!
-                     * En fait, si on avait itér sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3]-1 ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-2 !!!
-                     */
-                    index = i + magnetic_field_sizes[0+3] * ( magnetic_field_sizes[1+3]-2
-                            + magnetic_field_sizes[1+3] * k );
-
-                    counter = counter_prev_magn + (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter ,< ,size_faces_magnetic[3]);
-
-                    Magnetic_field_to_send[3][counter] = H_y[index];
+/**
+ * Sets up the exchange of one field (electric or magnetic) with the neighbours of the same node, whose fields
+ * are in shared memory (see GridCreator_NEW::fields_in_shared_memory). progress_window has two HaloProgress
+ * per process of the node (electric, then magnetic), built before the call.
+ * As with the messages, E is copied from the neighbours of the faces 0, 3 and 5 and H from the neighbours
+ * of the faces 1, 2 and 4 (see the datatypes in update_fields_until_step).
+ */
+template<typename FIELD_TYPE>
+void init_shared_memory_halo(
+                GridCreator_NEW &grid,
+                bool is_electric,
+                MPI_Win progress_window,
+                SharedMemoryHalo<FIELD_TYPE> &halo
+            )
+{
+    FIELD_TYPE *E_fields[3];
+    FIELD_TYPE *H_fields[3];
+    grid.get_field_arrays(E_fields,H_fields);
+    const std::vector<size_t> *sizes[3] = {&grid.size_Ex,&grid.size_Ey,&grid.size_Ez};
+    if(!is_electric){
+        sizes[0] = &grid.size_Hx; sizes[1] = &grid.size_Hy; sizes[2] = &grid.size_Hz;
+    }
 
-                }
-            }
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        halo.field[c] = is_electric ? E_fields[c] : H_fields[c];
+        for(unsigned int d = 0 ; d < 3 ; d ++){
+            halo.size[c][d] = (*sizes[c])[d];
         }
+    }
 
-        if(is_electric_to_prepare){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-2 !!!!!
-                     * En fait, si on avait itér sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3]-1 ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-2 !!!
-                     */
-                    index = i + electric_field_sizes[0+2*3] * ( electric_field_sizes[1+2*3]-2 + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+2*3]-2*DECAL);
+    if(progress_window == MPI_WIN_NULL){
+        return;
+    }
 
-                    ASSERT( counter, < ,size_faces_electric[3]);
+    unsigned int first_window = is_electric ? 0 : 3;
+    unsigned int field_index  = is_electric ? 0 : 1;
 
-                    Electric_field_to_send[3][counter] = E_z[index];
+    MPI_Aint bytes;
+    int      disp_unit;
+    void    *base;
 
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-2 !!!!!
-                     * En fait, si on avait itér sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3]-1 ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-2 !!!
-                     */
-                    index = i + magnetic_field_sizes[0+2*3] * ( magnetic_field_sizes[1+2*3]-2 + 
-                                magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (i-DECAL) +
-                                    (k-DECAL) * (magnetic_field_sizes[0+2*3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[3]);
-
-                    Magnetic_field_to_send[3][counter] = H_z[index];
+    int my_node_rank;
+    MPI_Comm_rank(grid.node_communicator,&my_node_rank);
+    MPI_Win_shared_query(progress_window,my_node_rank,&bytes,&disp_unit,&base);
+    halo.progress = static_cast<HaloProgress*>(base) + field_index;
 
-                }
-            }
+    /// Sizes of the fields of the neighbours (the windows of shared memory are rounded up to whole pages):
+    unsigned long my_sizes[9];
+    unsigned long neighbour_sizes[NBR_FACES_CUBE][9];
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        for(unsigned int d = 0 ; d < 3 ; d ++){
+            my_sizes[3*c+d] = halo.size[c][d];
         }
-
     }
-    //if(direction == 'S'){
-    /// The S direction corresponds to (+x) axis. Denoted by face number 0 (numbering starting from 0).
-    if(mpi_rank_neighboor[0] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
+    MPI_Request requests[2*NBR_FACES_CUBE];
+    int         nbr_requests = 0;
+    int         node_rank[NBR_FACES_CUBE];
+    for(unsigned int FACE = 0 ; FACE < NBR_FACES_CUBE ; FACE ++){
+        node_rank[FACE] = grid.rank_in_node(grid.MPI_communicator.RankNeighbour[FACE]);
+        if(node_rank[FACE] < 0){continue;}
+        MPI_Irecv(neighbour_sizes[FACE],9,MPI_UNSIGNED_LONG,grid.MPI_communicator.RankNeighbour[FACE],
+            TAG_SHARED_HALO_SIZES,MPI_COMM_WORLD,&requests[nbr_requests++]);
+        MPI_Isend(my_sizes,9,MPI_UNSIGNED_LONG,grid.MPI_communicator.RankNeighbour[FACE],
+            TAG_SHARED_HALO_SIZES,MPI_COMM_WORLD,&requests[nbr_requests++]);
+    }
+    MPI_Waitall(nbr_requests,requests,MPI_STATUSES_IGNORE);
 
-        if(is_electric_to_prepare){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                    index      = electric_field_sizes[0]-2 + electric_field_sizes[0] * ( j + electric_field_sizes[1] * k );
+    for(unsigned int FACE = 0 ; FACE < NBR_FACES_CUBE ; FACE ++){
+        if(node_rank[FACE] < 0){continue;}
 
-                    counter = (j-DECAL) + (k-DECAL) * (electric_field_sizes[1]-2*DECAL);
+        bool is_end = FACE == 0 || FACE == 3 || FACE == 5;
 
-                    ASSERT( counter, < ,size_faces_electric[0]);
+        halo.copy_from_neighbour[FACE] = is_electric ? is_end : !is_end;
+        halo.copied_by_neighbour[FACE] = !halo.copy_from_neighbour[FACE];
 
-                    Electric_field_to_send[0][counter] = E_x[index];
+        MPI_Win_shared_query(progress_window,node_rank[FACE],&bytes,&disp_unit,&base);
+        halo.neighbour_progress[FACE] = static_cast<HaloProgress*>(base) + field_index;
 
-                }
+        for(unsigned int c = 0 ; c < 3 ; c ++){
+            MPI_Win_shared_query(grid.field_windows[first_window+c],node_rank[FACE],&bytes,&disp_unit,&base);
+            halo.neighbour_field[FACE][c] = static_cast<FIELD_TYPE*>(base);
+            for(unsigned int d = 0 ; d < 3 ; d ++){
+                halo.neighbour_size[FACE][c][d] = neighbour_sizes[FACE][3*c+d];
             }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                    index      = magnetic_field_sizes[0]-2 + magnetic_field_sizes[0] * ( j +
-                                        magnetic_field_sizes[1] * k );
-
-                    counter = (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[0]);
+        }
+    }
+}
 
-                    Magnetic_field_to_send[0][counter] = H_x[index];
+/**
+ * Starts the exchange of one field through the shared memory: the planes to send are ready (they must not
+ * be modified before wait_shared_memory_halo returns).
+ */
+template<typename FIELD_TYPE>
+void start_shared_memory_halo(SharedMemoryHalo<FIELD_TYPE> &halo){
+    halo.nbr_exchanges ++;
+    if(halo.progress != NULL){
+        halo.progress->ready.store(halo.nbr_exchanges,std::memory_order_release);
+    }
+}
 
-                }
+/**
+ * Copies the ghost planes of the face FACE from the fields of the neighbour: the two tangential components,
+ * without the ghost nodes of the edges (the same nodes as create_halo_face_datatype).
+ */
+template<typename FIELD_TYPE>
+void copy_halo_face_from_neighbour(unsigned int FACE, SharedMemoryHalo<FIELD_TYPE> &halo){
+    unsigned int direction = FACE / 2;
+    bool         is_end    = FACE == 0 || FACE == 3 || FACE == 5;
+
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        if(c == direction){continue;}
+        const size_t *size           = halo.size[c];
+        const size_t *neighbour_size = halo.neighbour_size[FACE][c];
+
+        /// Ghost plane of this process, and plane of the neighbour next to the face:
+        size_t ghost_plane     = is_end ? size[direction] - 1 : 0;
+        size_t neighbour_plane = is_end ? 1 : neighbour_size[direction] - 2;
+
+        size_t beg[3];
+        size_t end[3];
+        for(unsigned int d = 0 ; d < 3 ; d ++){
+            beg[d] = DECALAGE_E_SUPP;
+            end[d] = size[d] - DECALAGE_E_SUPP;
+        }
+        beg[direction] = 0;
+        end[direction] = 1;
+
+        /// Rows along I (a single node if the face is normal to x):
+        size_t row_length = end[0] - beg[0];
+        for(size_t K = beg[2] ; K < end[2] ; K ++){
+            for(size_t J = beg[1] ; J < end[1] ; J ++){
+                size_t mine[3]      = {beg[0],J,K};
+                size_t neighbour[3] = {beg[0],J,K};
+                mine     [direction] = ghost_plane;
+                neighbour[direction] = neighbour_plane;
+
+                memcpy(&halo.field[c][mine[0] + size[0] * (mine[1] + size[1] * mine[2])],
+                       &halo.neighbour_field[FACE][c][neighbour[0]
+                            + neighbour_size[0] * (neighbour[1] + neighbour_size[1] * neighbour[2])],
+                       row_length * sizeof(FIELD_TYPE));
             }
         }
-
-        if(is_electric_to_prepare){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[1]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                    index = electric_field_sizes[0+3]-2 + electric_field_sizes[0+3] * ( j + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_electric[0]);
-
-                    Electric_field_to_send[0][counter] = E_y[index];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[1]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                    index = magnetic_field_sizes[0+3]-2 + magnetic_field_sizes[0+3] * ( j + 
-                                magnetic_field_sizes[1+3] * k );
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[0]);
-
-                    Magnetic_field_to_send[0][counter] = H_y[index];
-
-                }
-            }
-        }
-
-        if(is_electric_to_prepare){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[1+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                    index = electric_field_sizes[0+2*3]-2 
-                                + electric_field_sizes[0+2*3] * ( j + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_electric[0]);
-
-                    Electric_field_to_send[0][counter] = E_z[index];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[1+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                    index = magnetic_field_sizes[0+2*3]-2 
-                                + magnetic_field_sizes[0+2*3] * ( j + magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_magnetic[0]);
-
-                    Magnetic_field_to_send[0][counter] = H_z[index];
-
-                }
-            }
-        }
-
-    }
-    //if(direction == 'N'){
-    /// The N direction corresponds to (-x) axis. Denoted by face number 1 (numbering starting from 0).
-    if(mpi_rank_neighboor[1] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_prepare){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                    index      = 1 + electric_field_sizes[0] * ( j + electric_field_sizes[1] * k );
-
-                    counter = (j-DECAL) + (k-DECAL) * (electric_field_sizes[1]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_electric[1]);
-                    
-                    Electric_field_to_send[1][counter] = E_x[index];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                    index      = 1 + magnetic_field_sizes[0] * ( j + magnetic_field_sizes[1] * k );
-
-                    counter = (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_magnetic[1]);
-                    
-                    Magnetic_field_to_send[1][counter] = H_x[index];
-
-                }
-            }
-        }
-
-        if(is_electric_to_prepare){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[1]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                    index = 1 + electric_field_sizes[0+3] * ( j + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_electric[1]);
-
-                    Electric_field_to_send[1][counter] = E_y[index];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[1]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                    index = 1 + magnetic_field_sizes[0+3] * ( j + magnetic_field_sizes[1+3] * k );
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[1]);
-
-                    Magnetic_field_to_send[1][counter] = H_y[index];
-
-                }
-            }
-        }
-
-        if(is_electric_to_prepare){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[1+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                    index = 1 + electric_field_sizes[0+2*3] * ( j + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_electric[1]);
-
-                    Electric_field_to_send[1][counter] = E_z[index];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[1+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                    index = 1 + magnetic_field_sizes[0+2*3] * ( j + magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[1]);
-
-                    Magnetic_field_to_send[1][counter] = H_z[index];
-
-                }
-            }
-        }
-
-    }
-    //if(direction == 'U'){
-    /// The N direction corresponds to (+z) axis. Denoted by face number 5 (numbering starting from 0).
-    if(mpi_rank_neighboor[5] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_prepare){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    index      = i + electric_field_sizes[0] * ( j 
-                            + electric_field_sizes[1] * (electric_field_sizes[2]-2) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_electric[5]);
-
-                    Electric_field_to_send[5][counter] = E_x[index];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    index      = i + magnetic_field_sizes[0] * ( j 
-                            + magnetic_field_sizes[1] * (magnetic_field_sizes[2]-2) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[5]);
-
-                    Magnetic_field_to_send[5][counter] = H_x[index];
-
-                }
-            }
-        }
-
-
-        if(is_electric_to_prepare){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+3] * ( j 
-                                + electric_field_sizes[1+3] * (electric_field_sizes[2+3]-2) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_electric[5]);
-
-                    Electric_field_to_send[5][counter] = E_y[index];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+3] * ( j 
-                                + magnetic_field_sizes[1+3] * (magnetic_field_sizes[2+3]-2) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[5]);
-
-                    Magnetic_field_to_send[5][counter] = H_y[index];
-
-                }
-            }
-        }
-
-        if(is_electric_to_prepare){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+2*3] * ( j 
-                                + electric_field_sizes[1+2*3] * (electric_field_sizes[2+2*3]-2) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_electric[5]);
-
-                    Electric_field_to_send[5][counter] = E_z[index];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+2*3] * ( j 
-                                + magnetic_field_sizes[1+2*3] * (magnetic_field_sizes[2+2*3]-2) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_magnetic[5]);
-
-                    Magnetic_field_to_send[5][counter] = H_z[index];
-
-                }
-            }
-        }
-    }
-    //if(direction == 'D'){
-    /// The D direction corresponds to (-z) axis. Denoted by face number 4 (numbering starting from 0).
-    if(mpi_rank_neighboor[4] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_prepare){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    index      = i + electric_field_sizes[0] * ( j + electric_field_sizes[1] * (1) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter ,< ,size_faces_electric[4]);
-
-                    Electric_field_to_send[4][counter] = E_x[index];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    index      = i + magnetic_field_sizes[0] * ( j + magnetic_field_sizes[1] * (1) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter ,< ,size_faces_magnetic[4]);
-
-                    Magnetic_field_to_send[4][counter] = H_x[index];
-
-                }
-            }
-        }
-
-        if(is_electric_to_prepare){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+3] * ( j + electric_field_sizes[1+3] * (1) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_electric[4]);
-
-                    Electric_field_to_send[4][counter] = E_y[index];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+3] * ( j + magnetic_field_sizes[1+3] * (1) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_magnetic[4]);
-
-                    Magnetic_field_to_send[4][counter] = H_y[index];
-
-                }
-            }
-        }
-
-        if(is_electric_to_prepare){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+2*3] * ( j + electric_field_sizes[1+2*3] * (1) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_electric[4]);
-
-                    Electric_field_to_send[4][counter] = E_z[index];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+2*3] * ( j + magnetic_field_sizes[1+2*3] * (1) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_magnetic[4]);
-
-                    Magnetic_field_to_send[4][counter] = H_z[index];
-
-                }
-            }
-        }
-    }
-}
-            
-void use_received_array(
-                double **Electric_field_to_recv,
-                double **Magnetic_field_to_recv,
-                std::vector<size_t> &electric_field_sizes,
-                std::vector<size_t> &magnetic_field_sizes,
-                double *E_x,
-                double *E_y,
-                double *E_z,
-                double *H_x,
-                double *H_y,
-                double *H_z,
-                int    *mpi_rank_neighboor,
-                #ifndef NDEBUG
-                    std::vector<size_t> &size_faces_electric,
-                    std::vector<size_t> &size_faces_magnetic,
-                #endif
-                bool is_electric_to_use
-            )
-{
-    /**
-     * This function uses the received electric fields to push it inside the electric field matrix.
-     */
-    /////////////////////////////////////////////////////////
-    /// CONVENTION FOR COMMUNICATION                      ///
-    /// 1) OMP thread(0) communicates with SOUTH. (face 0)///
-    /// 2) OMP thread(1) communicates with NORTH. (face 1)///
-    /// 3) OMP thread(2) communicates with WEST.  (face 2)///
-    /// 3) OMP thread(3) communicates with EAST.  (face 3)///
-    /// 4) OMP thread(4) communicates with DOWN.  (face 4)///
-    /// 5) OMP thread(5) communicates with UP.    (face 5)///
-    /////////////////////////////////////////////////////////
-    
-    size_t DECAL = DECALAGE_E_SUPP;
-
-    /// Depending on the direction:
-
-    //if(direction == 'W'){
-    /// The W direction corresponds to (-y) axis. Denoted by face number 2 (numbering starting from 0).
-    if(mpi_rank_neighboor[2] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        
-        if(is_electric_to_use){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    index      = i + electric_field_sizes[0] * ( 0 + electric_field_sizes[1] * k );
-                    
-                    counter = (i-DECAL) + (k-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_electric[2]);
-                    
-                    E_x[index] = Electric_field_to_recv[2][counter];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    index      = i + magnetic_field_sizes[0] * ( 0 + magnetic_field_sizes[1] * k );
-                    
-                    counter = (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_magnetic[2]);
-                    
-                    H_x[index] = Magnetic_field_to_recv[2][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+3] * ( 0 + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT(counter ,<, size_faces_electric[2]);
-
-                    E_y[index] = Electric_field_to_recv[2][counter];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+3] * ( 0 + magnetic_field_sizes[1+3] * k );
-
-                    counter = counter_prev_magn + (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT(counter ,<, size_faces_magnetic[2]);
-
-                    H_y[index] = Magnetic_field_to_recv[2][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+2*3] * ( 0 + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_electric[2]);
-
-                    E_z[index] = Electric_field_to_recv[2][counter];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+2*3] * ( 0 + magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_magnetic[2]);
-
-                    H_z[index] = Magnetic_field_to_recv[2][counter];
-
-                }
-            }
-        }
-    }
-
-    
-
-    //if(direction == 'E'){
-    /// The E direction corresponds to (+y) axis. Denoted by face number 3 (numbering starting from 0).
-    if(mpi_rank_neighboor[3] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_use){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index      = i + 
-                        electric_field_sizes[0] * ( electric_field_sizes[1]-1 + 
-                                electric_field_sizes[1] * k );
-
-                    counter = (i-DECAL) + (k-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT(counter ,<, size_faces_electric[3]);
-                    
-                    E_x[index] = Electric_field_to_recv[3][counter];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index      = i + 
-                        magnetic_field_sizes[0] * ( magnetic_field_sizes[1]-1 + 
-                                magnetic_field_sizes[1] * k );
-
-                    counter = (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT(counter ,<, size_faces_magnetic[3]);
-                    
-                    H_x[index] = Magnetic_field_to_recv[3][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = i + electric_field_sizes[0+3] 
-                            * ( electric_field_sizes[1+3]-1 + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_electric[3]);
-
-                    E_y[index] = Electric_field_to_recv[3][counter];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = i + magnetic_field_sizes[0+3] 
-                            * ( magnetic_field_sizes[1+3]-1 + magnetic_field_sizes[1+3] * k );
-
-                    counter = counter_prev_magn + (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_magnetic[3]);
-
-                    H_y[index] = Magnetic_field_to_recv[3][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = i + electric_field_sizes[0+2*3] 
-                            * ( electric_field_sizes[1+2*3]-1 + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (i-DECAL) + (k-DECAL) * (electric_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_electric[3]);
-
-                    E_z[index] = Electric_field_to_recv[3][counter];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = i + magnetic_field_sizes[0+2*3] 
-                            * ( magnetic_field_sizes[1+2*3]-1 + magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (i-DECAL) + (k-DECAL) * (magnetic_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_magnetic[3]);
-
-                    H_z[index] = Magnetic_field_to_recv[3][counter];
-
-                }
-            }
-        }
-    }
-    /**
-     * I receive information with tag 'S'.
-     */
-    //if(direction == 'S'){
-    /// The S direction corresponds to (+x) axis. Denoted by face number 0 (numbering starting from 0).
-    if(mpi_rank_neighboor[0] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_use){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index      = electric_field_sizes[0]-1 
-                            + electric_field_sizes[0] * ( j + electric_field_sizes[1] * k );
-
-                    counter = (j-DECAL) + (k-DECAL) * (electric_field_sizes[1]-2*DECAL);
-
-                    ASSERT(counter, <, size_faces_electric[0]);
-                    
-                    E_x[index] = Electric_field_to_recv[0][counter];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index      = magnetic_field_sizes[0]-1 
-                            + magnetic_field_sizes[0] * ( j + magnetic_field_sizes[1] * k );
-
-                    counter = (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-
-                    ASSERT(counter, <, size_faces_magnetic[0]);
-                    
-                    H_x[index] = Magnetic_field_to_recv[0][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[1]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = electric_field_sizes[0+3]-1 
-                            + electric_field_sizes[0+3] * ( j + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT(counter ,< ,size_faces_electric[0]);
-
-                    E_y[index] = Electric_field_to_recv[0][counter];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[1]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = magnetic_field_sizes[0+3]-1 
-                            + magnetic_field_sizes[0+3] * ( j + magnetic_field_sizes[1+3] * k );
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT(counter ,< ,size_faces_magnetic[0]);
-
-                    H_y[index] = Magnetic_field_to_recv[0][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[1+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = electric_field_sizes[0+2*3]-1 
-                            + electric_field_sizes[0+2*3] * ( j + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT(counter ,<, size_faces_electric[0]);
-
-                    E_z[index] = Electric_field_to_recv[0][counter];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[1+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = magnetic_field_sizes[0+2*3]-1 
-                            + magnetic_field_sizes[0+2*3] * ( j + magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT(counter ,<, size_faces_magnetic[0]);
-
-                    H_z[index] = Magnetic_field_to_recv[0][counter];
-
-                }
-            }
-        }
-    }
-    //if(direction == 'N'){
-    /// The N direction corresponds to (-x) axis. Denoted by face number 1 (numbering starting from 0).
-    if(mpi_rank_neighboor[1] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_use){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index      = 0 + electric_field_sizes[0] * ( j + electric_field_sizes[1] * k );
-
-                    counter = (j-DECAL) + (k-DECAL) * (electric_field_sizes[1]-2*DECAL);
-
-                    ASSERT(counter, <, size_faces_electric[1]);
-                    
-                    E_x[index] = Electric_field_to_recv[1][counter];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index      = 0 + magnetic_field_sizes[0] * ( j + magnetic_field_sizes[1] * k );
-
-                    counter = (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-
-                    ASSERT(counter, <, size_faces_magnetic[1]);
-                    
-                    H_x[index] = Magnetic_field_to_recv[1][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[1]-2*DECAL) * (electric_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = 0 + electric_field_sizes[0+3] * ( j + electric_field_sizes[1+3] * k );
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_electric[1]);
-
-                    E_y[index] = Electric_field_to_recv[1][counter];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[1]-2*DECAL) * (magnetic_field_sizes[2]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = 0 + magnetic_field_sizes[0+3] * ( j + magnetic_field_sizes[1+3] * k );
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-
-                    ASSERT(counter, < ,size_faces_magnetic[1]);
-
-                    H_y[index] = Magnetic_field_to_recv[1][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[1+3]-2*DECAL) * (electric_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < electric_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = 0 
-                            + electric_field_sizes[0+2*3] * ( j + electric_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_elec + (j-DECAL) + (k-DECAL) * (electric_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT(counter ,< ,size_faces_electric[1]);
-
-                    E_z[index] = Electric_field_to_recv[1][counter];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[1+3]-2*DECAL) * (magnetic_field_sizes[2+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t k = DECAL ; k < magnetic_field_sizes[2+2*3]-DECAL ; k++){
-                for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                    /**
-                     * Attention, il faut absolument faire omp_sizes[1+3]-1 !!!!!
-                     * En fait, si on avait itéré sur les j, on aurait fait:
-                     *      for(j = 1 ; j < omp_sizes[1+3] ; j ++)
-                     *  donc j va de 1 à OMP_SIZES[1+3]-1 !!!
-                     */
-                    index = 0 
-                            + magnetic_field_sizes[0+2*3] * ( j + magnetic_field_sizes[1+2*3] * k);
-
-                    counter = counter_prev_magn + (j-DECAL) + (k-DECAL) * (magnetic_field_sizes[1+6]-2*DECAL);
-
-                    ASSERT(counter ,< ,size_faces_magnetic[1]);
-
-                    H_z[index] = Magnetic_field_to_recv[1][counter];
-
-                }
-            }
-        }
-    }
-    //if(direction == 'U'){
-    /// The N direction corresponds to (+z) axis. Denoted by face number 5 (numbering starting from 0).
-    if(mpi_rank_neighboor[5] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_use){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    index      = i + electric_field_sizes[0] 
-                            * ( j + electric_field_sizes[1] * (electric_field_sizes[2]-1) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_electric[5]);
-
-                    E_x[index] = Electric_field_to_recv[5][counter];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    index      = i + magnetic_field_sizes[0] 
-                            * ( j + magnetic_field_sizes[1] * (magnetic_field_sizes[2]-1) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[5]);
-
-                    H_x[index] = Magnetic_field_to_recv[5][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+3] 
-                        * ( j + electric_field_sizes[1+3] * (electric_field_sizes[2+3]-1) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_electric[5]);
-
-                    E_y[index] = Electric_field_to_recv[5][counter];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+3] 
-                        * ( j + magnetic_field_sizes[1+3] * (magnetic_field_sizes[2+3]-1) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter, < ,size_faces_magnetic[5]);
-
-                    H_y[index] = Magnetic_field_to_recv[5][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + 
-                        electric_field_sizes[0+2*3] * ( j + 
-                            electric_field_sizes[1+2*3] * (electric_field_sizes[2+2*3]-1) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_electric[5]);
-
-                    E_z[index] = Electric_field_to_recv[5][counter];
-
-                }
-            }
-        }else{
-            /// Put E_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + 
-                        magnetic_field_sizes[0+2*3] * ( j + 
-                            magnetic_field_sizes[1+2*3] * (magnetic_field_sizes[2+2*3]-1) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_magnetic[5]);
-
-                    H_z[index] = Magnetic_field_to_recv[5][counter];
-
-                }
-            }
-        }
-    }
-    //if(direction == 'D'){
-    /// The D direction corresponds to (-z) axis. Denoted by face number 4 (numbering starting from 0).
-    if(mpi_rank_neighboor[4] != -1){
-        size_t index   = 0;
-        size_t counter = 0;
-        size_t counter_prev_elec = 0;
-        size_t counter_prev_magn = 0;
-
-        if(is_electric_to_use){
-            /// Put E_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0]-DECAL ; i++){
-                    index      = i + electric_field_sizes[0] * ( j + electric_field_sizes[1] * (0) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (electric_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter ,< ,size_faces_electric[4]);
-
-                    E_x[index] = Electric_field_to_recv[4][counter];
-
-                }
-            }
-        }else{
-            /// Put H_x:
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0]-DECAL ; i++){
-                    index      = i + magnetic_field_sizes[0] * ( j + magnetic_field_sizes[1] * (0) );
-                    
-                    counter = (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0]-2*DECAL);
-
-                    ASSERT( counter ,< ,size_faces_electric[4]);
-
-                    H_x[index] = Magnetic_field_to_recv[4][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_y:
-            counter_prev_elec = (electric_field_sizes[0]-2*DECAL) * (electric_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+3] * ( j + electric_field_sizes[1+3] * (0) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_electric[4]);
-
-                    E_y[index] = Electric_field_to_recv[4][counter];
-
-                }
-            }
-        }else{
-            /// Put H_y:
-            counter_prev_magn = (magnetic_field_sizes[0]-2*DECAL) * (magnetic_field_sizes[1]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+3] * ( j + magnetic_field_sizes[1+3] * (0) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+3]-2*DECAL);
-
-                    ASSERT( counter ,<, size_faces_magnetic[4]);
-
-                    H_y[index] = Magnetic_field_to_recv[4][counter];
-
-                }
-            }
-        }
-
-        if(is_electric_to_use){
-            /// Put E_z:
-            counter_prev_elec += (electric_field_sizes[0+3]-2*DECAL) * (electric_field_sizes[1+3]-2*DECAL);
-            #pragma omp for 
-            for(size_t j = DECAL ; j < electric_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < electric_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + electric_field_sizes[0+2*3] * ( j + electric_field_sizes[1+2*3] * (0) );
-
-                    counter = counter_prev_elec + (i-DECAL) + (j-DECAL) * (electric_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_electric[4]);
-
-                    E_z[index] = Electric_field_to_recv[4][counter];
-
-                }
-            }
-        }else{
-            /// Put H_z:
-            counter_prev_magn += (magnetic_field_sizes[0+3]-2*DECAL) * (magnetic_field_sizes[1+3]-2*DECAL);
-            #pragma omp for
-            for(size_t j = DECAL ; j < magnetic_field_sizes[1+2*3]-DECAL ; j++){
-                for(size_t i = DECAL ; i < magnetic_field_sizes[0+2*3]-DECAL ; i++){
-                    index = i + magnetic_field_sizes[0+2*3] * ( j + magnetic_field_sizes[1+2*3] * (0) );
-
-                    counter = counter_prev_magn + (i-DECAL) + (j-DECAL) * (magnetic_field_sizes[0+6]-2*DECAL);
-
-                    ASSERT( counter, <, size_faces_magnetic[4]);
-
-                    H_z[index] = Magnetic_field_to_recv[4][counter];
-
-                }
-            }
-        }
-    }
-}
+    }
+}
 
 /**
- * Communicates both electric and magnetic fields:
+ * Waits for the exchange started by start_shared_memory_halo: copies the ghost planes from the neighbours
+ * once their planes are ready, then waits for the neighbours to have copied the planes of this process.
  */
-void communicate_single_omp_thread(
-                double **Electric_field_to_send,
-                double **Electric_field_to_recv,
-                double **Magnetic_field_to_send,
-                double **Magnetic_field_to_recv,
-                int *mpi_to_who,
-                int  mpi_me,
-                std::vector<size_t> size_faces_electric,
-                std::vector<size_t> size_faces_magnetic,
-                bool is_electric_to_communicate
-            )
-{
-    /// Only the master OPENMP thread can access this fuction !
-    if(omp_get_thread_num() != 0){
-        fprintf(stderr,"In %s :: only the master OMP thread can accessthis function ! Aborting.\n",
-            __FUNCTION__);
-        fprintf(stderr,"In %s:%d\n",__FILE__,__LINE__);
-        #ifdef MPI_COMM_WORLD
-        MPI_Abort(MPI_COMM_WORLD,-1);
-        #else
-        abort();
-        #endif
+template<typename FIELD_TYPE>
+void wait_shared_memory_halo(SharedMemoryHalo<FIELD_TYPE> &halo){
+    if(halo.progress == NULL){
+        return;
     }
-
-    #ifndef NDEBUG
-        fflush(stdout);
-        MPI_Barrier(MPI_COMM_WORLD);
-        printf("[MPI %d] - NEIGHBOORS [%d,%d,%d,%d,%d,%d]\n",
-            mpi_me,
-            mpi_to_who[0],mpi_to_who[1],mpi_to_who[2],mpi_to_who[3],
-            mpi_to_who[4],mpi_to_who[5]);
-        fflush(stdout);
-        MPI_Barrier(MPI_COMM_WORLD);
-    #endif
-
-    /// LOOP OVER THE 6 FACES
     for(unsigned int FACE = 0 ; FACE < NBR_FACES_CUBE ; FACE ++){
+        if(!halo.copy_from_neighbour[FACE]){continue;}
+        wait_for_slab_step(halo.neighbour_progress[FACE]->ready,halo.nbr_exchanges);
+        copy_halo_face_from_neighbour(FACE,halo);
+    }
+    halo.progress->copied.store(halo.nbr_exchanges,std::memory_order_release);
 
-        // If it is -1, then no need to communicate ! Just continue.
-        if(mpi_to_who[FACE] == -1){continue;}
-
-        /// Define a tag for communication:
-        int neighboorComm = -1;
-
-        if( FACE == 0 ){ neighboorComm = 1; }
-        if( FACE == 1 ){ neighboorComm = 0; }
-        if( FACE == 2 ){ neighboorComm = 3; }
-        if( FACE == 3 ){ neighboorComm = 2; }
-        if( FACE == 4 ){ neighboorComm = 5; }
-        if( FACE == 5 ){ neighboorComm = 4; }
-
-        /// The order of send/recv operations depends on the MPI rank of current and neighboor MPI processes.
-
-        /* NEIGHBOOR IS EVEN, I AM ODD */
-        if(mpi_me%2 != 0 && mpi_to_who[FACE]%2 == 0){
-            #ifndef NDEBUG
-                printf("[MPI %d - EVEN - FACE %d -OMP %d] send to   [MPI %d] | sendTag %d , recvTag %d\n",
-                        mpi_me,
-                        FACE,
-                        omp_get_thread_num(),
-                        mpi_to_who[FACE],
-                        FACE,
-                        neighboorComm);
-            #endif
-            if(is_electric_to_communicate){
-                MPI_Send(
-                        Electric_field_to_send[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            }else{
-                MPI_Send(
-                        Magnetic_field_to_send[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            }
-            #ifndef NDEBUG
-                printf("[MPI %d - EVEN - FACE %d -OMP %d] recv from [MPI %d] | sendTag %d , recvTag %d\n",
-                        mpi_me,
-                        FACE,
-                        omp_get_thread_num(),
-                        mpi_to_who[FACE],
-                        FACE,
-                        neighboorComm);
-            #endif
-            if(is_electric_to_communicate){
-                MPI_Recv(
-                        Electric_field_to_recv[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }else{
-                MPI_Recv(
-                        Magnetic_field_to_recv[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }
-            #ifndef NDEBUG
-                printf("[MPI %d - ODD ] to [MPI %d] :: Done\n",
-                        mpi_me,
-                        mpi_to_who[FACE]);
-            #endif
-                
-        /* NEIGHBOOR IS ODD, I AM EVEN */
-        }else if(mpi_me%2 == 0 && mpi_to_who[FACE]%2 != 0){
-            #ifndef NDEBUG
-                printf("[MPI %d - ODD - FACE %d - OMP %d] recv from [MPI %d] | sendTag %d , recvTag %d\n",
-                        mpi_me,
-                        FACE,
-                        omp_get_thread_num(),
-                        mpi_to_who[FACE],
-                        FACE,
-                        neighboorComm);
-            #endif
-            if(is_electric_to_communicate){
-                MPI_Recv(
-                        Electric_field_to_recv[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }else{
-                MPI_Recv(
-                        Magnetic_field_to_recv[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }
-            #ifndef NDEBUG
-                printf("[MPI %d - ODD - FACE %d - OMP %d] send to   [MPI %d] | sendTag %d , recvTag %d\n",
-                        mpi_me,
-                        FACE,
-                        omp_get_thread_num(),
-                        mpi_to_who[FACE],
-                        FACE,
-                        neighboorComm);
-            #endif
-            if(is_electric_to_communicate){
-                MPI_Send(
-                        Electric_field_to_send[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            }else{
-                MPI_Send(
-                        Magnetic_field_to_send[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            }
-            #ifndef NDEBUG
-                printf("[MPI %d - EVEN] to [MPI %d] :: DONE\n",
-                        mpi_me,
-                        mpi_to_who[FACE]);
-            #endif
-                
-        /* NEIGHBOOR LARGER THAN ME */
-        }else if( mpi_to_who[FACE] > mpi_me ){
-            #ifndef NDEBUG
-                printf("[MPI %d - LARGER - FACE %d -OMP %d] to [MPI %d] | sendTag %d , recvTag %d\n",
-                        mpi_me,
-                        FACE,
-                        omp_get_thread_num(),
-                        mpi_to_who[FACE],
-                        FACE,
-                        neighboorComm);
-            #endif
-            if(is_electric_to_communicate){
-                MPI_Recv(
-                        Electric_field_to_recv[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }else{
-                MPI_Recv(
-                        Magnetic_field_to_recv[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }
-            if(is_electric_to_communicate){   
-                MPI_Send(
-                        Electric_field_to_send[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            }else{
-                MPI_Send(
-                        Magnetic_field_to_send[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            } 
-            #ifndef NDEBUG
-                printf("[MPI %d - LARGER] to [MPI %d] :: DONE\n",
-                        mpi_me,
-                        mpi_to_who[FACE]);
-            #endif
-                
-        }else if( mpi_to_who[FACE] < mpi_me ){
-            #ifndef NDEBUG
-                printf("[MPI %d - SMALLER - FACE %d - OMP %d] to [MPI %d] | sendTag %d , recvTag %d\n",
-                        mpi_me,
-                        FACE,
-                        omp_get_thread_num(),
-                        mpi_to_who[FACE],
-                        FACE,
-                        neighboorComm);
-            #endif
-            if(is_electric_to_communicate){
-                MPI_Send(
-                        Electric_field_to_send[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            }else{
-                MPI_Send(
-                        Magnetic_field_to_send[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        FACE,
-                        MPI_COMM_WORLD
-                );
-            }
-            if(is_electric_to_communicate){  
-                MPI_Recv(
-                        Electric_field_to_recv[FACE],
-                        size_faces_electric[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }else{
-                MPI_Recv(
-                        Magnetic_field_to_recv[FACE],
-                        size_faces_magnetic[FACE],
-                        MPI_DOUBLE,
-                        mpi_to_who[FACE],
-                        neighboorComm,
-                        MPI_COMM_WORLD,
-                        MPI_STATUS_IGNORE
-                );
-            }  
-            #ifndef NDEBUG
-                printf("[MPI %d - SMALLER] to [MPI %d] :: DONE\n",
-                        mpi_me,
-                        mpi_to_who[FACE]);
-            #endif
-                
-        }else{
-                fprintf(stderr,"In function %s :: no way to communicate between MPI %d and"
-                                " MPI %d, on face %d. Aborting.\n",
-                                __FUNCTION__,mpi_me,mpi_to_who[FACE],FACE);
-                fprintf(stderr,"In %s:%d\n",__FILE__,__LINE__);
-                #ifdef MPI_COMM_WORLD
-                    MPI_Abort(MPI_COMM_WORLD,-1);
-                #else
-                    abort();
-                #endif
-        }
+    for(unsigned int FACE = 0 ; FACE < NBR_FACES_CUBE ; FACE ++){
+        if(!halo.copied_by_neighbour[FACE]){continue;}
+        wait_for_slab_step(halo.neighbour_progress[FACE]->copied,halo.nbr_exchanges);
     }
-    
 }
 
 /**
@@ -3921,7 +3374,7 @@ void probe_a_field(
                         );
                     }
 
-                    double value = grid.get_fields(which_field)[index];
+                    double value = grid.get_field_value(which_field,index);
 
                     fprintf(file,"(%.10g,%.10g,%.10g,%.10g) %s = %.10g [gl_node(%zu,%zu,%zu)| dt %.10g]\n",
                                 current_time,
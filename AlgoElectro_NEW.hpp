@@ -5,15 +5,243 @@
 
 #include "InterfaceToParaviewer.h"
 
+#include "YeeKernels.hpp"
+
+#include <atomic>
+
+/**
+ * @brief Progress of the slab of one thread when the threads synchronise with their neighbours
+ *        (see AlgoElectro_NEW::update_slab_pipeline): last step whose H (resp. E) update is done.
+ *
+ * Padded to two cache lines, so that the counters of two slabs never share a cache line.
+ */
+struct SlabProgress{
+    std::atomic<size_t> H_done;
+    std::atomic<size_t> E_done;
+    char padding[128 - 2 * sizeof(std::atomic<size_t>)];
+
+    SlabProgress(void) : H_done(0), E_done(0) {}
+};
+
+/**
+ * @brief Progress of the exchanges of one field (electric or magnetic) of an MPI process through the shared
+ *        memory of the node (see SharedMemoryHalo): last exchange whose planes to send are ready, and last
+ *        exchange whose ghost planes have been copied from the neighbours.
+ *
+ * Stored in a window of shared memory, the (lock-free) atomic counters are read by the other processes of the node.
+ */
+struct HaloProgress{
+    std::atomic<size_t> ready;
+    std::atomic<size_t> copied;
+    char padding[128 - 2 * sizeof(std::atomic<size_t>)];
+
+    HaloProgress(void) : ready(0), copied(0) {}
+};
+
+/**
+ * @brief Exchange of the halos of one field (electric or magnetic) with the MPI neighbours of the same node,
+ *        whose fields are in shared memory (see GridCreator_NEW::fields_in_shared_memory).
+ *
+ * The ghost planes of a face are copied straight from the fields of the neighbour, once its progress says
+ * they are ready. The neighbours on other nodes still get messages (see init_halo_exchange).
+ */
+template<typename FIELD_TYPE>
+struct SharedMemoryHalo{
+    /// Number of exchanges started so far:
+    size_t        nbr_exchanges = 0;
+    /// Progress of this process, and of the neighbour of each face (NULL if not on this node):
+    HaloProgress *progress = NULL;
+    HaloProgress *neighbour_progress[6] = {NULL,NULL,NULL,NULL,NULL,NULL};
+    /// The ghost planes of the face are copied from the neighbour, or the neighbour copies the planes of the face:
+    bool          copy_from_neighbour[6] = {false,false,false,false,false,false};
+    bool          copied_by_neighbour[6] = {false,false,false,false,false,false};
+    /// Components x, y, z of the field of this process, and of the neighbour of each face, with their sizes:
+    FIELD_TYPE   *field[3] = {NULL,NULL,NULL};
+    size_t        size[3][3];
+    FIELD_TYPE   *neighbour_field[6][3];
+    size_t        neighbour_size[6][3][3];
+};
+
+/**
+ * @brief Persistent requests of the exchange of the halos of one field with the MPI neighbours (see init_halo_exchange),
+ *        stored face by face: the requests of the face FACE go from face_begin[FACE] to face_begin[FACE+1] (excluded).
+ *
+ * With per_face_threads, the faces with requests are shared between the OpenMP threads (see halo_face_thread),
+ * which start and wait for the messages of their faces concurrently (MPI_THREAD_MULTIPLE).
+ * Otherwise, the master thread starts and waits for all the requests.
+ */
+struct HaloExchange{
+    MPI_Request requests[2*6];
+    int         face_begin[6+1] = {0,0,0,0,0,0,0};
+    bool        per_face_threads = false;
+};
+
+/**
+ * @brief Array exchanged with the ghost layers (see GridCreator_NEW::ghost_layers): a field, or the old
+ *        tangential field of a face of the ABC (with one node along the normal of the face).
+ *        'nbr_layers' layers are exchanged on each face, at the ends of the array.
+ */
+template<typename FIELD_TYPE>
+struct GhostLayersArray{
+    FIELD_TYPE *nodes;
+    /// Number of nodes along x, y and z (x first in memory):
+    size_t      size[3];
+    size_t      nbr_layers;
+};
+
 class AlgoElectro_NEW{
     private:
         /* MEMBERS */
-        
+
         /* FUNCTIONS */
 
         // Compute the time step required to fulfill the theoretical stability condition:
         double Compute_dt(GridCreator_NEW & /*grid*/);
 
+        // Compute the update coefficients of one component for each material.
+        // Returns false if two nodes of the same material have different properties.
+        template<typename COEF_TYPE>
+        bool compute_coefficients_per_material(
+            const unsigned char *material,
+            const double *eps_or_mu,
+            const double *conductivity,
+            size_t        size,
+            unsigned int  nbr_materials,
+            double        dt,
+            double        delta_1,
+            double        delta_2,
+            COEF_TYPE    *C_self,
+            COEF_TYPE    *C_curl_1,
+            COEF_TYPE    *C_curl_2
+        );
+
+        // Electromagnetic algorithm, with fields stored as FIELD_TYPE and coefficients as COEF_TYPE:
+        template<typename FIELD_TYPE, typename COEF_TYPE>
+        void update_fields(GridCreator_NEW &,InterfaceToParaviewer &);
+
+        // Advance the fields from the step *step to the step last_step (excluded), with the current
+        // planes of this process (see MPI_Initializer::MPI_REBALANCING_ALONG_Z):
+        template<typename FIELD_TYPE, typename COEF_TYPE>
+        void update_fields_until_step(
+            GridCreator_NEW &grid,
+            InterfaceToParaviewer &interfaceParaview,
+            double dt,
+            YeeSimdISA SIMD_ISA,
+            FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+            FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+            FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+            FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+            FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+            FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+            SlabProgress *slab_progress,
+            bool refresh_electric_halos,
+            size_t last_step,
+            size_t *step,
+            double *simulation_time,
+            double *time_in_while
+        );
+
+        // Advance the fields by several time steps, with a wavefront along the K direction:
+        template<typename FIELD_TYPE, typename COEF_TYPE>
+        void update_temporal_block(
+            GridCreator_NEW &grid,
+            const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_H[3],
+            const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_E[3],
+            const YeeRange range_H[3],
+            const YeeRange range_E[3],
+            const size_t *tile_size,
+            bool USE_TILES,
+            bool COEFFICIENTS_PER_MATERIAL,
+            std::vector<size_t> *local_nodes_inside_source_NUMBER,
+            std::vector<unsigned char> *ID_Source,
+            std::vector<double> &local_nodes_inside_source_FREQ,
+            std::vector<std::vector<size_t> > *sources_in_plane,
+            bool MODULATE_SOURCE,
+            FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+            FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+            FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+            FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+            FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+            FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+            double dt,
+            const std::vector<double> &times,
+            size_t K_beg,
+            size_t K_end
+        );
+
+        // Advance the fields by several time steps, each thread updating its own slab of planes
+        // and waiting only for the slabs next to it:
+        template<typename FIELD_TYPE, typename COEF_TYPE>
+        void update_slab_pipeline(
+            GridCreator_NEW &grid,
+            const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_H[3],
+            const YeeComponent<FIELD_TYPE,COEF_TYPE> Yee_E[3],
+            const YeeRange range_H[3],
+            const YeeRange range_E[3],
+            const size_t *tile_size,
+            bool COEFFICIENTS_PER_MATERIAL,
+            std::vector<size_t> *local_nodes_inside_source_NUMBER,
+            std::vector<unsigned char> *ID_Source,
+            std::vector<double> &local_nodes_inside_source_FREQ,
+            std::vector<std::vector<size_t> > *sources_in_plane,
+            bool MODULATE_SOURCE,
+            FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+            FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+            FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+            FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+            FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+            FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+            double dt,
+            const std::vector<double> &times,
+            size_t first_step,
+            SlabProgress *progress,
+            size_t slab,
+            size_t nbr_slabs,
+            size_t K_beg_slab,
+            size_t K_end_slab
+        );
+
+        /* Update the points with boundary conditions, only on the planes K_beg <= k < K_end */
+        template<typename FIELD_TYPE>
+        void abc_on_planes( GridCreator_NEW &grid,
+                FIELD_TYPE *Ex, FIELD_TYPE *Ey, FIELD_TYPE *Ez,
+                FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+                FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+                FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+                FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+                FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+                FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+                double dt,
+                size_t K_beg,
+                size_t K_end
+        );
+
+        /* Boundary conditions of the faces x0, x1, y0 and y1, only on the planes K_beg <= k < K_end */
+        template<typename FIELD_TYPE>
+        void abc_xy_faces_on_planes( GridCreator_NEW &grid,
+                FIELD_TYPE *Ex, FIELD_TYPE *Ey, FIELD_TYPE *Ez,
+                FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0,
+                FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1,
+                FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0,
+                FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1,
+                double dt,
+                size_t K_beg,
+                size_t K_end
+        );
+
+        /* Boundary conditions of the faces z0 and z1, only on the rows J_beg <= j < J_end */
+        template<typename FIELD_TYPE>
+        void abc_z_faces_on_rows( GridCreator_NEW &grid,
+                FIELD_TYPE *Ex, FIELD_TYPE *Ey,
+                FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0,
+                FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
+                double dt,
+                bool apply_z0,
+                bool apply_z1,
+                size_t J_beg,
+                size_t J_end
+        );
+
     public:
 
         /* CONSTRUCTOR */
@@ -30,15 +258,16 @@ class AlgoElectro_NEW{
         void check_OMP_DYNAMIC_envVar(void);
 
 
-        /* Update the points with boundary conditions  */
+        /* Update the points with boundary conditions (called by all the threads of the team) */
+        template<typename FIELD_TYPE>
         void abc( GridCreator_NEW &grid, 
-                double *Ex, double *Ey, double *Ez,
-                double *Eyx0, double *Ezx0, 
-                double *Eyx1, double *Ezx1, 
-                double *Exy0, double *Ezy0, 
-                double *Exy1, double *Ezy1, 
-                double *Exz0, double *Eyz0, 
-                double *Exz1, double *Eyz1,
+                FIELD_TYPE *Ex, FIELD_TYPE *Ey, FIELD_TYPE *Ez,
+                FIELD_TYPE *Eyx0, FIELD_TYPE *Ezx0, 
+                FIELD_TYPE *Eyx1, FIELD_TYPE *Ezx1, 
+                FIELD_TYPE *Exy0, FIELD_TYPE *Ezy0, 
+                FIELD_TYPE *Exy1, FIELD_TYPE *Ezy1, 
+                FIELD_TYPE *Exz0, FIELD_TYPE *Eyz0, 
+                FIELD_TYPE *Exz1, FIELD_TYPE *Eyz1,
                 double dt
         );
         
@@ -0,0 +1,168 @@
+/* This file provides the allocation of aligned arrays (used by the vectorized kernels) */
+#ifndef ALIGNEDMEMORY_HPP
+#define ALIGNEDMEMORY_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include "header_with_all_defines.hpp"
+
+#if defined(__linux__)
+    /// The NUMA node of a page or of a CPU is asked to the kernel (move_pages, getcpu):
+    #include <unistd.h>
+    #include <sys/syscall.h>
+#endif
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+/// Alignment of the arrays, in bytes (one cache line, one AVX-512 register):
+#define MEMORY_ALIGNMENT 64
+
+/**
+ * @brief Allocate an array of 'size' elements, aligned on MEMORY_ALIGNMENT bytes and set to zero.
+ *
+ * The allocated memory is rounded up to a multiple of MEMORY_ALIGNMENT bytes, so that the last
+ * elements of the array never share a cache line with another array.
+ * Must be freed with delete_aligned_array.
+ */
+template<typename T>
+T *new_aligned_array(size_t size){
+    size_t bytes = size * sizeof(T);
+    bytes = ((bytes + MEMORY_ALIGNMENT - 1) / MEMORY_ALIGNMENT) * MEMORY_ALIGNMENT;
+    if(bytes == 0){
+        bytes = MEMORY_ALIGNMENT;
+    }
+    void *ptr = NULL;
+    if(posix_memalign(&ptr,MEMORY_ALIGNMENT,bytes) != 0 || ptr == NULL){
+        DISPLAY_ERROR_ABORT(
+            "Cannot allocate %zu bytes aligned on %d bytes.",
+            bytes,MEMORY_ALIGNMENT
+        );
+    }
+    memset(ptr,0,bytes);
+    return static_cast<T*>(ptr);
+}
+
+/**
+ * @brief Set to zero an array of size[0] x size[1] x size[2] elements (index I + size[0] * (J + size[1] * K))
+ *        with all the OpenMP threads, each thread setting the rows (J,K) it would get with
+ *        'omp for schedule(static) collapse(2)' over K and J (first touch, see new_aligned_array_first_touch).
+ * Must be called outside of any OpenMP parallel region (it opens its own).
+ */
+template<typename T>
+void first_touch_zero(T *array, const size_t *size){
+    const size_t size_x = size[0];
+    const size_t size_y = size[1];
+    const size_t size_z = size[2];
+
+    #pragma omp parallel for default(none) shared(array) firstprivate(size_x,size_y,size_z)\
+        schedule(static) collapse(2)
+    for(size_t K = 0 ; K < size_z ; K ++){
+        for(size_t J = 0 ; J < size_y ; J ++){
+            memset(array + size_x * ( J + size_y * K),0,size_x * sizeof(T));
+        }
+    }
+}
+
+/**
+ * @brief Same as new_aligned_array, for an array of size[0] x size[1] x size[2] elements
+ *        (e.g. a field, index I + size[0] * (J + size[1] * K)), set to zero by all the OpenMP threads.
+ *
+ * The memory is not touched when allocated: first_touch(array) sets it to zero with the OpenMP threads,
+ * each thread setting the elements it works on later. With the first-touch policy of Linux, the pages of
+ * each thread's elements are then placed on the NUMA node of the thread, instead of all the pages being
+ * on the node of the master thread. The arrays of the nodes of the Yee components use the tiles of the
+ * Yee kernels (first_touch_zero_yee, see new_yee_array_first_touch).
+ * first_touch is called outside of any OpenMP parallel region (it opens its own).
+ * Must be freed with delete_aligned_array.
+ */
+template<typename T, typename FIRST_TOUCH>
+T *new_aligned_array_first_touch(const size_t *size, FIRST_TOUCH first_touch){
+    size_t nbr_elements = size[0] * size[1] * size[2];
+    size_t bytes = nbr_elements * sizeof(T);
+    bytes = ((bytes + MEMORY_ALIGNMENT - 1) / MEMORY_ALIGNMENT) * MEMORY_ALIGNMENT;
+    if(bytes == 0){
+        bytes = MEMORY_ALIGNMENT;
+    }
+    void *ptr = NULL;
+    if(posix_memalign(&ptr,MEMORY_ALIGNMENT,bytes) != 0 || ptr == NULL){
+        DISPLAY_ERROR_ABORT(
+            "Cannot allocate %zu bytes aligned on %d bytes.",
+            bytes,MEMORY_ALIGNMENT
+        );
+    }
+    T *array = static_cast<T*>(ptr);
+
+    first_touch(array);
+
+    /// Padding after the last element:
+    memset(reinterpret_cast<char*>(ptr) + nbr_elements * sizeof(T),0,bytes - nbr_elements * sizeof(T));
+
+    return array;
+}
+
+/**
+ * @brief Same as above, the rows (J,K) being shared between the threads as in first_touch_zero.
+ */
+template<typename T>
+T *new_aligned_array_first_touch(const size_t *size){
+    return new_aligned_array_first_touch<T>(size,[size](T *array){
+        first_touch_zero(array,size);
+    });
+}
+
+/**
+ * @brief First iteration given to the thread 'thread' by 'omp for schedule(static)' over 'nbr_iterations'
+ *        iterations shared by 'nbr_threads' threads (the first nbr_iterations % nbr_threads threads get one more).
+ */
+inline size_t omp_static_chunk_begin(size_t nbr_iterations, size_t thread, size_t nbr_threads){
+    size_t chunk     = nbr_iterations / nbr_threads;
+    size_t remainder = nbr_iterations % nbr_threads;
+    return thread * chunk + (thread < remainder ? thread : remainder);
+}
+
+/**
+ * @brief NUMA node of the page containing 'address', or -1 if unknown (page not touched, not Linux).
+ */
+inline int numa_node_of_address(const void *address){
+    #if defined(__linux__) && defined(SYS_move_pages)
+        void *page   = const_cast<void*>(address);
+        int   status = -1;
+        /// With no target nodes, move_pages only gives the node of each page in 'status':
+        if(syscall(SYS_move_pages,0,1UL,&page,NULL,&status,0) == 0 && status >= 0){
+            return status;
+        }
+    #else
+        (void)address;
+    #endif
+    return -1;
+}
+
+/**
+ * @brief NUMA node of the CPU running the calling thread, or -1 if unknown (not Linux).
+ */
+inline int numa_node_of_current_cpu(void){
+    #if defined(__linux__) && defined(SYS_getcpu)
+        unsigned int cpu  = 0;
+        unsigned int node = 0;
+        if(syscall(SYS_getcpu,&cpu,&node,NULL) == 0){
+            return static_cast<int>(node);
+        }
+    #endif
+    return -1;
+}
+
+/**
+ * @brief Free an array allocated with new_aligned_array or new_aligned_array_first_touch.
+ *        Does nothing if ptr is NULL.
+ */
+template<typename T>
+void delete_aligned_array(T *ptr){
+    free(ptr);
+}
+
+#endif
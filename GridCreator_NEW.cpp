@@ -1,5 +1,7 @@
 #include "GridCreator_NEW.h"
 
+#include "AlignedMemory.hpp"
+
 #include <ctime>
 #include <stdio.h>
 #include <stdlib.h>
@@ -38,6 +40,123 @@ GridCreator_NEW::GridCreator_NEW(InputParser &input_parser,
 
 }
 
+/**
+ * @brief Allocate the array of a field (size[0] x size[1] x size[2] elements, set to zero by all the OpenMP threads).
+ *
+ * If fields_in_shared_memory, the array is a window of shared memory of the node (field_windows[component]).
+ * Each MPI process has its own pages (alloc_shared_noncontig), set to zero by its threads (first touch).
+ * Otherwise, see new_yee_array_first_touch. The threads share the nodes as in the Yee kernels
+ * (see first_touch_zero_yee).
+ */
+template<typename T>
+T *GridCreator_NEW::new_field_array(const size_t *size, unsigned int component, const YeeRange range[3]){
+    const size_t *tile_size = this->input_parser.ELECTRO_TILE_SIZE;
+    if(!this->fields_in_shared_memory){
+        return new_yee_array_first_touch<T>(size,range,component % 3,tile_size);
+    }
+
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info,"alloc_shared_noncontig","true");
+
+    T *array = NULL;
+    MPI_Aint bytes = size[0] * size[1] * size[2] * sizeof(T);
+    MPI_Win_allocate_shared(bytes,sizeof(T),info,this->node_communicator,
+        &array,&this->field_windows[component]);
+    MPI_Info_free(&info);
+
+    first_touch_zero_yee(array,size,range,component % 3,tile_size);
+
+    return array;
+}
+
+/**
+ * @brief Free an array allocated with new_field_array.
+ */
+template<typename T>
+void GridCreator_NEW::delete_field_array(T *array, unsigned int component){
+    if(this->field_windows[component] != MPI_WIN_NULL){
+        MPI_Win_free(&this->field_windows[component]);
+    }else{
+        delete_aligned_array(array);
+    }
+}
+
+/**
+ * @brief Nodes of each component of H and E updated by the Yee kernels (see update_fields_until_step).
+ *
+ * The neighbours are not updated (start at 1, go to size-1), and the electric field is not updated on
+ * the boundary of the domain (ABC). With several ghost layers, the ghost layers are updated too: H from
+ * the first ghost layer before this process (it uses E(i) and E(i+1)), E up to the last ghost layer
+ * after it (it uses H(i-1) and H(i)).
+ *
+ * With MPI neighbours, the halos of H are exchanged while the interior of E is updated: the interior
+ * does not use the ghost nodes of H, the shell next to the faces with a neighbour (sides I low, I high,
+ * J low, J high, K low, K high) is updated once they are received. E(i) only uses H(i-1) and H(i): the
+ * ghost nodes of H are only read at the beginning of each axis (sides I low, J low, K low), the sides
+ * at the end of the axes stay in the interior.
+ */
+void GridCreator_NEW::get_yee_ranges(YeeRange range_H[3], YeeRange range_E[3],
+                                     YeeRange range_E_interior[3], YeeRange range_E_shell[3][6]){
+    const std::vector<size_t> *size_H[3] = {&this->size_Hx,&this->size_Hy,&this->size_Hz};
+    const std::vector<size_t> *size_E[3] = {&this->size_Ex,&this->size_Ey,&this->size_Ez};
+
+    /// The first and last MPI processes of each direction do not update E on the boundary of the domain:
+    size_t E_beg[3];
+    size_t E_end_shift[3];
+    size_t H_beg[3];
+    for(unsigned int d = 0 ; d < 3 ; d ++){
+        E_beg[d]       = this->MPI_communicator.MPI_POSITION[d] == 0 ? 2 : 1;
+        E_end_shift[d] = (this->ghost_layers_after[d] > 1 ? 0 : 1)
+            + (this->MPI_communicator.MPI_POSITION[d] == this->MPI_communicator.MPI_MAX_POSI[d] ? 1 : 0);
+        H_beg[d]       = this->ghost_layers_before[d] > 1 ? 0 : 1;
+    }
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        range_H[c] = make_yee_range(
+            H_beg[0], (*size_H[c])[0]-1,
+            H_beg[1], (*size_H[c])[1]-1,
+            H_beg[2], (*size_H[c])[2]-1);
+        range_E[c] = make_yee_range(
+            E_beg[0], (*size_E[c])[0]-E_end_shift[0],
+            E_beg[1], (*size_E[c])[1]-E_end_shift[1],
+            E_beg[2], (*size_E[c])[2]-E_end_shift[2]);
+    }
+
+    bool halo_E[6] = {
+        this->MPI_communicator.RankNeighbour[1] != -1,
+        false,
+        this->MPI_communicator.RankNeighbour[2] != -1,
+        false,
+        this->MPI_communicator.RankNeighbour[4] != -1,
+        false
+    };
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        split_yee_range_for_halo(range_E[c],halo_E,range_E_interior[c],range_E_shell[c]);
+    }
+}
+
+/**
+ * @brief Rank in node_communicator of the MPI process 'rank' (of MPI_COMM_WORLD), or -1 if the fields
+ *        of this process are not in the shared memory of this node (other node, or no shared memory).
+ */
+int GridCreator_NEW::rank_in_node(int rank){
+    if(!this->fields_in_shared_memory || rank < 0){
+        return -1;
+    }
+    MPI_Group world_group;
+    MPI_Group node_group;
+    MPI_Comm_group(MPI_COMM_WORLD,&world_group);
+    MPI_Comm_group(this->node_communicator,&node_group);
+
+    int node_rank = MPI_UNDEFINED;
+    MPI_Group_translate_ranks(world_group,1,&rank,node_group,&node_rank);
+
+    MPI_Group_free(&world_group);
+    MPI_Group_free(&node_group);
+
+    return node_rank == MPI_UNDEFINED ? -1 : node_rank;
+}
+
 /* DESTRUCTOR */
 GridCreator_NEW::~GridCreator_NEW(void){
     #ifndef NDEBUG
@@ -47,104 +166,122 @@ GridCreator_NEW::~GridCreator_NEW(void){
 
     // E_x:
     if(this->E_x != NULL){
-        delete[] this->E_x;
+        this->delete_field_array(this->E_x,0);
+    }
+    if(this->E_x_float != NULL){
+        this->delete_field_array(this->E_x_float,0);
     }
     // E_x_material:
     if(this->E_x_material !=NULL){
-        delete[] this->E_x_material;
+        delete_aligned_array(this->E_x_material);
     }
     // E_x_eps:
     if(this->E_x_eps != NULL){
-        delete[] this->E_x_eps;
+        delete_aligned_array(this->E_x_eps);
     }
     // E_x_electrical_cond
     if(this->E_x_electrical_cond != NULL){
-        delete[] this->E_x_electrical_cond;
+        delete_aligned_array(this->E_x_electrical_cond);
     }
     
     // E_y:
     if(this->E_y != NULL){
-        delete[] this->E_y;
+        this->delete_field_array(this->E_y,1);
+    }
+    if(this->E_y_float != NULL){
+        this->delete_field_array(this->E_y_float,1);
     }
     // E_y_material:
     if(this->E_y_material != NULL){
-        delete[] this->E_y_material;
+        delete_aligned_array(this->E_y_material);
     }
     // E_y_eps:
     if(this->E_y_eps != NULL){
-        delete[] this->E_y_eps;
+        delete_aligned_array(this->E_y_eps);
     }
     // E_y_electrical_cond
     if(this->E_y_electrical_cond != NULL){
-        delete[] this->E_y_electrical_cond;
+        delete_aligned_array(this->E_y_electrical_cond);
     }
 
     // E_z:
     if(this->E_z != NULL){
-        delete[] this->E_z;
+        this->delete_field_array(this->E_z,2);
+    }
+    if(this->E_z_float != NULL){
+        this->delete_field_array(this->E_z_float,2);
     }
     // E_z_material:
     if(this->E_z_material != NULL){
-        delete[] this->E_z_material;
+        delete_aligned_array(this->E_z_material);
     }
     // E_z_eps:
     if(this->E_z_eps != NULL){
-        delete[] this->E_z_eps;
+        delete_aligned_array(this->E_z_eps);
     }
     // E_z_electrical_cond
     if(this->E_z_electrical_cond != NULL){
-        delete[] this->E_z_electrical_cond;
+        delete_aligned_array(this->E_z_electrical_cond);
     }
 
     // H_x:
     if(this->H_x != NULL){
-        delete[] this->H_x;
+        this->delete_field_array(this->H_x,3);
+    }
+    if(this->H_x_float != NULL){
+        this->delete_field_array(this->H_x_float,3);
     }
     // H_x_material:
     if(this->H_x_material!= NULL){
-        delete[] this->H_x_material;
+        delete_aligned_array(this->H_x_material);
     }
     // H_x_mu:
     if(this->H_x_mu != NULL){
-        delete[] this->H_x_mu;
+        delete_aligned_array(this->H_x_mu);
     }
     // H_x_magnetic_cond:
     if(this->H_x_magnetic_cond != NULL){
-        delete[] this->H_x_magnetic_cond;
+        delete_aligned_array(this->H_x_magnetic_cond);
     }
 
     // H_y:
     if(this->H_y != NULL){
-        delete[] this->H_y;
+        this->delete_field_array(this->H_y,4);
+    }
+    if(this->H_y_float != NULL){
+        this->delete_field_array(this->H_y_float,4);
     }
     // H_y_material:
     if(this->H_y_material != NULL){
-        delete[] this->H_y_material;   
+        delete_aligned_array(this->H_y_material);   
     }
     // H_y_mu:
     if(this->H_y_mu != NULL){
-        delete[] this->H_y_mu;
+        delete_aligned_array(this->H_y_mu);
     }
     // H_y_magnetic_cond:
     if(this->H_y_magnetic_cond != NULL){
-        delete[] this->H_y_magnetic_cond;
+        delete_aligned_array(this->H_y_magnetic_cond);
     }
 
     // H_z:
     if(this->H_z != NULL){
-        delete[] this->H_z;
+        this->delete_field_array(this->H_z,5);
+    }
+    if(this->H_z_float != NULL){
+        this->delete_field_array(this->H_z_float,5);
     }
     // H_z_material:
     if(this->H_z_material != NULL){
-        delete[] this->H_z_material;
+        delete_aligned_array(this->H_z_material);
     }
     // H_z_mu:
     if(this->H_z_mu != NULL){
-        delete[] this->H_z_mu;
+        delete_aligned_array(this->H_z_mu);
     }
     // H_z_magnetic_cond:
     if(this->H_z_magnetic_cond != NULL){
-        delete[] this->H_z_magnetic_cond;
+        delete_aligned_array(this->H_z_magnetic_cond);
     }
 
     // Temperature:
@@ -163,6 +300,10 @@ GridCreator_NEW::~GridCreator_NEW(void){
     if(this->thermal_diffusivity != NULL){
         delete[] this->thermal_diffusivity;
     }
+    // Communicator of the node (fields in shared memory):
+    if(this->node_communicator != MPI_COMM_NULL){
+        MPI_Comm_free(&this->node_communicator);
+    }
     #ifndef NDEBUG
         std::cout << "GridCreator_NEW::~GridCreator_NEW::OUT" << std::endl;
     #endif
@@ -181,8 +322,6 @@ void GridCreator_NEW::meshInitialization(void){
     size_t N = this->sizes_EH[1];
     size_t P = this->sizes_EH[2];
 
-    size_t size;
-
     if(M == 0 || N == 0 || P == 0){
         fprintf(stderr,"GridCreator_NEW::meshInitialization::ERROR\n");
         fprintf(stderr,"\t>>> One of the quantities (M,N,P)=(%zu,%zu,%zu) is invalid.\nAborting.\n",M,N,P);
@@ -194,179 +333,260 @@ void GridCreator_NEW::meshInitialization(void){
      * For each field (magnetic or electric), add 2 nodes in each direction so that 
      * we have information on what happens inside the MPI processes around the current MPI
      * process.
+     *
+     * The fields and their properties are aligned on MEMORY_ALIGNMENT bytes for the
+     * vectorized kernels (see AlignedMemory.hpp).
      */
 
+    /// The fields are stored in double, or in float if asked in the input file (PRECISION=FLOAT or MIXED):
+    this->fields_in_float = this->input_parser.ELECTRO_PRECISION != "DOUBLE";
+
+    /**
+     * Ghost layers of the faces with an MPI neighbour ($ELECTRO_SOLVER GHOST_LAYERS). With more than one
+     * layer, the halos are exchanged once every GHOST_LAYERS steps (see update_fields_until_step), and each
+     * ghost layer must come from the nodes of a single neighbour. Not with REBALANCING_PERIOD > 0, since
+     * the planes moved at run time only have one ghost layer (see migrate_planes_along_z).
+     */
+    this->ghost_layers = this->input_parser.ELECTRO_GHOST_LAYERS;
+    if(this->ghost_layers > 1 && this->input_parser.ELECTRO_REBALANCING_PERIOD > 0){
+        if(this->MPI_communicator.isRootProcess() != INT_MIN){
+            DISPLAY_WARNING(
+                "GHOST_LAYERS=%zu is not used with REBALANCING_PERIOD > 0. Using one ghost layer.\n",
+                this->ghost_layers
+            );
+        }
+        this->ghost_layers = 1;
+    }
+    /// Faces at the beginning (1, 2, 4) and at the end (0, 3, 5) of each axis:
+    const unsigned int face_before[3] = {1,2,4};
+    const unsigned int face_after [3] = {0,3,5};
+    for(unsigned int d = 0 ; d < 3 ; d ++){
+        this->ghost_layers_before[d] = this->MPI_communicator.RankNeighbour[face_before[d]] == -1 ? 1 : this->ghost_layers;
+        this->ghost_layers_after [d] = this->MPI_communicator.RankNeighbour[face_after [d]] == -1 ? 1 : this->ghost_layers;
+        if(    this->ghost_layers > 1
+            && (this->ghost_layers_before[d] > 1 || this->ghost_layers_after[d] > 1)
+            && this->sizes_EH[d] <= this->ghost_layers){
+            DISPLAY_ERROR_ABORT(
+                "[MPI %d] Has %zu nodes along direction %u, which must be more than GHOST_LAYERS=%zu.",
+                this->MPI_communicator.getRank(),
+                this->sizes_EH[d],
+                d,
+                this->ghost_layers
+            );
+        }
+    }
+    size_t nbr_ghost_layers[3] = {
+        this->ghost_layers_before[0] + this->ghost_layers_after[0],
+        this->ghost_layers_before[1] + this->ghost_layers_after[1],
+        this->ghost_layers_before[2] + this->ghost_layers_after[2]
+    };
+
+    /**
+     * With HALO_EXCHANGE=SHARED_MEMORY and other MPI processes on this node, the fields are in shared
+     * memory (see new_field_array). Not with REBALANCING_PERIOD > 0: the planes moved at run time are
+     * put in new private arrays (see migrate_planes_along_z). Not with several ghost layers either,
+     * whose halos are always exchanged with messages.
+     */
+    if(    this->input_parser.ELECTRO_HALO_EXCHANGE == "SHARED_MEMORY"
+        && this->input_parser.ELECTRO_REBALANCING_PERIOD == 0
+        && this->ghost_layers == 1
+        && this->MPI_communicator.getNumberOfMPIProcesses() > 1){
+
+        MPI_Comm_split_type(MPI_COMM_WORLD,MPI_COMM_TYPE_SHARED,this->MPI_communicator.getRank(),
+            MPI_INFO_NULL,&this->node_communicator);
+
+        int nbr_processes_in_node = 1;
+        MPI_Comm_size(this->node_communicator,&nbr_processes_in_node);
+        this->fields_in_shared_memory = nbr_processes_in_node > 1;
+        if(!this->fields_in_shared_memory){
+            MPI_Comm_free(&this->node_communicator);
+        }
+    }
+
 
     /* ALLOCATE SPACE FOR THE ELECTRIC FIELDS */
 
     /// Remove one if necessary (see paper and size of the global grid):
     size_t REMOVE_ONE = 1;
 
-    // Size of E_x is  (M − 1) × N × P. Add 2 nodes in each direction for the neighboors.
+    // Size of E_x is  (M − 1) × N × P. Add the ghost layers in each direction for the neighboors.
 
     if(this->MPI_communicator.must_add_one_to_E_X_along_XYZ[0] == true){
-        this->size_Ex[0] = M + 2 - REMOVE_ONE;
+        this->size_Ex[0] = M + nbr_ghost_layers[0] - REMOVE_ONE;
     }else{
-        this->size_Ex[0] = M + 2;
+        this->size_Ex[0] = M + nbr_ghost_layers[0];
     }
     if(this->MPI_communicator.must_add_one_to_E_X_along_XYZ[1] == true){
-        this->size_Ex[1] = N + 2 - REMOVE_ONE;
+        this->size_Ex[1] = N + nbr_ghost_layers[1] - REMOVE_ONE;
     }else{
-        this->size_Ex[1] = N + 2;        
+        this->size_Ex[1] = N + nbr_ghost_layers[1];        
     }
     if(this->MPI_communicator.must_add_one_to_E_X_along_XYZ[2] == true){
-        this->size_Ex[2] = P + 2 - REMOVE_ONE;
+        this->size_Ex[2] = P + nbr_ghost_layers[2] - REMOVE_ONE;
     }else{
-        this->size_Ex[2] = P + 2;
+        this->size_Ex[2] = P + nbr_ghost_layers[2];
     }
     
-    size = this->size_Ex[0] * this->size_Ex[1] * this->size_Ex[2];
-
-    this->E_x                 = new double[size]();
-    this->E_x_material        = new unsigned char[size]();
-    this->E_x_eps             = new double[size]();
-    this->E_x_electrical_cond = new double [size]();
 
-    // Size of E_y is  M × (N − 1) × P. Add 2 nodes in each direction for the neighboors.
+    // Size of E_y is  M × (N − 1) × P. Add the ghost layers in each direction for the neighboors.
     if(this->MPI_communicator.must_add_one_to_E_Y_along_XYZ[0] == true){
-        this->size_Ey[0] = M + 2 - REMOVE_ONE;
+        this->size_Ey[0] = M + nbr_ghost_layers[0] - REMOVE_ONE;
     }else{
-        this->size_Ey[0] = M + 2;
+        this->size_Ey[0] = M + nbr_ghost_layers[0];
     }
 
     if(this->MPI_communicator.must_add_one_to_E_Y_along_XYZ[1] == true){
-        this->size_Ey[1] = N + 2 - REMOVE_ONE;
+        this->size_Ey[1] = N + nbr_ghost_layers[1] - REMOVE_ONE;
     }else{
-        this->size_Ey[1] = N + 2;
+        this->size_Ey[1] = N + nbr_ghost_layers[1];
     }
 
     if(this->MPI_communicator.must_add_one_to_E_Y_along_XYZ[2] == true){
-        this->size_Ey[2] = P + 2 - REMOVE_ONE;
+        this->size_Ey[2] = P + nbr_ghost_layers[2] - REMOVE_ONE;
     }else{
-        this->size_Ey[2] = P + 2;
+        this->size_Ey[2] = P + nbr_ghost_layers[2];
     }
 
-    size = this->size_Ey[0] * this->size_Ey[1] * this->size_Ey[2];
 
-    this->E_y                 = new double[size]();
-    this->E_y_material        = new unsigned char[size]();
-    this->E_y_eps             = new double[size]();
-    this->E_y_electrical_cond = new double[size]();
-
-    // Size of E_z is  M × N × (P − 1). Add 2 nodes in each direction for the neighboors.
+    // Size of E_z is  M × N × (P − 1). Add the ghost layers in each direction for the neighboors.
 
     if(this->MPI_communicator.must_add_one_to_E_Z_along_XYZ[0] == true){
-        this->size_Ez[0] = M + 2 - REMOVE_ONE;
+        this->size_Ez[0] = M + nbr_ghost_layers[0] - REMOVE_ONE;
     }else{
-        this->size_Ez[0] = M + 2;
+        this->size_Ez[0] = M + nbr_ghost_layers[0];
     }
 
     if(this->MPI_communicator.must_add_one_to_E_Z_along_XYZ[1] == true){
-        this->size_Ez[1] = N + 2 - REMOVE_ONE;
+        this->size_Ez[1] = N + nbr_ghost_layers[1] - REMOVE_ONE;
     }else{
-        this->size_Ez[1] = N + 2;
+        this->size_Ez[1] = N + nbr_ghost_layers[1];
     }
 
     if(this->MPI_communicator.must_add_one_to_E_Z_along_XYZ[2] == true){
-        this->size_Ez[2] = P + 2 - REMOVE_ONE;
+        this->size_Ez[2] = P + nbr_ghost_layers[2] - REMOVE_ONE;
     }else{
-        this->size_Ez[2] = P + 2;
+        this->size_Ez[2] = P + nbr_ghost_layers[2];
     }
 
-    size = this->size_Ez[0] * this->size_Ez[1] * this->size_Ez[2];
-
-    this->E_z                 = new double[size]();
-    this->E_z_material        = new unsigned char[size]();
-    this->E_z_eps             = new double[size]();
-    this->E_z_electrical_cond = new double[size]();
 
     /* ALLOCATE SPACE FOR THE MAGNETIC FIELDS */
 
-    // Size of H_x is  M × (N − 1) × (P − 1). Add 2 nodes in each direction for the neighboors.
+    // Size of H_x is  M × (N − 1) × (P − 1). Add the ghost layers in each direction for the neighboors.
 
     if(this->MPI_communicator.must_add_one_to_H_X_along_XYZ[0] == true){
-        this->size_Hx[0] = M + 2 - REMOVE_ONE;
+        this->size_Hx[0] = M + nbr_ghost_layers[0] - REMOVE_ONE;
     }else{
-        this->size_Hx[0] = M + 2;
+        this->size_Hx[0] = M + nbr_ghost_layers[0];
     }
 
     if(this->MPI_communicator.must_add_one_to_H_X_along_XYZ[1] == true){
-        this->size_Hx[1] = N + 2 - REMOVE_ONE;
+        this->size_Hx[1] = N + nbr_ghost_layers[1] - REMOVE_ONE;
     }else{
-        this->size_Hx[1] = N + 2;
+        this->size_Hx[1] = N + nbr_ghost_layers[1];
     }
 
     if(this->MPI_communicator.must_add_one_to_H_X_along_XYZ[2] == true){
-        this->size_Hx[2] = P + 2 - REMOVE_ONE;
+        this->size_Hx[2] = P + nbr_ghost_layers[2] - REMOVE_ONE;
     }else{
-        this->size_Hx[2] = P + 2;
+        this->size_Hx[2] = P + nbr_ghost_layers[2];
     }
 
-    size = this->size_Hx[0] * 
-            this->size_Hx[1] * 
-            this->size_Hx[2];
 
-    this->H_x               = new double[size]();
-    this->H_x_material      = new unsigned char[size]();
-    this->H_x_magnetic_cond = new double[size]();
-    this->H_x_mu            = new double[size]();
-
-    // Size of H_y is  (M − 1) × N × (P − 1). Add 2 nodes in each direction for the neighboors.
+    // Size of H_y is  (M − 1) × N × (P − 1). Add the ghost layers in each direction for the neighboors.
 
     if(this->MPI_communicator.must_add_one_to_H_Y_along_XYZ[0] == true){
-        this->size_Hy[0] = M + 2 - REMOVE_ONE;
+        this->size_Hy[0] = M + nbr_ghost_layers[0] - REMOVE_ONE;
     }else{
-        this->size_Hy[0] = M + 2;
+        this->size_Hy[0] = M + nbr_ghost_layers[0];
     }
 
     if(this->MPI_communicator.must_add_one_to_H_Y_along_XYZ[1] == true){
-        this->size_Hy[1] = N + 2 - REMOVE_ONE;
+        this->size_Hy[1] = N + nbr_ghost_layers[1] - REMOVE_ONE;
     }else{
-        this->size_Hy[1] = N + 2;
+        this->size_Hy[1] = N + nbr_ghost_layers[1];
     }
 
     if(this->MPI_communicator.must_add_one_to_H_Y_along_XYZ[2] == true){
-        this->size_Hy[2] = P + 2 - REMOVE_ONE;
+        this->size_Hy[2] = P + nbr_ghost_layers[2] - REMOVE_ONE;
     }else{
-        this->size_Hy[2] = P + 2;
+        this->size_Hy[2] = P + nbr_ghost_layers[2];
     }
 
-    size = this->size_Hy[0]
-             * this->size_Hy[1]
-             * this->size_Hy[2];
-
-    this->H_y               = new double[size]();
-    this->H_y_material      = new unsigned char[size]();
-    this->H_y_mu            = new double[size]();
-    this->H_y_magnetic_cond = new double[size]();
 
-    // Size of H_z is  (M − 1) × (N − 1) × P. Add 2 nodes in each direction for the nieghboors.
+    // Size of H_z is  (M − 1) × (N − 1) × P. Add the ghost layers in each direction for the nieghboors.
     if(this->MPI_communicator.must_add_one_to_H_Z_along_XYZ[0] == true){
-        this->size_Hz[0] = M + 2 - REMOVE_ONE;
+        this->size_Hz[0] = M + nbr_ghost_layers[0] - REMOVE_ONE;
     }else{
-        this->size_Hz[0] = M + 2;
+        this->size_Hz[0] = M + nbr_ghost_layers[0];
     }
 
     if(this->MPI_communicator.must_add_one_to_H_Z_along_XYZ[1] == true){
-        this->size_Hz[1] = N + 2 - REMOVE_ONE;
+        this->size_Hz[1] = N + nbr_ghost_layers[1] - REMOVE_ONE;
     }else{
-        this->size_Hz[1] = N + 2;
+        this->size_Hz[1] = N + nbr_ghost_layers[1];
     }
 
     if(this->MPI_communicator.must_add_one_to_H_Z_along_XYZ[2] == true){
-        this->size_Hz[2] = P + 2 - REMOVE_ONE;
+        this->size_Hz[2] = P + nbr_ghost_layers[2] - REMOVE_ONE;
+    }else{
+        this->size_Hz[2] = P + nbr_ghost_layers[2];
+    }
+
+
+    /**
+     * The arrays of the nodes of each component are set to zero by the OpenMP threads that update the
+     * component in the Yee kernels (first touch, see first_touch_zero_yee). The tiles of the kernels cover
+     * the three components of a field, so the arrays are allocated once all the sizes are known.
+     * E is updated by the tiles over the interior of range_E when the ghost nodes of H are received at
+     * each half step (one ghost layer), as range_E_no_halo in update_fields_until_step.
+     */
+    YeeRange range_H[3];
+    YeeRange range_E[3];
+    YeeRange range_E_interior[3];
+    YeeRange range_E_shell[3][6];
+    this->get_yee_ranges(range_H,range_E,range_E_interior,range_E_shell);
+    const YeeRange *range_E_tiled = this->ghost_layers > 1 ? range_E : range_E_interior;
+    const size_t   *tile_size     = this->input_parser.ELECTRO_TILE_SIZE;
+
+    if(this->fields_in_float){
+        this->E_x_float = this->new_field_array<float>(this->size_Ex.data(),0,range_E_tiled);
+        this->E_y_float = this->new_field_array<float>(this->size_Ey.data(),1,range_E_tiled);
+        this->E_z_float = this->new_field_array<float>(this->size_Ez.data(),2,range_E_tiled);
+        this->H_x_float = this->new_field_array<float>(this->size_Hx.data(),3,range_H);
+        this->H_y_float = this->new_field_array<float>(this->size_Hy.data(),4,range_H);
+        this->H_z_float = this->new_field_array<float>(this->size_Hz.data(),5,range_H);
     }else{
-        this->size_Hz[2] = P + 2;
+        this->E_x       = this->new_field_array<double>(this->size_Ex.data(),0,range_E_tiled);
+        this->E_y       = this->new_field_array<double>(this->size_Ey.data(),1,range_E_tiled);
+        this->E_z       = this->new_field_array<double>(this->size_Ez.data(),2,range_E_tiled);
+        this->H_x       = this->new_field_array<double>(this->size_Hx.data(),3,range_H);
+        this->H_y       = this->new_field_array<double>(this->size_Hy.data(),4,range_H);
+        this->H_z       = this->new_field_array<double>(this->size_Hz.data(),5,range_H);
     }
 
-    size = this->size_Hz[0]
-             * this->size_Hz[1]
-             * this->size_Hz[2];
+    this->E_x_material        = new_yee_array_first_touch<unsigned char>(this->size_Ex.data(),range_E_tiled,0,tile_size);
+    this->E_x_eps             = new_yee_array_first_touch<double>(this->size_Ex.data(),range_E_tiled,0,tile_size);
+    this->E_x_electrical_cond = new_yee_array_first_touch<double>(this->size_Ex.data(),range_E_tiled,0,tile_size);
+
+    this->E_y_material        = new_yee_array_first_touch<unsigned char>(this->size_Ey.data(),range_E_tiled,1,tile_size);
+    this->E_y_eps             = new_yee_array_first_touch<double>(this->size_Ey.data(),range_E_tiled,1,tile_size);
+    this->E_y_electrical_cond = new_yee_array_first_touch<double>(this->size_Ey.data(),range_E_tiled,1,tile_size);
+
+    this->E_z_material        = new_yee_array_first_touch<unsigned char>(this->size_Ez.data(),range_E_tiled,2,tile_size);
+    this->E_z_eps             = new_yee_array_first_touch<double>(this->size_Ez.data(),range_E_tiled,2,tile_size);
+    this->E_z_electrical_cond = new_yee_array_first_touch<double>(this->size_Ez.data(),range_E_tiled,2,tile_size);
+
+    this->H_x_material      = new_yee_array_first_touch<unsigned char>(this->size_Hx.data(),range_H,0,tile_size);
+    this->H_x_magnetic_cond = new_yee_array_first_touch<double>(this->size_Hx.data(),range_H,0,tile_size);
+    this->H_x_mu            = new_yee_array_first_touch<double>(this->size_Hx.data(),range_H,0,tile_size);
 
-    this->H_z               = new double[size]();
-    this->H_z_material      = new unsigned char[size]();
-    this->H_z_mu            = new double[size]();
-    this->H_z_magnetic_cond = new double[size]();
+    this->H_y_material      = new_yee_array_first_touch<unsigned char>(this->size_Hy.data(),range_H,1,tile_size);
+    this->H_y_mu            = new_yee_array_first_touch<double>(this->size_Hy.data(),range_H,1,tile_size);
+    this->H_y_magnetic_cond = new_yee_array_first_touch<double>(this->size_Hy.data(),range_H,1,tile_size);
+
+    this->H_z_material      = new_yee_array_first_touch<unsigned char>(this->size_Hz.data(),range_H,2,tile_size);
+    this->H_z_mu            = new_yee_array_first_touch<double>(this->size_Hz.data(),range_H,2,tile_size);
+    this->H_z_magnetic_cond = new_yee_array_first_touch<double>(this->size_Hz.data(),range_H,2,tile_size);
 
     /* ALLOCATE SPACE FOR THE TEMPERATURE FIELD */
 
@@ -427,6 +647,18 @@ void GridCreator_NEW::Assign_A_Material_To_Each_Node(){
         abort();
     }
 
+    // The tests of the paraview output write the indices in the double precision fields:
+    if(this->fields_in_float
+        && (   this->input_parser.get_SimulationType() == "TEST_PARAVIEW"
+            || this->input_parser.get_SimulationType() == "TEST_PARAVIEW_MPI"))
+    {
+        DISPLAY_ERROR_ABORT(
+            "%s requires $ELECTRO_SOLVER PRECISION=DOUBLE (has %s).",
+            this->input_parser.get_SimulationType().c_str(),
+            this->input_parser.ELECTRO_PRECISION.c_str()
+        );
+    }
+
     // Assign material as a function of the simulation type.
 
     GridCreator_NEW *ref_obj = this;
@@ -1051,6 +1283,65 @@ void GridCreator_NEW::get_Global_from_Local_Thermal(size_t *local,size_t* global
 
 }
 
+/**
+ * @brief Move planes along Z between this MPI process and its neighbours below and above
+ *        (see MPI_Initializer::MPI_REBALANCING_ALONG_Z).
+ *
+ * planes_from_below > 0 planes are received from the neighbour below, planes_from_below < 0 planes are
+ * sent to it (same for planes_from_above). The fields, the materials and the properties of the nodes are
+ * moved, then the sizes and the origin of the electromagnetic grid are updated. The thermal grid does not change.
+ */
+void GridCreator_NEW::migrate_planes_along_z(long planes_from_below, long planes_from_above){
+
+    if(this->fields_in_shared_memory){
+        DISPLAY_ERROR_ABORT("The planes of fields in shared memory cannot be moved.");
+    }
+    if(this->ghost_layers > 1){
+        DISPLAY_ERROR_ABORT("The planes of fields with %zu ghost layers cannot be moved.",this->ghost_layers);
+    }
+
+    const int *RankNeighbour = this->MPI_communicator.RankNeighbour;
+
+    /// The six components (Ex, Ey, Ez, Hx, Hy, Hz), with their two properties (eps or mu, and conductivity):
+    std::vector<size_t> *sizes[6]  = {&this->size_Ex,&this->size_Ey,&this->size_Ez,
+                                      &this->size_Hx,&this->size_Hy,&this->size_Hz};
+    double        **field[6]       = {&this->E_x,&this->E_y,&this->E_z,
+                                      &this->H_x,&this->H_y,&this->H_z};
+    float         **field_float[6] = {&this->E_x_float,&this->E_y_float,&this->E_z_float,
+                                      &this->H_x_float,&this->H_y_float,&this->H_z_float};
+    unsigned char **material[6]    = {&this->E_x_material,&this->E_y_material,&this->E_z_material,
+                                      &this->H_x_material,&this->H_y_material,&this->H_z_material};
+    double        **property[6]    = {&this->E_x_eps,&this->E_y_eps,&this->E_z_eps,
+                                      &this->H_x_mu,&this->H_y_mu,&this->H_z_mu};
+    double        **conductivity[6]= {&this->E_x_electrical_cond,&this->E_y_electrical_cond,
+                                      &this->E_z_electrical_cond,&this->H_x_magnetic_cond,
+                                      &this->H_y_magnetic_cond,&this->H_z_magnetic_cond};
+
+    for(unsigned int c = 0 ; c < 6 ; c ++){
+        size_t plane_size = (*sizes[c])[0] * (*sizes[c])[1];
+        size_t nbr_planes = (*sizes[c])[2];
+
+        if(this->fields_in_float){
+            ::migrate_planes_along_z(*field_float[c],plane_size,nbr_planes,1,
+                planes_from_below,planes_from_above,RankNeighbour);
+        }else{
+            ::migrate_planes_along_z(*field[c],plane_size,nbr_planes,1,
+                planes_from_below,planes_from_above,RankNeighbour);
+        }
+        ::migrate_planes_along_z(*material[c],plane_size,nbr_planes,1,
+            planes_from_below,planes_from_above,RankNeighbour);
+        ::migrate_planes_along_z(*property[c],plane_size,nbr_planes,1,
+            planes_from_below,planes_from_above,RankNeighbour);
+        ::migrate_planes_along_z(*conductivity[c],plane_size,nbr_planes,1,
+            planes_from_below,planes_from_above,RankNeighbour);
+
+        (*sizes[c])[2] += planes_from_below + planes_from_above;
+    }
+
+    this->sizes_EH[2]              += planes_from_below + planes_from_above;
+    this->originIndices_Electro[2] -= planes_from_below;
+}
+
 /**
  * @brief Compute nodes that are inside the sources
  * 
@@ -1202,7 +1493,6 @@ void GridCreator_NEW::Compute_nodes_inside_sources(
 
         size_t I,J,K;
 
-        size_t local[3];
         size_t global[3];
 
         // Check for the nodes Ez:
@@ -1212,11 +1502,11 @@ void GridCreator_NEW::Compute_nodes_inside_sources(
                 for(I = 1 ; I < SIZES_PRIVATE[0]-1 ; I ++){
 
                     // Convert to global node numbering:
-                    // Shift of 1 because we start the loop at 1:
-                    local[0] = I-1;
-                    local[1] = J-1;
-                    local[2] = K-1;
-                    this->get_Global_from_Local_Electro(local,global);
+                    // Shift of the ghost layers, which are before the nodes of this process. The ghost
+                    // layers of the neighbours are also looped over, so that they impose the sources too:
+                    global[0] = this->originIndices_Electro[0] + I - this->ghost_layers_before[0];
+                    global[1] = this->originIndices_Electro[1] + J - this->ghost_layers_before[1];
+                    global[2] = this->originIndices_Electro[2] + K - this->ghost_layers_before[2];
 
                     // Loop over all the sources:
                     for(unsigned char id = 0 ; id < this->input_parser.source.get_number_of_sources() ; id ++){
@@ -1362,12 +1652,12 @@ void GridCreator_NEW::get_local_from_global_electro(
 
     /**
      * We must be carefull about the nodes for send/recv operations in MPI comm;
-     * we add a '+1' because the first column/row/slice is for send/recv.
+     * we add the ghost layers because the first columns/rows/slices are for send/recv.
      */
 
-    *nbr_X_loc = nbr_X_gl - this->originIndices_Electro[0] + 1;
-    *nbr_Y_loc = nbr_Y_gl - this->originIndices_Electro[1] + 1;
-    *nbr_Z_loc = nbr_Z_gl - this->originIndices_Electro[2] + 1;
+    *nbr_X_loc = nbr_X_gl - this->originIndices_Electro[0] + this->ghost_layers_before[0];
+    *nbr_Y_loc = nbr_Y_gl - this->originIndices_Electro[1] + this->ghost_layers_before[1];
+    *nbr_Z_loc = nbr_Z_gl - this->originIndices_Electro[2] + this->ghost_layers_before[2];
 
     *is_ok = true;
 }
\ No newline at end of file
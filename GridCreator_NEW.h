@@ -3,16 +3,22 @@
 
 #include <vector>
 #include <cstdio>
+#include <cstring>
 
 #include "Materials.h"
 #include "MPI_Initializer.h"
 #include "InputParser.h"
 #include "ProfilingClass.h"
+#include "AlignedMemory.hpp"
+#include "YeeKernels.hpp"
 
 #include "vtl.h"
 #include "vtlVec3.h"
 #include "vtlSPoints.h" 
 
+/// Tag of the planes moved between two MPI processes (see migrate_planes_along_z):
+#define TAG_MIGRATE_PLANES 30
+
 class MPI_Initializer;
 class GridCreator_NEW{
     public:
@@ -29,6 +35,23 @@ class GridCreator_NEW{
          *   Hy of size (M − 1) × N × (P − 1)
          *   Hz of size (M − 1) × (N − 1) × P
          */
+        // The fields are stored either in double (E_x, ..., H_z) or in float (E_x_float, ..., H_z_float),
+        // depending on $ELECTRO_SOLVER PRECISION. The arrays of the other precision stay NULL:
+        bool fields_in_float = false;
+        // With $ELECTRO_SOLVER HALO_EXCHANGE=SHARED_MEMORY, the fields are in windows of shared memory of the
+        // node (MPI_Win_allocate_shared), so that the MPI neighbours of the same node copy their ghost planes
+        // from them. node_communicator has the MPI processes of the node, field_windows[6] are the windows
+        // of Ex, Ey, Ez, Hx, Hy, Hz (MPI_WIN_NULL if the fields are not in shared memory):
+        bool     fields_in_shared_memory = false;
+        MPI_Comm node_communicator       = MPI_COMM_NULL;
+        MPI_Win  field_windows[6]        = {MPI_WIN_NULL,MPI_WIN_NULL,MPI_WIN_NULL,
+                                            MPI_WIN_NULL,MPI_WIN_NULL,MPI_WIN_NULL};
+        // Number of ghost layers before and after the nodes of this process along each direction, in the
+        // electromagnetic fields: $ELECTRO_SOLVER GHOST_LAYERS on the faces with an MPI neighbour, 1 otherwise.
+        // The node (I,J,K) of the arrays is the node (I,J,K) - ghost_layers_before of this process:
+        size_t              ghost_layers        = 1;
+        std::vector<size_t> ghost_layers_before = {1,1,1};
+        std::vector<size_t> ghost_layers_after  = {1,1,1};
         // Spatial steps for electromagnetic fields:
         std::vector<double> delta_Electromagn = {-1.0,-1.0,-1.0};
         // Number of nodes along each direction for the electromagnetic mesh, eqivalent to M,N,P:
@@ -36,6 +59,7 @@ class GridCreator_NEW{
         // Electric fields along X,Y,Z, and the corresponding material 
         // + permittivity (eps) and electrical conductivity:
         double *E_x                 = NULL;
+        float  *E_x_float           = NULL;
         unsigned char *E_x_material = NULL;
         double *E_x_eps             = NULL;
         double *E_x_electrical_cond = NULL;
@@ -43,6 +67,7 @@ class GridCreator_NEW{
         std::vector<size_t> size_Ex = {0,0,0}; //= (M − 1 + 2) * (N + 2) * (P + 2);
 
         double *E_y                 = NULL;
+        float  *E_y_float           = NULL;
         unsigned char *E_y_material = NULL;
         double *E_y_eps             = NULL;
         double *E_y_electrical_cond = NULL;
@@ -50,6 +75,7 @@ class GridCreator_NEW{
         std::vector<size_t> size_Ey = {0,0,0}; //= (M + 2) * (N − 1 + 2) * (P + 2);
 
         double *E_z                 = NULL;
+        float  *E_z_float           = NULL;
         unsigned char *E_z_material = NULL;
         double *E_z_eps             = NULL;
         double *E_z_electrical_cond = NULL;
@@ -59,6 +85,7 @@ class GridCreator_NEW{
         // Magnetic fields along X,Y,Z, and the corresponding material 
         // + magnetic permeability (mu) and magnetic conductivity:
         double *H_x                 = NULL;
+        float  *H_x_float           = NULL;
         unsigned char *H_x_material = NULL;
         double *H_x_mu              = NULL;
         double *H_x_magnetic_cond   = NULL;
@@ -66,6 +93,7 @@ class GridCreator_NEW{
         std::vector<size_t> size_Hx = {0,0,0}; //= (M+2) * (N − 1 +2) * (P − 1 +2)
 
         double *H_y                 = NULL;
+        float  *H_y_float           = NULL;
         unsigned char *H_y_material = NULL;
         double *H_y_mu              = NULL;
         double *H_y_magnetic_cond   = NULL;
@@ -73,6 +101,7 @@ class GridCreator_NEW{
         std::vector<size_t> size_Hy = {0,0,0}; //= (M − 1 +2) * (N+2) * (P − 1 + 2)
 
         double *H_z                 = NULL;
+        float  *H_z_float           = NULL;
         unsigned char *H_z_material = NULL;
         double *H_z_mu              = NULL;
         double *H_z_magnetic_cond   = NULL;
@@ -158,20 +187,26 @@ class GridCreator_NEW{
         );
 
 
-        double* get_fields(std::string &key){
+        // Value of the node 'index' of a component of the electric field, whatever its precision:
+        double get_field_value(std::string &key, size_t index){
             if(key == "Ex")
-                return this->E_x;
+                return this->fields_in_float ? this->E_x_float[index] : this->E_x[index];
             else if(key == "Ey")
-                return this->E_y;
+                return this->fields_in_float ? this->E_y_float[index] : this->E_y[index];
             else if(key == "Ez")
-                return this->E_z;
+                return this->fields_in_float ? this->E_z_float[index] : this->E_z[index];
             else
                 DISPLAY_ERROR_ABORT(
                     "No field corresponding to %s.",key.c_str()
                 );
-            return NULL;
+            return 0.0;
         }
 
+        // Arrays of the electric (Ex,Ey,Ez) and magnetic (Hx,Hy,Hz) fields, stored as FIELD_TYPE
+        // (double or float, see fields_in_float):
+        template<typename FIELD_TYPE>
+        void get_field_arrays(FIELD_TYPE *E[3], FIELD_TYPE *H[3]);
+
         std::vector<size_t> get_fields_size(std::string &key){
             if(key == "size_Ex")
                 return this->size_Ex;
@@ -187,6 +222,26 @@ class GridCreator_NEW{
             return empty;
         }
 
+        // Rank in node_communicator of the MPI process 'rank', or -1 if its fields are not in the shared
+        // memory of this node:
+        int rank_in_node(int rank);
+
+        // Nodes of each component of H and E updated by the Yee kernels (see update_fields_until_step), and
+        // the interior and shell of range_E when the ghost nodes of H are received at each half step:
+        void get_yee_ranges(YeeRange range_H[3], YeeRange range_E[3],
+                            YeeRange range_E_interior[3], YeeRange range_E_shell[3][6]);
+
+        // Move planes along Z to (or from) the MPI neighbours below and above (see MPI_REBALANCING_ALONG_Z):
+        void migrate_planes_along_z(long planes_from_below, long planes_from_above);
+
+        // Allocate (and free) the array of a field, in shared memory if fields_in_shared_memory
+        // (window field_windows[component], component = 0 to 5 for Ex, ..., Hz). 'range' are the
+        // ranges of the three components of the field updated by the Yee kernels (first touch):
+        template<typename T>
+        T *new_field_array(const size_t *size, unsigned int component, const YeeRange range[3]);
+        template<typename T>
+        void delete_field_array(T *array, unsigned int component);
+
         void get_local_from_global_electro(
             const size_t nbr_X_gl ,const size_t nbr_Y_gl ,const size_t nbr_Z_gl,
             size_t *nbr_X_loc     ,size_t *nbr_Y_loc     ,size_t *nbr_Z_loc,
@@ -194,4 +249,100 @@ class GridCreator_NEW{
         );
 };
 
+template<>
+inline void GridCreator_NEW::get_field_arrays<double>(double *E[3], double *H[3]){
+    if(this->fields_in_float){
+        DISPLAY_ERROR_ABORT("The fields are stored in float, not in double.");
+    }
+    E[0] = this->E_x; E[1] = this->E_y; E[2] = this->E_z;
+    H[0] = this->H_x; H[1] = this->H_y; H[2] = this->H_z;
+}
+
+template<>
+inline void GridCreator_NEW::get_field_arrays<float>(float *E[3], float *H[3]){
+    if(!this->fields_in_float){
+        DISPLAY_ERROR_ABORT("The fields are stored in double, not in float.");
+    }
+    E[0] = this->E_x_float; E[1] = this->E_y_float; E[2] = this->E_z_float;
+    H[0] = this->H_x_float; H[1] = this->H_y_float; H[2] = this->H_z_float;
+}
+
+
+/**
+ * @brief Move planes of an array stored plane by plane along Z (index I + plane_size * K) between this
+ *        MPI process and its neighbours below (face 4) and above (face 5).
+ *
+ * The array has nbr_planes planes, the first and last ghost_planes ones being ghost planes (1 for the
+ * fields, 0 for the ABC). planes_from_below > 0 planes are received from the neighbour below and put
+ * before the first plane of this process, planes_from_below < 0 planes are sent to it from the first
+ * planes of this process. Same for the neighbour above, with the last planes of this process.
+ * The ghost planes are copied as they are. The array is replaced by a new one (new_aligned_array_first_touch),
+ * whose planes are shared between the threads for the first touch, not the tiles of the Yee kernels.
+ */
+template<typename T>
+void migrate_planes_along_z(T *&array, size_t plane_size, size_t nbr_planes, size_t ghost_planes,
+                            long planes_from_below, long planes_from_above, const int *RankNeighbour)
+{
+    size_t recv_below = planes_from_below > 0 ?  planes_from_below : 0;
+    size_t send_below = planes_from_below < 0 ? -planes_from_below : 0;
+    size_t recv_above = planes_from_above > 0 ?  planes_from_above : 0;
+    size_t send_above = planes_from_above < 0 ? -planes_from_above : 0;
+
+    size_t nbr_owned = nbr_planes - 2 * ghost_planes;
+    if(send_below + send_above > nbr_owned){
+        DISPLAY_ERROR_ABORT(
+            "Cannot send %zu planes to the neighbours, the array has %zu planes.",
+            send_below + send_above, nbr_owned
+        );
+    }
+    size_t nbr_kept = nbr_owned - send_below - send_above;
+
+    size_t new_size[3] = {plane_size, 1, nbr_planes + recv_below + recv_above - send_below - send_above};
+    T *new_array = new_aligned_array_first_touch<T>(new_size);
+
+    T *old_owned = array     + ghost_planes * plane_size;
+    T *new_owned = new_array + ghost_planes * plane_size;
+
+    /// Ghost planes and planes staying on this process:
+    if(ghost_planes > 0){
+        memcpy(new_array,array,ghost_planes * plane_size * sizeof(T));
+        memcpy(new_owned + (recv_below + nbr_kept + recv_above) * plane_size,
+               old_owned + nbr_owned * plane_size,
+               ghost_planes * plane_size * sizeof(T));
+    }
+    memcpy(new_owned + recv_below * plane_size,
+           old_owned + send_below * plane_size,
+           nbr_kept * plane_size * sizeof(T));
+
+    /// Planes moved to or from the neighbours, received in place:
+    MPI_Datatype plane;
+    MPI_Type_contiguous(plane_size * sizeof(T),MPI_BYTE,&plane);
+    MPI_Type_commit(&plane);
+
+    MPI_Request requests[4];
+    int nbr_requests = 0;
+    if(recv_below > 0){
+        MPI_Irecv(new_owned,recv_below,plane,RankNeighbour[4],
+            TAG_MIGRATE_PLANES,MPI_COMM_WORLD,&requests[nbr_requests++]);
+    }
+    if(recv_above > 0){
+        MPI_Irecv(new_owned + (recv_below + nbr_kept) * plane_size,recv_above,plane,RankNeighbour[5],
+            TAG_MIGRATE_PLANES,MPI_COMM_WORLD,&requests[nbr_requests++]);
+    }
+    if(send_below > 0){
+        MPI_Isend(old_owned,send_below,plane,RankNeighbour[4],
+            TAG_MIGRATE_PLANES,MPI_COMM_WORLD,&requests[nbr_requests++]);
+    }
+    if(send_above > 0){
+        MPI_Isend(old_owned + (nbr_owned - send_above) * plane_size,send_above,plane,RankNeighbour[5],
+            TAG_MIGRATE_PLANES,MPI_COMM_WORLD,&requests[nbr_requests++]);
+    }
+    MPI_Waitall(nbr_requests,requests,MPI_STATUSES_IGNORE);
+    MPI_Type_free(&plane);
+
+    delete_aligned_array(array);
+    array = new_array;
+}
+
+
 #endif
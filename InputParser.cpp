@@ -145,6 +145,7 @@ stringDollar_Header2 InputParser::hashit_Header2 (std::string const& inString) {
 	if (inString == "MATERIALS") 			 return MATERIALS;
 	if (inString == "ORIGINS")   			 return ORIGINS;
 	if (inString == "PROBING_POINTS")        return PROBING_POINTS;
+	if (inString == "ELECTRO_SOLVER")        return ELECTRO_SOLVER;
 	else {
 		printf("In file %s at %d. Complain to Romin. Abort().\n",__FILE__,__LINE__);
 		cout << "Faulty string is ::" + inString + "::" << endl;
@@ -1271,6 +1272,31 @@ void InputParser::readHeader_RUN_INFOS(ifstream &file){
 					}else if(propName == "SAMPLING_FREQ_THERMAL"){
 						this->SAMPLING_FREQ_THERMAL = std::stol(propGiven);
 
+					}else if(propName == "OUTPUT_FORMAT"){
+						/// PVTI (one .vti per process and a .pvti) or MPI_IO (one .vti per step, written collectively):
+						if(propGiven == "PVTI" || propGiven == "MPI_IO"){
+							this->OUTPUT_FORMAT = propGiven;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$OUTPUT_SAVING :: OUTPUT_FORMAT must be PVTI or MPI_IO (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "OUTPUT_QUEUE_SIZE"){
+						/// Number of snapshots waiting for the output thread (0 means synchronous outputs):
+						this->OUTPUT_QUEUE_SIZE = std::stol(propGiven);
+
+					}else if(propName == "COMPRESSION_LEVEL"){
+						/// zlib compression level of the output files (0 to 9):
+						this->OUTPUT_COMPRESSION_LEVEL = std::stoi(propGiven);
+						if(this->OUTPUT_COMPRESSION_LEVEL < 0 || this->OUTPUT_COMPRESSION_LEVEL > 9){
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$OUTPUT_SAVING :: COMPRESSION_LEVEL must be between 0 and 9 (has %s).",
+								propGiven.c_str()
+							);
+						}
+
 					}else{
 						printf("InputParser::readHeader_RUN_INFOS:: You didn't provide a ");
 						printf("good member for $RUN_INFOS$TEMP_INIT.\nAborting.\n");
@@ -1281,7 +1307,188 @@ void InputParser::readHeader_RUN_INFOS(ifstream &file){
 				}
 				break;
 
-			
+			case ELECTRO_SOLVER:
+				// Read the options of the electromagnetic solver:
+				while(!file.eof()){
+					// Note: sections are ended by $the-section-name.
+					// Read line:
+					getline(file,currentLine);
+					// Get rid of comments:
+					this->checkLineISNotComment(file,currentLine);
+					// Remove any blank in the string:
+					this->RemoveAnyBlankSpaceInStr(currentLine);
+					// If the string is "$ELECTRO_SOLVER" it means the section ends.
+					if(currentLine == "$ELECTRO_SOLVER"){
+						break;
+					}
+					// If the string is empty, it was just a white space. Continue.
+					if(currentLine == string()){continue;}
+					// Find the position of the equal sign:
+					std::size_t posEqual  = currentLine.find("=");
+					// The property we want to set:
+					std::string propName  = currentLine.substr(0,posEqual);
+					// The property name the user gave:
+					std::string propGiven = currentLine.substr(posEqual+1,currentLine.length());
+
+					if(propName == "COEFFICIENTS"){
+						/// Either one coefficient per node, or one coefficient per material:
+						if(propGiven == "PER_MATERIAL"){
+							this->ELECTRO_COEFFICIENTS_PER_MATERIAL = true;
+						}else if(propGiven == "PER_NODE"){
+							this->ELECTRO_COEFFICIENTS_PER_MATERIAL = false;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: COEFFICIENTS must be"
+								" PER_NODE or PER_MATERIAL (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "TILE_SIZE_X"){
+						/// Size of the tiles of the H and E updates (0 means the whole subdomain):
+						this->ELECTRO_TILE_SIZE[0] = std::stol(propGiven);
+
+					}else if(propName == "TILE_SIZE_Y"){
+						this->ELECTRO_TILE_SIZE[1] = std::stol(propGiven);
+
+					}else if(propName == "TILE_SIZE_Z"){
+						this->ELECTRO_TILE_SIZE[2] = std::stol(propGiven);
+
+					}else if(propName == "SIMD"){
+						/// Instruction set of the Yee kernels (AUTO chooses the best one supported by the CPU):
+						if(    propGiven == "AUTO" || propGiven == "SCALAR"
+							|| propGiven == "AVX2" || propGiven == "AVX512"){
+							this->ELECTRO_SIMD = propGiven;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: SIMD must be AUTO, SCALAR,"
+								" AVX2 or AVX512 (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "PRECISION"){
+						/// Storage of the fields: DOUBLE, FLOAT, or MIXED (float fields, update computed in double):
+						if(    propGiven == "DOUBLE" || propGiven == "FLOAT"
+							|| propGiven == "MIXED"){
+							this->ELECTRO_PRECISION = propGiven;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: PRECISION must be DOUBLE, FLOAT"
+								" or MIXED (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "SYNCHRONISATION"){
+						/// Synchronisation of the threads: BARRIERS (team barriers) or NEIGHBOURS (slab pipeline):
+						if(propGiven == "BARRIERS" || propGiven == "NEIGHBOURS"){
+							this->ELECTRO_SYNCHRONISATION = propGiven;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: SYNCHRONISATION must be BARRIERS"
+								" or NEIGHBOURS (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "TEMPORAL_BLOCKING_DEPTH"){
+						/// Number of steps done plane by plane before moving on (1 means no temporal blocking):
+						this->ELECTRO_TEMPORAL_BLOCKING_DEPTH = std::stol(propGiven);
+						if(this->ELECTRO_TEMPORAL_BLOCKING_DEPTH == 0){
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: TEMPORAL_BLOCKING_DEPTH must be at least 1."
+							);
+						}
+
+					}else if(propName == "LOAD_BALANCING"){
+						/// Division of the grid between the MPI processes: NODES (same number of nodes) or COST:
+						if(propGiven == "NODES" || propGiven == "COST"){
+							this->ELECTRO_LOAD_BALANCING = propGiven;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: LOAD_BALANCING must be NODES"
+								" or COST (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "COST_ABC_NODE"){
+						/// Cost of a node of the ABC, relative to the update of one node:
+						this->ELECTRO_COST_ABC_NODE = std::stod(propGiven);
+						if(this->ELECTRO_COST_ABC_NODE < 0){
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: COST_ABC_NODE must be positive (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "COST_SOURCE_NODE"){
+						/// Cost of a node imposed by a source, relative to the update of one node:
+						this->ELECTRO_COST_SOURCE_NODE = std::stod(propGiven);
+						if(this->ELECTRO_COST_SOURCE_NODE < 0){
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: COST_SOURCE_NODE must be positive (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "HALO_EXCHANGE"){
+						/// Halos of the neighbours of the same node: SHARED_MEMORY (copied from their fields) or MESSAGES:
+						if(propGiven == "SHARED_MEMORY" || propGiven == "MESSAGES"){
+							this->ELECTRO_HALO_EXCHANGE = propGiven;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: HALO_EXCHANGE must be SHARED_MEMORY"
+								" or MESSAGES (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "REBALANCING_PERIOD"){
+						/// Number of steps between two rebalancings of the planes along Z (0 means never):
+						this->ELECTRO_REBALANCING_PERIOD = std::stol(propGiven);
+
+					}else if(propName == "REBALANCING_THRESHOLD"){
+						/// Ratio between the slowest layer of processes and the mean above which planes are moved:
+						this->ELECTRO_REBALANCING_THRESHOLD = std::stod(propGiven);
+						if(this->ELECTRO_REBALANCING_THRESHOLD < 1){
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: REBALANCING_THRESHOLD must be at least 1 (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else if(propName == "GHOST_LAYERS"){
+						/// Number of ghost layers, the halos being exchanged once every GHOST_LAYERS steps:
+						this->ELECTRO_GHOST_LAYERS = std::stol(propGiven);
+						if(this->ELECTRO_GHOST_LAYERS == 0){
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: GHOST_LAYERS must be at least 1."
+							);
+						}
+
+					}else if(propName == "HALO_THREADS"){
+						/// Threads driving the messages of the halos: PER_FACE (faces shared by the threads) or MASTER:
+						if(propGiven == "PER_FACE" || propGiven == "MASTER"){
+							this->ELECTRO_HALO_THREADS = propGiven;
+						}else{
+							DISPLAY_ERROR_ABORT(
+								"$RUN_INFOS$ELECTRO_SOLVER :: HALO_THREADS must be PER_FACE"
+								" or MASTER (has %s).",
+								propGiven.c_str()
+							);
+						}
+
+					}else{
+						DISPLAY_ERROR_ABORT(
+							"In $RUN_INFOS$ELECTRO_SOLVER :: no property corresponds to %s.",
+							propName.c_str()
+						);
+					}
+				}
+				break;
+
 			case BOUNDARY_CONDITIONS:
 				// Read the given boundary conditions:
 				while(!file.eof()){
@@ -44,7 +44,8 @@ enum stringDollar_Header2{
 	BOUNDARY_CONDITIONS,
 	MATERIALS,
 	ORIGINS,
-	PROBING_POINTS
+	PROBING_POINTS,
+	ELECTRO_SOLVER
 };
 
 class InputParser{
@@ -112,6 +113,53 @@ class InputParser{
 		size_t SAMPLING_FREQ_ELECTRO = 0;
 		// Sampling frequency for the thermal algorithm:
 		size_t SAMPLING_FREQ_THERMAL = 0;
+		// Format of the output files: PVTI (each MPI process writes its .vti, and the root process a .pvti
+		// listing them) or MPI_IO (one .vti per step, written by all the processes with collective MPI-IO):
+		std::string OUTPUT_FORMAT = "PVTI";
+		// Number of snapshots of the fields which can wait to be written by the output thread, while the
+		// solver goes on (0 means the files are written by the solver, which waits for them):
+		size_t OUTPUT_QUEUE_SIZE = 2;
+		// zlib compression level of the output files, from 0 (no compression, fastest) to 9 (smallest files):
+		int OUTPUT_COMPRESSION_LEVEL = 6;
+
+		/// Options of the electromagnetic solver ($RUN_INFOS$ELECTRO_SOLVER):
+		// Store the update coefficients per material instead of per node:
+		bool ELECTRO_COEFFICIENTS_PER_MATERIAL = false;
+		// Size of the tiles (X,Y,Z) of the H and E updates. 0 means no tiling in this direction,
+		// and no tiling at all if the three sizes are 0:
+		size_t ELECTRO_TILE_SIZE[3] = {0,16,16};
+		// Number of steps done plane by plane, with a wavefront (1 means no temporal blocking):
+		size_t ELECTRO_TEMPORAL_BLOCKING_DEPTH = 1;
+		// Instruction set of the Yee kernels (AUTO, SCALAR, AVX2 or AVX512):
+		std::string ELECTRO_SIMD = "AUTO";
+		// Storage of the electromagnetic fields: DOUBLE, FLOAT, or MIXED (float fields, double coefficients,
+		// the update is computed in double):
+		std::string ELECTRO_PRECISION = "DOUBLE";
+		// Synchronisation of the OpenMP threads during the update: BARRIERS (team barriers), or NEIGHBOURS
+		// (each thread owns a slab of planes and only waits for the slabs next to it):
+		std::string ELECTRO_SYNCHRONISATION = "BARRIERS";
+		// Division of the electromagnetic grid between the MPI processes: NODES (same number of nodes),
+		// or COST (same estimated cost per step, see ELECTRO_COST_*):
+		std::string ELECTRO_LOAD_BALANCING = "NODES";
+		// Estimated cost per step of a node of the absorbing boundary conditions, and of a node imposed by
+		// a source, relative to the update of one node by the Yee kernels:
+		double ELECTRO_COST_ABC_NODE    = 1.0;
+		double ELECTRO_COST_SOURCE_NODE = 2.5;
+		// Exchange of the halos with the MPI neighbours of the same node: SHARED_MEMORY (the fields are in
+		// shared memory, the ghost planes are copied from the neighbour's fields) or MESSAGES:
+		std::string ELECTRO_HALO_EXCHANGE = "SHARED_MEMORY";
+		// Number of steps between two rebalancings of the planes along Z between the MPI processes,
+		// from the measured compute time of each process (0 means never):
+		size_t ELECTRO_REBALANCING_PERIOD    = 0;
+		// The planes are moved if the slowest layer of processes along Z is slower than the mean by this ratio:
+		double ELECTRO_REBALANCING_THRESHOLD = 1.1;
+		// Number of ghost layers on the faces with an MPI neighbour. The halos are exchanged once every
+		// ELECTRO_GHOST_LAYERS steps, the ghost layers being updated by this process in between (1 means
+		// an exchange at each half step):
+		size_t ELECTRO_GHOST_LAYERS = 1;
+		// OpenMP threads exchanging the halos with messages: PER_FACE (the faces are shared between the
+		// threads, each one starting and waiting for the messages of its faces) or MASTER (master thread only):
+		std::string ELECTRO_HALO_THREADS = "PER_FACE";
 
 		// Dictionary for delete operations before computing anything:
 		map<std::string,bool> removeWhat_dico;
@@ -270,6 +270,17 @@ std::vector<std::string> get_folder_from_name(std::string outputName){
     return returned_folder_name;
 }
 
+/**
+ * @brief This function creates the given folder if it does not exist, without going into it.
+ */
+void create_folder(std::string folderName){
+    #if defined(_WIN32)
+        _mkdir(folderName.c_str());
+    #else
+        mkdir(folderName.c_str(), 0700);
+    #endif
+}
+
 /**
  * @brief This function creates the gien folder and goes into it (changes the current working directory).
  * 
@@ -341,6 +352,52 @@ void InterfaceToParaviewer::convertAndWriteData(unsigned long currentStep,
 
     outputName = folderAndFileNames[1];
 
+    /// Asynchronous outputs: the fields are copied into a free snapshot, and the output thread writes it
+    /// while the solver goes on. The output thread does not change the working directory, the folder is
+    /// part of the name of the files.
+    if(!this->snapshots.empty() && (type == "THERMAL" || type == "ELECTRO")){
+        FieldsSnapshot *snapshot;
+        {
+            /// If all the snapshots are still to be written, wait for the output thread:
+            std::unique_lock<std::mutex> lock(this->snapshots_mutex);
+            this->snapshots_changed.wait(lock,[this]{return !this->free_snapshots.empty();});
+            snapshot = this->free_snapshots.front();
+            this->free_snapshots.pop_front();
+        }
+
+        bool is_electro = type == "ELECTRO";
+
+        snapshot->currentStep = currentStep;
+        snapshot->type        = type;
+        snapshot->outputName  = outputName;
+        if(folderAndFileNames[0] != std::string()){
+            create_folder(folderAndFileNames[0]);
+            snapshot->outputName = folderAndFileNames[0] + "/" + outputName;
+        }
+        snapshot->grid      = is_electro ? this->grid_Electro   : this->grid_Thermal;
+        snapshot->my_grid   = is_electro ? this->mygrid_Electro : this->mygrid_Thermal;
+        snapshot->sub_grids = is_electro ? this->sgrids_Electro : this->sgrids_Thermal;
+
+        std::map<std::string,std::vector<double> *> &fields =
+            is_electro ? snapshot->my_grid.vectors : snapshot->my_grid.scalars;
+        snapshot->fields.resize(fields.size());
+        size_t a = 0;
+        for(auto it = fields.begin() ; it != fields.end() ; ++it, ++a){
+            vtl::fill_buffer_custom_GridCreatorNew(
+                            this->grid_Creator_NEW,
+                            it->first,
+                            is_electro ? 'v' : 's',
+                            snapshot->fields[a]);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->snapshots_mutex);
+            this->snapshots_to_write.push_back(snapshot);
+        }
+        this->snapshots_changed.notify_all();
+        return;
+    }
+
     // Will contain the current folder:
     std::string parentFolder = string();
 
@@ -350,7 +407,21 @@ void InterfaceToParaviewer::convertAndWriteData(unsigned long currentStep,
     }
 
     /* DETERMINE WHICH GRID TO SAVE */
-    if(strcmp(type.c_str(),"THERMAL") == 0){
+    /// With OUTPUT_FORMAT=MPI_IO, all the MPI processes write a single file for the whole grid:
+    bool single_file = this->grid_Creator_NEW.input_parser.OUTPUT_FORMAT == "MPI_IO";
+
+    if(strcmp(type.c_str(),"THERMAL") == 0 && single_file){
+        /* SAVE THERMAL GRID IN A SINGLE FILE */
+        export_spoints_XML_MPIIO_custom_GridCreator_NEW(
+                        "THERMAL",
+                        outputName,
+                        currentStep,
+                        this->grid_Thermal,
+                        this->mygrid_Thermal,
+                        this->grid_Creator_NEW,
+                        this->output_comm);
+
+    }else if(strcmp(type.c_str(),"THERMAL") == 0){
         /* SAVE THERMAL GRID */
 
         export_spoints_XML_custom_GridCreator_NEW(
@@ -378,6 +449,17 @@ void InterfaceToParaviewer::convertAndWriteData(unsigned long currentStep,
         }
 
         /* END OF THERMAL GRID SAVING */
+    }else if(strcmp(type.c_str(),"ELECTRO") == 0 && single_file){
+        /* SAVE ELECTROMAGNETIC GRID IN A SINGLE FILE */
+        export_spoints_XML_MPIIO_custom_GridCreator_NEW(
+                        "ELECTRO",
+                        outputName,
+                        currentStep,
+                        this->grid_Electro,
+                        this->mygrid_Electro,
+                        this->grid_Creator_NEW,
+                        this->output_comm);
+
     }else if(strcmp(type.c_str(),"ELECTRO") == 0){
         /* SAVE ELECTROMAGNETIC GRID */
             
@@ -425,4 +507,140 @@ void InterfaceToParaviewer::convertAndWriteData(unsigned long currentStep,
             abort();
         #endif
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Start the output thread, which writes the snapshots taken by convertAndWriteData.
+ *
+ * OUTPUT_QUEUE_SIZE snapshots are allocated: the solver waits for the output thread when all of
+ * them are still to be written. Nothing is started if OUTPUT_QUEUE_SIZE is 0 (the files are
+ * written by convertAndWriteData).
+ * With OUTPUT_FORMAT=MPI_IO, the output thread makes MPI calls while the solver makes its own, which
+ * needs MPI_THREAD_MULTIPLE: without it, the files are written by convertAndWriteData too.
+ */
+void InterfaceToParaviewer::initializeOutputThread(void){
+
+    size_t queue_size = this->grid_Creator_NEW.input_parser.OUTPUT_QUEUE_SIZE;
+    bool   single_file = this->grid_Creator_NEW.input_parser.OUTPUT_FORMAT == "MPI_IO";
+    if(queue_size > 0 && single_file
+            && this->MPI_communicator.get_provided_thread_support() != MPI_THREAD_MULTIPLE){
+        if(this->MPI_communicator.isRootProcess() != INT_MIN){
+            DISPLAY_WARNING(
+                "OUTPUT_FORMAT=MPI_IO with OUTPUT_QUEUE_SIZE > 0 needs MPI_THREAD_MULTIPLE."
+                " The files are written by the solver (OUTPUT_QUEUE_SIZE=0).\n"
+            );
+        }
+        queue_size = 0;
+    }
+    if(queue_size == 0){
+        return;
+    }
+
+    /// The collective operations of the output thread get their own communicator:
+    if(single_file){
+        MPI_Comm_dup(MPI_COMM_WORLD,&this->output_comm);
+    }
+
+    this->snapshots.resize(queue_size);
+    for(size_t it = 0 ; it < queue_size ; it ++){
+        this->free_snapshots.push_back(&this->snapshots[it]);
+    }
+
+    this->output_thread = std::thread(&InterfaceToParaviewer::writeSnapshots,this);
+}
+
+/**
+ * @brief Loop of the output thread: writes the snapshots in the order they were taken, and gives
+ *        them back once written. Stops when asked to and all the snapshots are written.
+ */
+void InterfaceToParaviewer::writeSnapshots(void){
+    while(true){
+        FieldsSnapshot *snapshot;
+        {
+            std::unique_lock<std::mutex> lock(this->snapshots_mutex);
+            this->snapshots_changed.wait(lock,[this]{
+                return this->stop_output_thread || !this->snapshots_to_write.empty();
+            });
+            if(this->snapshots_to_write.empty()){
+                return;
+            }
+            snapshot = this->snapshots_to_write.front();
+        }
+
+        this->writeSnapshot(*snapshot);
+
+        {
+            std::lock_guard<std::mutex> lock(this->snapshots_mutex);
+            this->snapshots_to_write.pop_front();
+            this->free_snapshots.push_back(snapshot);
+        }
+        this->snapshots_changed.notify_all();
+    }
+}
+
+/**
+ * @brief Write the files of a snapshot, as convertAndWriteData does with the fields of the grid.
+ */
+void InterfaceToParaviewer::writeSnapshot(FieldsSnapshot &snapshot){
+
+    if(this->grid_Creator_NEW.input_parser.OUTPUT_FORMAT == "MPI_IO"){
+        export_spoints_XML_MPIIO_custom_GridCreator_NEW(
+                        snapshot.type,
+                        snapshot.outputName,
+                        snapshot.currentStep,
+                        snapshot.grid,
+                        snapshot.my_grid,
+                        this->grid_Creator_NEW,
+                        this->output_comm,
+                        &snapshot.fields);
+        return;
+    }
+
+    export_spoints_XML_custom_GridCreator_NEW(
+                    snapshot.type,
+                    snapshot.outputName,
+                    snapshot.currentStep,
+                    snapshot.grid,
+                    snapshot.my_grid,
+                    this->grid_Creator_NEW,
+                    vtl::ZIPPED,
+                    &snapshot.fields);
+
+    /* ONLY THE ROOT PROCESS WRITES THE .PVTI FILE */
+    if (this->MPI_communicator.isRootProcess() == this->MPI_communicator.rootProcess)
+    {
+        export_spoints_XMLP_custom_GridCreator_NEW(
+                        snapshot.type,
+                        snapshot.outputName,
+                        snapshot.currentStep,
+                        snapshot.grid,
+                        snapshot.my_grid,
+                        snapshot.sub_grids,
+                        vtl::ZIPPED);
+    }
+}
+
+/**
+ * @brief Wait until the output thread has written all the snapshots taken so far.
+ */
+void InterfaceToParaviewer::waitForOutputs(void){
+    std::unique_lock<std::mutex> lock(this->snapshots_mutex);
+    this->snapshots_changed.wait(lock,[this]{return this->snapshots_to_write.empty();});
+}
+
+/**
+ * @brief Destructor: the output thread writes the last snapshots before stopping.
+ */
+InterfaceToParaviewer::~InterfaceToParaviewer(void){
+    if(this->output_thread.joinable()){
+        {
+            std::lock_guard<std::mutex> lock(this->snapshots_mutex);
+            this->stop_output_thread = true;
+        }
+        this->snapshots_changed.notify_all();
+        this->output_thread.join();
+    }
+    if(this->output_comm != MPI_COMM_WORLD){
+        MPI_Comm_free(&this->output_comm);
+    }
+}
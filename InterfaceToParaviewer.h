@@ -8,6 +8,28 @@
 #include "Array_3D_Template.h"
 
 #include <cstring>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief Copy of the fields of this MPI process at an output step, written to the files by the output
+ *        thread of InterfaceToParaviewer while the solver goes on.
+ */
+struct FieldsSnapshot{
+    unsigned long currentStep;
+    /// "THERMAL" or "ELECTRO", and name of the output files (with their folder):
+    std::string type;
+    std::string outputName;
+    /// Grids at the time of the snapshot (the subgrids are only known by the root process):
+    vtl::SPoints grid;
+    vtl::SPoints my_grid;
+    std::vector<vtl::SPoints> sub_grids;
+    /// Nodes of each field, in the order of my_grid.vectors or my_grid.scalars
+    /// (see vtl::fill_buffer_custom_GridCreatorNew):
+    std::vector<std::vector<float> > fields;
+};
 
 class InterfaceToParaviewer{
     private:
@@ -35,6 +57,29 @@ class InterfaceToParaviewer{
         // My thermal grid:
         vtl::SPoints mygrid_Thermal;
 
+        // Communicator of the output files written with MPI-IO (OUTPUT_FORMAT=MPI_IO). The output thread
+        // gets a duplicate, so that its collective operations never mix with the ones of the solver:
+        MPI_Comm output_comm = MPI_COMM_WORLD;
+
+        // Asynchronous outputs (OUTPUT_QUEUE_SIZE > 0): the snapshots are filled by convertAndWriteData,
+        // then written by output_thread. The free ones can be filled, the others wait to be written.
+        std::vector<FieldsSnapshot> snapshots;
+        std::deque<FieldsSnapshot *> free_snapshots;
+        std::deque<FieldsSnapshot *> snapshots_to_write;
+        std::mutex                   snapshots_mutex;
+        std::condition_variable      snapshots_changed;
+        std::thread                  output_thread;
+        bool                         stop_output_thread = false;
+
+        // Start the output thread (if OUTPUT_QUEUE_SIZE > 0):
+        void initializeOutputThread(void);
+
+        // Loop of the output thread, writing the snapshots in order:
+        void writeSnapshots(void);
+
+        // Write the files of a snapshot:
+        void writeSnapshot(FieldsSnapshot &snapshot);
+
     public:
         // Default constructor:
         InterfaceToParaviewer(MPI_Initializer &MPI_communicator,
@@ -43,9 +88,10 @@ class InterfaceToParaviewer{
                             MPI_communicator(MPI_communicator)
                             {
                                 this->initializeAll();
+                                this->initializeOutputThread();
                             };
-        // Default destructor:
-        ~InterfaceToParaviewer(void){};
+        // Default destructor (waits for the outputs still to be written):
+        ~InterfaceToParaviewer(void);
 
         // Initilize everything:
         void initializeAll(void);
@@ -53,6 +99,9 @@ class InterfaceToParaviewer{
         // Convert and write output:
         void convertAndWriteData(unsigned long currentStep,
                 std::string type /*"thermal" or "electro", case sensitive*/);
+
+        // Wait until all the snapshots have been written:
+        void waitForOutputs(void);
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "MPI_Initializer.h"
 #include "header_with_all_defines.hpp"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 // Constructor:
 MPI_Initializer::MPI_Initializer(int argc, char *argv[],int required){
@@ -78,6 +80,119 @@ int MPI_Initializer::getRank(void){
 
 
 
+/**
+ * @brief Estimated cost of one step for each plane of nodes orthogonal to the direction DIR of the
+ *        whole electromagnetic grid (cost_of_plane has nbr_nodes[DIR] elements).
+ *
+ * The unit is the update of one node by the Yee kernels, which is the same for all the materials.
+ * A node of the absorbing boundary conditions costs COST_ABC_NODE, and a node imposed by a source
+ * costs COST_SOURCE_NODE more (bounding box of each source, see is_inside_source_Romin).
+ */
+static void estimate_cost_of_planes(GridCreator_NEW &subGrid, const size_t *nbr_nodes, unsigned int DIR,
+									std::vector<double> &cost_of_plane)
+{
+	unsigned int DIR_A = (DIR + 1) % 3;
+	unsigned int DIR_B = (DIR + 2) % 3;
+
+	double cost_abc_node    = subGrid.input_parser.ELECTRO_COST_ABC_NODE;
+	double cost_source_node = subGrid.input_parser.ELECTRO_COST_SOURCE_NODE;
+
+	cost_of_plane.assign(nbr_nodes[DIR],0.0);
+
+	/// Yee update of the nodes of the plane, and nodes of the ABC on the faces crossing the plane:
+	double nodes_in_plane = (double) nbr_nodes[DIR_A] * nbr_nodes[DIR_B];
+	double abc_in_plane   = 2.0 * nbr_nodes[DIR_A] + 2.0 * nbr_nodes[DIR_B];
+
+	for(size_t I = 0 ; I < nbr_nodes[DIR] ; I ++){
+		cost_of_plane[I] = nodes_in_plane + cost_abc_node * abc_in_plane;
+	}
+	/// The faces of the ABC orthogonal to DIR:
+	cost_of_plane[0]                += cost_abc_node * nodes_in_plane;
+	cost_of_plane[nbr_nodes[DIR]-1] += cost_abc_node * nodes_in_plane;
+
+	/// Nodes imposed by the sources:
+	double deltas[3] = {
+		subGrid.input_parser.deltaX_Electro,
+		subGrid.input_parser.deltaY_Electro,
+		subGrid.input_parser.deltaZ_Electro
+	};
+
+	ElectromagneticSource &source = subGrid.input_parser.source;
+
+	for(unsigned int id = 0 ; id < source.get_number_of_sources() ; id ++){
+
+		double center[3];
+		source.getCenter(id,center);
+
+		double half_length[3] = {source.lengthX[id]/2.,source.lengthY[id]/2.,source.lengthZ[id]/2.};
+
+		if(subGrid.input_parser.conditionsInsideSources[id] == "DIPOLE"){
+			double lambda  = 3E8 / source.frequency[id];
+			half_length[0] = lambda/8.;
+			half_length[1] = lambda/8.;
+			half_length[2] = lambda/4. + deltas[2]/2.;
+		}
+
+		/// Global indices of the first and last nodes inside the source, along each direction:
+		long first[3];
+		long last [3];
+		for(unsigned int D = 0 ; D < 3 ; D ++){
+			double EPS    = deltas[0]*1E-5;
+			double origin = subGrid.input_parser.origin_Electro_grid[D];
+			first[D] = (long) ceil ((center[D] - half_length[D] - origin - EPS) / deltas[D]);
+			last [D] = (long) floor((center[D] + half_length[D] - origin + EPS) / deltas[D]);
+			first[D] = std::max(first[D],0L);
+			last [D] = std::min(last [D],(long) nbr_nodes[D] - 1);
+		}
+		if(first[0] > last[0] || first[1] > last[1] || first[2] > last[2]){continue;}
+
+		double source_nodes_in_plane = (double) (last[DIR_A] - first[DIR_A] + 1)
+											  * (last[DIR_B] - first[DIR_B] + 1);
+
+		for(long I = first[DIR] ; I <= last[DIR] ; I ++){
+			cost_of_plane[I] += cost_source_node * source_nodes_in_plane;
+		}
+	}
+}
+
+/**
+ * @brief Cut the planes 0 to cost_of_plane.size()-1 in nbr_parts parts of (nearly) equal cost.
+ *
+ * The part P has the planes first_plane[P] to first_plane[P+1]-1 (first_plane has nbr_parts+1 elements),
+ * and at least one plane.
+ */
+static void cut_planes_with_equal_cost(const std::vector<double> &cost_of_plane, size_t nbr_parts,
+										std::vector<size_t> &first_plane)
+{
+	size_t nbr_planes = cost_of_plane.size();
+
+	/// cost_before[I] is the cost of the planes 0 to I-1:
+	std::vector<double> cost_before(nbr_planes+1,0.0);
+	for(size_t I = 0 ; I < nbr_planes ; I ++){
+		cost_before[I+1] = cost_before[I] + cost_of_plane[I];
+	}
+
+	first_plane.assign(nbr_parts+1,0);
+	first_plane[nbr_parts] = nbr_planes;
+
+	size_t I = 0;
+	for(size_t P = 1 ; P < nbr_parts ; P ++){
+		double target = cost_before[nbr_planes] * P / nbr_parts;
+
+		/// First cut with at least the target cost before it, or the one before if it is closer:
+		while(I < nbr_planes && cost_before[I] < target){I ++;}
+		size_t cut = I;
+		if(cut > 0 && target - cost_before[cut-1] < cost_before[cut] - target){
+			cut --;
+		}
+		/// At least one plane per part:
+		cut = std::max(cut,first_plane[P-1] + 1);
+		cut = std::min(cut,nbr_planes - (nbr_parts - P));
+
+		first_plane[P] = cut;
+	}
+}
+
 void MPI_Initializer::MPI_DIVISION(GridCreator_NEW & subGrid){
 	
 	// Retrieve the number of MPI proceses and the ID of the current MPI process:
@@ -111,8 +226,6 @@ void MPI_Initializer::MPI_DIVISION(GridCreator_NEW & subGrid){
 	size_t nbr_nodes_thermal_Z = Lz_thermal / delta_thermal + 1;
 
 
-	int N = (int) pow(nbProc, 1.0/3.0);
-
 	/* 
 	 * RankNeighbour[0] = SOUTH (along the opposite direction of the x-axis)
 	 * RankNeighbour[1] = NORTH (along the direction of the x-axis)
@@ -122,418 +235,154 @@ void MPI_Initializer::MPI_DIVISION(GridCreator_NEW & subGrid){
 	 * RankNeighbour[5] = UP (along the direction of the z-axis) 
 	 */
 
-
-	// Cubic case
-	if(N*N*N == nbProc){
-
-		/* myRank%N gives the current position on the x-axis */
-		/* (((int)(myRank/N) - (int) (myRank/(N*N))*N )) gives the current position on the y-axis */
-		/* myRank/ (N*N) gives the current position on the z-axis */
-
-		int PositionOnX = myRank%N;
-		int PositionOnY = (((int)(myRank/N) - (int) (myRank/(N*N))*N ));
-		int PositionOnZ = myRank/ (N*N);
-
-		subGrid.MPI_communicator.MPI_POSITION[0] = (char) PositionOnX;
-		subGrid.MPI_communicator.MPI_POSITION[1] = (char) PositionOnY;
-		subGrid.MPI_communicator.MPI_POSITION[2] = (char) PositionOnZ;
-
-		/// In the following, you must do (nbProc-1) because MPI rank starts at zero !
-		subGrid.MPI_communicator.MPI_MAX_POSI[0] = (char) ( (nbProc-1) % N );
-		subGrid.MPI_communicator.MPI_MAX_POSI[1] = (char) ( (int) ( (nbProc-1) / N) 
-																- (int) ( (nbProc-1) / (N*N) ) * N );
-		subGrid.MPI_communicator.MPI_MAX_POSI[2] = (char) ( (nbProc-1) / (N*N));
-
-		size_t nbr_nodes_local_X         = nbr_nodes_X / N;
-		size_t nbr_nodes_local_thermal_X = nbr_nodes_thermal_X / N;
-
-		if(nbr_nodes_local_X * N != nbr_nodes_X){
-			/// If I am the last MPI, I take the remainder of the 'not perfect' division.
-			if(PositionOnX == N-1){
-				subGrid.sizes_EH[0] = nbr_nodes_local_X + 
-					(-nbr_nodes_local_X * N + nbr_nodes_X);
-			}else{
-				subGrid.sizes_EH[0] = nbr_nodes_local_X;
-			}
-		}else{
-			subGrid.sizes_EH[0] = nbr_nodes_local_X;
-		}
-
-		if(nbr_nodes_local_thermal_X * N != nbr_nodes_thermal_X){
-			if(PositionOnX == N-1){
-				subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X +
-						(-nbr_nodes_local_thermal_X * N + nbr_nodes_thermal_X);
-			}else{
-				subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X;
-			}
-		}else{
-			subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X;
-		}
-
-		size_t nbr_nodes_local_Y         = nbr_nodes_Y / N;
-		size_t nbr_nodes_local_thermal_Y = nbr_nodes_thermal_Y / N;
-
-		if(nbr_nodes_local_Y * N != nbr_nodes_Y){
-			if(PositionOnY == N-1){
-				subGrid.sizes_EH[1] = nbr_nodes_local_Y + 
-					(-nbr_nodes_local_Y * N + nbr_nodes_Y);
-			}else{
-				subGrid.sizes_EH[1] = nbr_nodes_local_Y;
-			}
-		}else{
-			subGrid.sizes_EH[1] = nbr_nodes_local_Y;
-		}
-
-		if(nbr_nodes_local_thermal_Y * N != nbr_nodes_thermal_Y){
-			if(PositionOnY == N-1){
-				subGrid.size_Thermal[1] = nbr_nodes_local_thermal_Y +
-						(-nbr_nodes_local_thermal_Y * N + nbr_nodes_thermal_Y);
-			}else{
-				subGrid.size_Thermal[1] = nbr_nodes_local_thermal_Y;
-			}
-		}else{
-			subGrid.size_Thermal[1] = nbr_nodes_local_thermal_Y;
-		}
-
-		size_t nbr_nodes_local_Z         = nbr_nodes_Z / N;
-		size_t nbr_nodes_local_thermal_Z = nbr_nodes_thermal_Z / N;
-
-		if(nbr_nodes_local_Z * N != nbr_nodes_Z){
-			if(PositionOnZ == N-1){
-				subGrid.sizes_EH[2] = nbr_nodes_local_Z + 
-					(-nbr_nodes_local_Z * N + nbr_nodes_Z);
-			}else{
-				subGrid.sizes_EH[2] = nbr_nodes_local_Z;
-			}
-		}else{
-			subGrid.sizes_EH[2] = nbr_nodes_local_Z;
-		}
-
-		if(nbr_nodes_local_thermal_Z * N != nbr_nodes_thermal_Z){
-			if(PositionOnZ == N-1){
-				subGrid.size_Thermal[2] = nbr_nodes_local_thermal_Z +
-						(-nbr_nodes_local_thermal_Z * N + nbr_nodes_thermal_Z);
-			}else{
-				subGrid.size_Thermal[2] = nbr_nodes_local_thermal_Z;
-			}
-		}else{
-			subGrid.size_Thermal[2] = nbr_nodes_local_thermal_Z;
-		}
-		
-		// Origin indices for the electromagnetic grid:
-		subGrid.originIndices_Electro[0] = PositionOnX * nbr_nodes_local_X;
-		subGrid.originIndices_Electro[1] = PositionOnY * nbr_nodes_local_Y;
-		subGrid.originIndices_Electro[2] = PositionOnZ * nbr_nodes_local_Z;
-		// Origin indices for the thermal grid:
-		subGrid.originIndices_Thermal[0] = PositionOnX * nbr_nodes_local_thermal_X;
-		subGrid.originIndices_Thermal[1] = PositionOnY * nbr_nodes_local_thermal_Y;
-		subGrid.originIndices_Thermal[2] = PositionOnZ * nbr_nodes_local_thermal_Z;
-
-		if(N == 1)
-		{
-			this->RankNeighbour[0] = -1;
-			this->RankNeighbour[1] = -1;
-			this->RankNeighbour[2] = -1;
-			this->RankNeighbour[3] = -1;
-			this->RankNeighbour[4] = -1;
-			this->RankNeighbour[5] = -1;
-		}
-		else
-		{
-		/* --------------------------------------------------------------------------------------------------- */
-		/* We do the x component */
-			if(PositionOnX == 0)
-			{
-				this->RankNeighbour[0] = myRank+1;
-				this->RankNeighbour[1] = -1;
-			}
-			else if(PositionOnX == N-1)
-			{
-				this->RankNeighbour[0] = -1;
-				this->RankNeighbour[1] = myRank-1;
-			}
-			else
-			{
-				this->RankNeighbour[0] = myRank+1;
-				this->RankNeighbour[1] = myRank-1;
-			}
-
-			/* We do the y component */
-			if(PositionOnY == 0)
-			{
-				this->RankNeighbour[2] = -1;
-				this->RankNeighbour[3] = myRank+N; 
-			}
-			else if(PositionOnY == N-1)
-			{
-				this->RankNeighbour[2] = myRank-N;
-				this->RankNeighbour[3] = -1;
-			}
-			else
-			{
-				this->RankNeighbour[2] = myRank-N;
-				this->RankNeighbour[3] = myRank+N;
-			}
-
-			/* We do the z component */
-			if(PositionOnZ == 0)
-			{
-				this->RankNeighbour[4] = -1;
-				this->RankNeighbour[5] = myRank+N*N;
-			}
-			else if(PositionOnZ == N-1)
-			{
-				this->RankNeighbour[4] = myRank-N*N;
-				this->RankNeighbour[5] = -1;
+	/**
+	 * Number of MPI processes along each direction (any number of MPI processes).
+	 * Among all the products Px*Py*Pz = nbProc, keep the one with the smallest area of the
+	 * faces between MPI processes, i.e. the smallest halos for the same volume per process.
+	 * Each process must have at least one node of the electromagnetic and thermal grids
+	 * along each direction.
+	 */
+	size_t nbr_nodes[3]         = {nbr_nodes_X,nbr_nodes_Y,nbr_nodes_Z};
+	size_t nbr_nodes_thermal[3] = {nbr_nodes_thermal_X,nbr_nodes_thermal_Y,nbr_nodes_thermal_Z};
+
+	int    nbr_MPI_along[3] = {0,0,0};
+	double smallest_area    = -1.0;
+
+	for(int Px = 1 ; Px <= nbProc ; Px ++){
+		if(nbProc % Px != 0){continue;}
+		for(int Py = 1 ; Py <= nbProc / Px ; Py ++){
+			if((nbProc / Px) % Py != 0){continue;}
+			int Pz = nbProc / (Px * Py);
+			int P[3] = {Px,Py,Pz};
+
+			bool enough_nodes = true;
+			for(unsigned int DIR = 0 ; DIR < 3 ; DIR ++){
+				if((size_t) P[DIR] > nbr_nodes[DIR] || (size_t) P[DIR] > nbr_nodes_thermal[DIR]){
+					enough_nodes = false;
+				}
 			}
-			else
-			{
-				this->RankNeighbour[4] = myRank-N*N;
-				this->RankNeighbour[5] = myRank+N*N;
+			if(enough_nodes == false){continue;}
+
+			/// Area of the faces between MPI processes, in number of nodes:
+			double area = (double) (Px-1) * nbr_nodes_Y * nbr_nodes_Z
+						+ (double) (Py-1) * nbr_nodes_X * nbr_nodes_Z
+						+ (double) (Pz-1) * nbr_nodes_X * nbr_nodes_Y;
+
+			/// With the same area, the first one has the least cuts along x (the rows of the fields):
+			if(smallest_area < 0 || area < smallest_area){
+				smallest_area      = area;
+				nbr_MPI_along[0]   = Px;
+				nbr_MPI_along[1]   = Py;
+				nbr_MPI_along[2]   = Pz;
 			}
-			/* --------------------------------------------------------------------------------------------------------------- */
 		}
 	}
 
-	// ODD case
-	else if(nbProc %2 != 0){
-
-		/**
-		 *  If the number of MPI process is odd, 'cut' along the X direction.
-		 *  All MPI processes *MUST* add one node to the electric field along X.
-		 *  *ONLY* the last MPI process writes the line of zeros.
-		 *  For all MPI *BUT* the last one: 
-		 * 		subGrid.MPI_communicator.must_add_one_E_X_along_XYZ[0] = true;
-		 *  For the last MPI process:
-		 * 		subGrid.MPI_communicator.must_add_one_E_X_along_XYZ[0] = false; (default value)
-		 *  Regarding the magnetic field:
-		 * 			1) For the X magnetic field, nothing to do.
-		 * 			2) For the Y magnetic field, must add one in the X direction 
-		 * 				for all *BUT* the last MPI process.
-		 * 			3) For the Z magnetic field, must add one in the X direction
-		 * 				for all *BUT* the last MPI process.
-		 */
-
-		int PositionOnX = myRank;
-		int PositionOnY = 0;
-		int PositionOnZ = 0;
-
-		subGrid.MPI_communicator.MPI_POSITION[0] = (char) PositionOnX;
-		subGrid.MPI_communicator.MPI_POSITION[1] = (char) PositionOnY;
-		subGrid.MPI_communicator.MPI_POSITION[2] = (char) PositionOnZ;
-
-		subGrid.MPI_communicator.MPI_MAX_POSI[0] = nbProc-1;
-		subGrid.MPI_communicator.MPI_MAX_POSI[1] = 0;
-		subGrid.MPI_communicator.MPI_MAX_POSI[2] = 0;
-
-
-		size_t nbr_nodes_local_X         = nbr_nodes_X / nbProc;
-		size_t nbr_nodes_local_thermal_X = nbr_nodes_thermal_X / nbProc;
-
-		if(nbr_nodes_local_X * nbProc != nbr_nodes_X){
-			if(PositionOnX == nbProc-1){
-				subGrid.sizes_EH[0] = nbr_nodes_local_X + 
-					nbr_nodes_X - nbr_nodes_local_X*nbProc;
-			}else{
-				subGrid.sizes_EH[0] = nbr_nodes_local_X;
-			}
-		}else{
-			subGrid.sizes_EH[0] = nbr_nodes_local_X;
-		}
-
-		if(nbr_nodes_local_thermal_X * nbProc != nbr_nodes_thermal_X){
-			if(PositionOnX == nbProc-1){
-				subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X
-						+ nbr_nodes_thermal_X - nbr_nodes_local_thermal_X * nbProc;
-			}else{
-				subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X;
-			}
-		}else{
-			subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X;
-		}
-
-		subGrid.sizes_EH[1] = nbr_nodes_Y;
-		subGrid.sizes_EH[2] = nbr_nodes_Z;
-
-		subGrid.size_Thermal[1] = nbr_nodes_thermal_Y;
-		subGrid.size_Thermal[2] = nbr_nodes_thermal_Z;
-
-		// Origin indices for the electromagnetc grid:
-		subGrid.originIndices_Electro[0] = PositionOnX * nbr_nodes_local_X;
-		subGrid.originIndices_Electro[1] = PositionOnY * nbr_nodes_Y;
-		subGrid.originIndices_Electro[2] = PositionOnZ * nbr_nodes_Z;
-		// Origin indices for the thermal grid:
-		subGrid.originIndices_Thermal[0] = PositionOnX * nbr_nodes_local_thermal_X;
-		subGrid.originIndices_Thermal[1] = PositionOnY * nbr_nodes_thermal_Y;
-		subGrid.originIndices_Thermal[2] = PositionOnZ * nbr_nodes_thermal_Z;
+	if(smallest_area < 0){
+		DISPLAY_ERROR_ABORT(
+			"Cannot divide the grids of (%zu,%zu,%zu) electromagnetic nodes and (%zu,%zu,%zu) thermal "
+			"nodes between %d MPI processes (at least one node along each direction per process).",
+			nbr_nodes_X,nbr_nodes_Y,nbr_nodes_Z,
+			nbr_nodes_thermal_X,nbr_nodes_thermal_Y,nbr_nodes_thermal_Z,
+			nbProc
+		);
+	}
 
+	/**
+	 * Cartesian topology of the MPI processes. The dimensions are given as (z,y,x), so that
+	 * the rank is PositionOnX + Px * (PositionOnY + Py * PositionOnZ), as for the nodes of the fields.
+	 * The ranks are not reordered, they stay the ranks of MPI_COMM_WORLD used by the communications.
+	 */
+	int dims_ZYX[3]    = {nbr_MPI_along[2],nbr_MPI_along[1],nbr_MPI_along[0]};
+	int periods_ZYX[3] = {0,0,0};
+	MPI_Comm cartesian_communicator;
+	MPI_Cart_create(MPI_COMM_WORLD,3,dims_ZYX,periods_ZYX,0,&cartesian_communicator);
 
-		/* We do the x component */
-		if(PositionOnX == 0)
-		{
-			/// The first is for South neighboor, the second is for North neighboor.
-			this->RankNeighbour[0] = myRank+1;
-			this->RankNeighbour[1] = -1;
-		}
-		else if(PositionOnX == nbProc-1)
-		{
-			/// The first is for South neighboor, the second is for North neighboor.
-			this->RankNeighbour[0] = -1;
-			this->RankNeighbour[1] = myRank-1;
-		}
-		else
-		{
-			/// The first is for South neighboor, the second is for North neighboor.
-			this->RankNeighbour[0] = myRank+1;
-			this->RankNeighbour[1] = myRank-1;
-		}
+	int coords_ZYX[3] = {0,0,0};
+	MPI_Cart_coords(cartesian_communicator,myRank,3,coords_ZYX);
 
-		/* We put -1 everywhere because we have only a separation along the x-axis */
-		this->RankNeighbour[2] = -1;
-		this->RankNeighbour[3] = -1;
-		this->RankNeighbour[4] = -1;
-		this->RankNeighbour[5] = -1;
+	int PositionOnX = coords_ZYX[2];
+	int PositionOnY = coords_ZYX[1];
+	int PositionOnZ = coords_ZYX[0];
 
-	}
+	subGrid.MPI_communicator.MPI_POSITION[0] = (char) PositionOnX;
+	subGrid.MPI_communicator.MPI_POSITION[1] = (char) PositionOnY;
+	subGrid.MPI_communicator.MPI_POSITION[2] = (char) PositionOnZ;
 
-	// EVEN case
-	else{
+	subGrid.MPI_communicator.MPI_MAX_POSI[0] = (char) (nbr_MPI_along[0]-1);
+	subGrid.MPI_communicator.MPI_MAX_POSI[1] = (char) (nbr_MPI_along[1]-1);
+	subGrid.MPI_communicator.MPI_MAX_POSI[2] = (char) (nbr_MPI_along[2]-1);
 
-		int PositionOnX = myRank%(nbProc/2);
-		int PositionOnY = ((int)(2*myRank/nbProc));
-		int PositionOnZ = 0;
+	/**
+	 * Neighbours along each direction (MPI_PROC_NULL on the boundaries of the domain).
+	 * Dimension 2 of the topology is x, 1 is y and 0 is z.
+	 */
+	int rank_before = MPI_PROC_NULL;
+	int rank_after  = MPI_PROC_NULL;
 
-		subGrid.MPI_communicator.MPI_POSITION[0] = (char) PositionOnX;
-		subGrid.MPI_communicator.MPI_POSITION[1] = (char) PositionOnY;
-		subGrid.MPI_communicator.MPI_POSITION[2] = (char) PositionOnZ;
+	/* We do the x component */
+	MPI_Cart_shift(cartesian_communicator,2,1,&rank_before,&rank_after);
+	this->RankNeighbour[0] = (rank_after  == MPI_PROC_NULL) ? -1 : rank_after;
+	this->RankNeighbour[1] = (rank_before == MPI_PROC_NULL) ? -1 : rank_before;
 
-		subGrid.MPI_communicator.MPI_MAX_POSI[0] = (char) (nbProc-1)%(nbProc/2);
-		subGrid.MPI_communicator.MPI_MAX_POSI[1] = (char) ((int)(2*(nbProc-1)/nbProc));
-		subGrid.MPI_communicator.MPI_MAX_POSI[2] = 0;
+	/* We do the y component */
+	MPI_Cart_shift(cartesian_communicator,1,1,&rank_before,&rank_after);
+	this->RankNeighbour[2] = (rank_before == MPI_PROC_NULL) ? -1 : rank_before;
+	this->RankNeighbour[3] = (rank_after  == MPI_PROC_NULL) ? -1 : rank_after;
 
+	/* We do the z component */
+	MPI_Cart_shift(cartesian_communicator,0,1,&rank_before,&rank_after);
+	this->RankNeighbour[4] = (rank_before == MPI_PROC_NULL) ? -1 : rank_before;
+	this->RankNeighbour[5] = (rank_after  == MPI_PROC_NULL) ? -1 : rank_after;
 
-		size_t nbr_nodes_local_X = 2*nbr_nodes_X / (nbProc);
-		size_t nbr_nodes_local_Y = nbr_nodes_Y / 2;
-		size_t nbr_nodes_local_Z = nbr_nodes_Z;
+	MPI_Comm_free(&cartesian_communicator);
 
-		size_t nbr_nodes_local_thermal_X = 2*nbr_nodes_thermal_X / nbProc;
-		size_t nbr_nodes_local_thermal_Y = nbr_nodes_thermal_Y / 2;
-		size_t nbr_nodes_local_thermal_Z = nbr_nodes_thermal_Z;
+	/**
+	 * Number of nodes of each MPI process. The remainder of the division is spread over the
+	 * first MPI processes of each direction (one more node each), instead of being given to the last one.
+	 * With LOAD_BALANCING=COST, the planes of the electromagnetic grid are cut so that the MPI processes
+	 * of each direction have the same estimated cost per step (see estimate_cost_of_planes).
+	 */
+	int position[3] = {PositionOnX,PositionOnY,PositionOnZ};
 
-		if(nbr_nodes_local_X * (nbProc/2) != nbr_nodes_X){
-			if(PositionOnX == nbProc/2 - 1){
-				subGrid.sizes_EH[0] = nbr_nodes_local_X + 
-					nbr_nodes_X - nbr_nodes_local_X * (nbProc/2);
-			}else{
-				subGrid.sizes_EH[0] = nbr_nodes_local_X;
-			}
-		}else{
-			subGrid.sizes_EH[0] = nbr_nodes_local_X;
-		}
+	bool balance_cost = subGrid.input_parser.ELECTRO_LOAD_BALANCING == "COST";
 
-		if(nbr_nodes_local_thermal_X * (nbProc/2) != nbr_nodes_thermal_X){
-			if(PositionOnX == nbProc/2 - 1){
-				subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X +
-						nbr_nodes_thermal_X - nbr_nodes_local_thermal_X * (nbProc/2);
-			}else{
-				subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X;
-			}
-		}else{
-			subGrid.size_Thermal[0] = nbr_nodes_local_thermal_X;
-		}
+	for(unsigned int DIR = 0 ; DIR < 3 ; DIR ++){
 
-		if(nbr_nodes_local_Y * 2 != nbr_nodes_Y){
-			if(PositionOnY == 1){
-				subGrid.sizes_EH[1] = nbr_nodes_local_Y + nbr_nodes_Y 
-					- nbr_nodes_local_Y * 2;
-			}else{
-				subGrid.sizes_EH[1] = nbr_nodes_local_Y;
-			}
-		}else{
-			subGrid.sizes_EH[1] = nbr_nodes_local_Y;
-		}
+		size_t nbr_MPI   = (size_t) nbr_MPI_along[DIR];
+		size_t posi      = (size_t) position[DIR];
 
+		/// Electromagnetic grid:
+		if(balance_cost){
+			std::vector<double> cost_of_plane;
+			std::vector<size_t> first_plane;
+			estimate_cost_of_planes(subGrid,nbr_nodes,DIR,cost_of_plane);
+			cut_planes_with_equal_cost(cost_of_plane,nbr_MPI,first_plane);
 
-		if(nbr_nodes_local_thermal_Y * 2 != nbr_nodes_thermal_Y){
-			if(PositionOnY == 1){
-				subGrid.size_Thermal[1] = nbr_nodes_local_thermal_Y
-						+ nbr_nodes_thermal_Y - nbr_nodes_local_thermal_Y * 2;
-			}else{
-				subGrid.size_Thermal[1] = nbr_nodes_local_thermal_Y;
-			}
+			subGrid.sizes_EH[DIR]              = first_plane[posi+1] - first_plane[posi];
+			subGrid.originIndices_Electro[DIR] = first_plane[posi];
 		}else{
-			subGrid.size_Thermal[1] = nbr_nodes_local_thermal_Y;
-		}
-
-		subGrid.sizes_EH[2]     = nbr_nodes_local_Z;
-		subGrid.size_Thermal[2] = nbr_nodes_local_thermal_Z; 
-
-		// Origin indices for the electromagnetic grid:
-		subGrid.originIndices_Electro[0] = PositionOnX * nbr_nodes_local_X;
-		subGrid.originIndices_Electro[1] = PositionOnY * nbr_nodes_local_Y;
-		subGrid.originIndices_Electro[2] = PositionOnZ * nbr_nodes_local_Z;
-		// Origin indices for the thermal grid:
-		subGrid.originIndices_Thermal[0] = PositionOnX * nbr_nodes_local_thermal_X;
-		subGrid.originIndices_Thermal[1] = PositionOnY * nbr_nodes_local_thermal_Y;
-		subGrid.originIndices_Thermal[2] = PositionOnZ * nbr_nodes_local_thermal_Z;
-
-		/* We do the x component */
-		if(nbProc == 2){
-			this->RankNeighbour[0] = -1;
-			this->RankNeighbour[1] = -1;
-		}
-		else{
-			/// First MPI process along X direction:
-			if(PositionOnX == 0)
-			{
-				/// South neighboor:
-				this->RankNeighbour[0] = myRank + 1;
-				this->RankNeighbour[1] = -1;
-				
+			size_t nbr_nodes_local = nbr_nodes[DIR] / nbr_MPI;
+			size_t remainder       = nbr_nodes[DIR] % nbr_MPI;
 
-			}
-			/// Last MPI process along X direction:
-			else if(PositionOnX == nbProc/2 -1)
-			{
-				this->RankNeighbour[0] = -1;
-				this->RankNeighbour[1] =  myRank-1;
-				//cout << myRank <<"!!!!!!!!!!!!!!!!!!!!!!RankNeighbour x: " <<this->RankNeighbour[0] << " ; "<<this->RankNeighbour[1] << endl;	
-			}
-			else
-			{
-				this->RankNeighbour[0] = myRank+1;
-				this->RankNeighbour[1] = myRank-1;
-				//cout << myRank<< "!!!!!!!!!!!!!!!!!!!!!!RankNeighbour x: " <<this->RankNeighbour[0] << " ; "<<this->RankNeighbour[1] << endl;
-			}
-		}
-		/* We do the y component */
-		if(PositionOnY == 0)
-		{
-			this->RankNeighbour[2] = -1;
-			this->RankNeighbour[3] = myRank+(nbProc/2);
-			//cout << myRank <<"!!!!!!!!!!!!!!!!!!!!!!RankNeighbour y: " <<this->RankNeighbour[2] << " ; "<< this->RankNeighbour[3] << endl;
-		}
-		else if(PositionOnY == 1)
-		{
-			this->RankNeighbour[2] = myRank-(nbProc/2);
-			this->RankNeighbour[3] = -1;
-			//cout << myRank <<"!!!!!!!!!!!!!!!!!!!!!!RankNeighbour y: " <<this->RankNeighbour[2] << " ; "<<this->RankNeighbour[3] << endl;
+			subGrid.sizes_EH[DIR]              = nbr_nodes_local + (posi < remainder ? 1 : 0);
+			subGrid.originIndices_Electro[DIR] = posi * nbr_nodes_local + (posi < remainder ? posi : remainder);
 		}
-		else
-		{
-			printf("MPI_Initializer::MpiDivision\n");
-			printf("This case is not envisageable, at line %d in file %s.\n",__LINE__,__FILE__);
-			abort();
 
-		}
-
-		/* We do the z component */
-		this->RankNeighbour[4] = -1;
-		this->RankNeighbour[5] = -1;
-		//cout << myRank<< "!!!!!!!!!!!!!!!!!!!!!!RankNeighbour z: " <<this->RankNeighbour[4] << " ; "<<this->RankNeighbour[5] << endl;
+		/// Thermal grid:
+		size_t nbr_nodes_local_thermal = nbr_nodes_thermal[DIR] / nbr_MPI;
+		size_t remainder_thermal       = nbr_nodes_thermal[DIR] % nbr_MPI;
 
+		subGrid.size_Thermal[DIR]          = nbr_nodes_local_thermal + (posi < remainder_thermal ? 1 : 0);
+		subGrid.originIndices_Thermal[DIR] = posi * nbr_nodes_local_thermal
+												+ (posi < remainder_thermal ? posi : remainder_thermal);
 	}
 
+	#ifndef NDEBUG
+		printf("MPI %d ->  position (%d,%d,%d) out of (%d,%d,%d) MPI processes\n",myRank,
+			PositionOnX,PositionOnY,PositionOnZ,
+			nbr_MPI_along[0],nbr_MPI_along[1],nbr_MPI_along[2]);
+	#endif
 
 	/**
 	 * Check if last along X.
@@ -616,3 +465,98 @@ void MPI_Initializer::MPI_DIVISION(GridCreator_NEW & subGrid){
 			subGrid.originIndices_Thermal[2]);
 	#endif
 }
+
+/**
+ * @brief New cuts of the electromagnetic grid along Z, from the compute time per step of each MPI process
+ *        (all the MPI processes must call it).
+ *
+ * The MPI processes with the same position along Z (a layer) have the same planes, and the time of a
+ * layer is the time of its slowest process. If the slowest layer is slower than the mean by more than
+ * REBALANCING_THRESHOLD, the time of each layer is shared by its planes and the planes are cut again with
+ * the same cost per layer (see cut_planes_with_equal_cost). Planes only move between neighbours, and each
+ * layer keeps at least two planes (a cut moves by at most (planes - 2) / 2 planes of each layer next to it).
+ *
+ * Returns true if planes must be moved: planes_from_below > 0 planes come from the neighbour below,
+ * planes_from_below < 0 planes go to it (same for planes_from_above).
+ */
+bool MPI_Initializer::MPI_REBALANCING_ALONG_Z(GridCreator_NEW & subGrid, double time_per_step,
+											  long *planes_from_below, long *planes_from_above)
+{
+	*planes_from_below = 0;
+	*planes_from_above = 0;
+
+	size_t nbr_layers = (size_t) this->MPI_MAX_POSI[2] + 1;
+	size_t layer      = (size_t) this->MPI_POSITION[2];
+
+	if(nbr_layers < 2){
+		return false;
+	}
+
+	/// Time and first plane of each layer (the last element of first_plane is the number of planes):
+	std::vector<double>        time_of_layer(nbr_layers,0.0);
+	std::vector<unsigned long> first_plane(nbr_layers+1,0);
+
+	time_of_layer[layer] = time_per_step;
+	first_plane[layer]   = subGrid.originIndices_Electro[2];
+	if(layer == nbr_layers-1){
+		first_plane[nbr_layers] = subGrid.originIndices_Electro[2] + subGrid.sizes_EH[2];
+	}
+
+	MPI_Allreduce(MPI_IN_PLACE,time_of_layer.data(),nbr_layers  ,MPI_DOUBLE       ,MPI_MAX,MPI_COMM_WORLD);
+	MPI_Allreduce(MPI_IN_PLACE,first_plane.data()  ,nbr_layers+1,MPI_UNSIGNED_LONG,MPI_MAX,MPI_COMM_WORLD);
+
+	double slowest_time = 0.0;
+	double mean_time    = 0.0;
+	for(size_t L = 0 ; L < nbr_layers ; L ++){
+		slowest_time = std::max(slowest_time,time_of_layer[L]);
+		mean_time   += time_of_layer[L] / nbr_layers;
+	}
+
+	if(mean_time <= 0.0 || slowest_time <= subGrid.input_parser.ELECTRO_REBALANCING_THRESHOLD * mean_time){
+		return false;
+	}
+
+	/// Cost of each plane: the time of its layer, shared by the planes of the layer:
+	std::vector<double> cost_of_plane(first_plane[nbr_layers],0.0);
+	for(size_t L = 0 ; L < nbr_layers ; L ++){
+		for(size_t K = first_plane[L] ; K < first_plane[L+1] ; K ++){
+			cost_of_plane[K] = time_of_layer[L] / (first_plane[L+1] - first_plane[L]);
+		}
+	}
+
+	std::vector<size_t> new_first_plane;
+	cut_planes_with_equal_cost(cost_of_plane,nbr_layers,new_first_plane);
+
+	bool planes_move = false;
+	for(size_t L = 1 ; L < nbr_layers ; L ++){
+		size_t planes_below = first_plane[L]   - first_plane[L-1];
+		size_t planes_above = first_plane[L+1] - first_plane[L];
+		size_t max_down     = planes_below > 2 ? (planes_below - 2) / 2 : 0;
+		size_t max_up       = planes_above > 2 ? (planes_above - 2) / 2 : 0;
+
+		new_first_plane[L] = std::max(new_first_plane[L],(size_t) first_plane[L] - max_down);
+		new_first_plane[L] = std::min(new_first_plane[L],(size_t) first_plane[L] + max_up);
+
+		if(new_first_plane[L] != first_plane[L]){
+			planes_move = true;
+		}
+	}
+
+	if(!planes_move){
+		return false;
+	}
+
+	*planes_from_below = (long) first_plane[layer]       - (long) new_first_plane[layer];
+	*planes_from_above = (long) new_first_plane[layer+1] - (long) first_plane[layer+1];
+
+	if(this->isRootProcess() != INT_MIN){
+		printf(">>> Planes along Z rebalanced (slowest layer of MPI processes %.2lf times slower than the mean)."
+			   " First plane of each layer:",slowest_time / mean_time);
+		for(size_t L = 0 ; L < nbr_layers ; L ++){
+			printf(" %zu->%zu",(size_t) first_plane[L],new_first_plane[L]);
+		}
+		printf("\n");
+	}
+
+	return true;
+}
@@ -58,6 +58,11 @@ class MPI_Initializer{
 
 		void MPI_DIVISION(GridCreator_NEW & /*subgrid*/);
 
+		// New cuts of the electromagnetic grid along Z from the compute time of each MPI process.
+		// Returns true if planes must be moved (planes_from_below/above, see GridCreator_NEW::migrate_planes_along_z):
+		bool MPI_REBALANCING_ALONG_Z(GridCreator_NEW & /*subgrid*/, double /*time_per_step*/,
+									 long * /*planes_from_below*/, long * /*planes_from_above*/);
+
 
 		//////////////////////////////////////////////////////
 		/// TO WRITE OUTPUT FILES, WE'LL NEED MPI POSITION ///
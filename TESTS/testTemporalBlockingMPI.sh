@@ -0,0 +1,20 @@
+# Runs TESTS/testTemporalBlockingMPI.input with one MPI process, then with NBRMPI processes (temporal blocking
+# between the exchanges of the ghost layers), and checks that the fields of the last step are identical.
+# Usage, from the root of the repository: bash TESTS/testTemporalBlockingMPI.sh <executable> [NBRMPI]
+EXE=${1:-build/main}
+NBRMPI=${2:-4}
+STR="TESTS/testTemporalBlockingMPI.input"
+OUT="RESULTS/TEMPORAL_BLOCKING_MPI_ELECTRO_00000030.vti"
+mkdir -p RESULTS
+
+mpirun -np 1 $EXE -inputfile $STR > /dev/null || exit 1
+mv $OUT $OUT.np1
+mpirun -np $NBRMPI $EXE -inputfile $STR > /dev/null || exit 1
+
+if cmp -s $OUT $OUT.np1
+then
+	echo "### NBR_MPI = $NBRMPI: same fields as with one MPI process ###"
+else
+	echo "### NBR_MPI = $NBRMPI: the fields differ from the ones with one MPI process ###"
+	exit 1
+fi
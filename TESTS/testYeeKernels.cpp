@@ -0,0 +1,204 @@
+/* Test of the Yee kernels (see YeeKernels.hpp) on rows of several materials.
+ *
+ * The fields of the input files are in the air only: their rows are all uniform, so that the gather of
+ * the per-material coefficients and the non-uniform SIMD rows are never used. Here, the materials are
+ * random, except on some rows of a single material. Each component is updated with all the kernels
+ * (scalar, AVX2 and AVX-512 when the CPU supports them, with and without the uniform rows, with and
+ * without tiles, per node and per material coefficients), for the three precisions, and the result
+ * must be identical (byte for byte) to the scalar update of one node at a time, per node.
+ * Returns 0 if all the updates are identical, 1 otherwise.
+ */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <omp.h>
+
+#include "../YeeKernels.hpp"
+
+/// Number of materials of the test:
+const size_t NBR_MATERIALS = 4;
+
+/// Sizes of all the arrays (the stencils stay inside them for 1 <= I,J,K < size-1):
+const size_t SIZE[3] = {45,13,11};
+
+/**
+ * @brief Pseudo-random number in [0,1), the same on all machines.
+ */
+static double next_random(unsigned long long &state){
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double)(state >> 11) / (double)(1ULL << 53);
+}
+
+/**
+ * @brief Material of the node (I,J,K): random, except on some rows of a single material.
+ */
+static unsigned char material_of_node(size_t J, size_t K, unsigned long long &state){
+    if(J % 4 == 0){
+        return 0;
+    }
+    if(J % 4 == 1){
+        return (unsigned char)(K % NBR_MATERIALS);
+    }
+    return (unsigned char)(next_random(state) * NBR_MATERIALS);
+}
+
+/**
+ * @brief Update of the six components with one kernel, from the same initial fields.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+struct YeeKernelTest{
+    size_t nbr_nodes = SIZE[0] * SIZE[1] * SIZE[2];
+
+    std::vector<FIELD_TYPE>    initial_field[6];
+    std::vector<unsigned char> material[6];
+    std::vector<COEF_TYPE>     C_per_material[6][3];
+    std::vector<COEF_TYPE>     C_per_node[6][3];
+    std::vector<unsigned char> uniform_row[6][2];
+
+    YeeKernelTest(void){
+        unsigned long long state = 12345;
+        for(unsigned int c = 0 ; c < 6 ; c ++){
+            initial_field[c].resize(nbr_nodes);
+            material[c].resize(nbr_nodes);
+            for(size_t K = 0 ; K < SIZE[2] ; K ++){
+                for(size_t J = 0 ; J < SIZE[1] ; J ++){
+                    for(size_t I = 0 ; I < SIZE[0] ; I ++){
+                        size_t index = I + SIZE[0] * (J + SIZE[1] * K);
+                        initial_field[c][index] = static_cast<FIELD_TYPE>(2 * next_random(state) - 1);
+                        material[c][index]      = material_of_node(J,K,state);
+                    }
+                }
+            }
+            for(unsigned int n = 0 ; n < 3 ; n ++){
+                C_per_material[c][n].resize(NBR_MATERIALS);
+                for(size_t mat = 0 ; mat < NBR_MATERIALS ; mat ++){
+                    C_per_material[c][n][mat] = static_cast<COEF_TYPE>(0.1 + next_random(state));
+                }
+                C_per_node[c][n].resize(nbr_nodes);
+                for(size_t index = 0 ; index < nbr_nodes ; index ++){
+                    C_per_node[c][n][index] = C_per_material[c][n][material[c][index]];
+                }
+            }
+            /// Uniform rows, per node [0] and per material [1]:
+            for(unsigned int per_material = 0 ; per_material < 2 ; per_material ++){
+                const std::vector<COEF_TYPE> *C = per_material ? C_per_material[c] : C_per_node[c];
+                uniform_row[c][per_material].resize(SIZE[1] * SIZE[2]);
+                classify_yee_uniform_rows(
+                    C[0].data(),C[1].data(),C[2].data(),
+                    per_material ? material[c].data() : NULL,
+                    SIZE,
+                    uniform_row[c][per_material].data());
+            }
+        }
+    }
+
+    /**
+     * @brief Fields after one update of H, then one of E, with the given kernel.
+     */
+    void update(
+        std::vector<FIELD_TYPE> field[6],
+        YeeSimdISA isa,
+        bool       per_material,
+        bool       use_uniform_rows,
+        bool       use_tiles)
+    {
+        for(unsigned int c = 0 ; c < 6 ; c ++){
+            field[c] = initial_field[c];
+        }
+
+        /// Components of the curl of each component (Hx needs Ey and Ez, Ex needs Hy and Hz, etc.):
+        const unsigned int curl_1[6] = {4,5,3,1,2,0};
+        const unsigned int curl_2[6] = {5,3,4,2,0,1};
+        const YeeComponentID id[6]   = {YEE_HX,YEE_HY,YEE_HZ,YEE_EX,YEE_EY,YEE_EZ};
+
+        YeeComponent<FIELD_TYPE,COEF_TYPE> comp[6];
+        for(unsigned int c = 0 ; c < 6 ; c ++){
+            const std::vector<COEF_TYPE> *C = per_material ? C_per_material[c] : C_per_node[c];
+            comp[c] = make_yee_component<FIELD_TYPE,COEF_TYPE>(
+                id[c],
+                field[c].data(),         SIZE,
+                field[curl_1[c]].data(), SIZE,
+                field[curl_2[c]].data(), SIZE,
+                C[0].data(), C[1].data(), C[2].data(),
+                per_material     ? material[c].data()                  : NULL,
+                use_uniform_rows ? uniform_row[c][per_material].data() : NULL,
+                isa);
+        }
+
+        YeeRange range[3];
+        for(unsigned int c = 0 ; c < 3 ; c ++){
+            range[c] = make_yee_range(1,SIZE[0]-1,1,SIZE[1]-1,1,SIZE[2]-1);
+        }
+        const size_t tile_size[3] = {16,5,3};
+
+        #pragma omp parallel
+        {
+            for(unsigned int field_H_E = 0 ; field_H_E < 2 ; field_H_E ++){
+                YeeComponent<FIELD_TYPE,COEF_TYPE> *comp_field = comp + 3 * field_H_E;
+                if(use_tiles){
+                    update_yee_field_tiled(comp_field,per_material,range,tile_size);
+                }else{
+                    for(unsigned int c = 0 ; c < 3 ; c ++){
+                        update_yee_component(comp_field[c],per_material,range[c]);
+                    }
+                }
+                #pragma omp barrier
+            }
+        }
+    }
+
+    /**
+     * @brief Compares all the kernels with the scalar update per node. Returns the number of differences.
+     */
+    size_t run(const char *precision){
+        std::vector<FIELD_TYPE> reference[6];
+        this->update(reference,YEE_SIMD_SCALAR,false,false,false);
+
+        size_t nbr_differences = 0;
+        YeeSimdISA best_isa = yee_detect_simd_isa();
+        for(int isa = YEE_SIMD_SCALAR ; isa <= best_isa ; isa ++){
+            for(unsigned int per_material = 0 ; per_material < 2 ; per_material ++){
+                for(unsigned int use_uniform_rows = 0 ; use_uniform_rows < 2 ; use_uniform_rows ++){
+                    for(unsigned int use_tiles = 0 ; use_tiles < 2 ; use_tiles ++){
+                        std::vector<FIELD_TYPE> field[6];
+                        this->update(field,(YeeSimdISA)isa,per_material,use_uniform_rows,use_tiles);
+
+                        size_t nbr_nodes_differ = 0;
+                        for(unsigned int c = 0 ; c < 6 ; c ++){
+                            for(size_t index = 0 ; index < nbr_nodes ; index ++){
+                                if(memcmp(&field[c][index],&reference[c][index],sizeof(FIELD_TYPE)) != 0){
+                                    nbr_nodes_differ ++;
+                                }
+                            }
+                        }
+                        printf("%s %-7s %-12s %-14s %-8s : %s (%zu nodes differ)\n",
+                            precision,
+                            yee_simd_isa_name((YeeSimdISA)isa),
+                            per_material     ? "PER_MATERIAL" : "PER_NODE",
+                            use_uniform_rows ? "UNIFORM_ROWS"  : "NO_UNIFORM",
+                            use_tiles        ? "TILES"         : "NO_TILES",
+                            nbr_nodes_differ == 0 ? "OK" : "DIFFERENT",
+                            nbr_nodes_differ);
+                        nbr_differences += nbr_nodes_differ;
+                    }
+                }
+            }
+        }
+        return nbr_differences;
+    }
+};
+
+int main(void){
+    size_t nbr_differences = 0;
+
+    YeeKernelTest<double,double> test_double;
+    nbr_differences += test_double.run("DOUBLE");
+
+    YeeKernelTest<float,double> test_mixed;
+    nbr_differences += test_mixed.run("MIXED ");
+
+    YeeKernelTest<float,float> test_float;
+    nbr_differences += test_float.run("FLOAT ");
+
+    return nbr_differences == 0 ? 0 : 1;
+}
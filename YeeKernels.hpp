@@ -0,0 +1,402 @@
+/* This file provides the kernels used to update the electromagnetic fields (Yee scheme) */
+#ifndef YEEKERNELS_HPP
+#define YEEKERNELS_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+
+#include "header_with_all_defines.hpp"
+#include "AlignedMemory.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    /// The AVX2 and AVX-512 kernels are compiled in, and chosen at runtime:
+    #define YEE_KERNELS_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+/**
+ * @brief Instruction set used by the kernels.
+ */
+typedef enum YeeSimdISA{
+    YEE_SIMD_SCALAR = 0,
+    YEE_SIMD_AVX2   = 1,
+    YEE_SIMD_AVX512 = 2
+}YeeSimdISA;
+
+/**
+ * @brief Best instruction set supported by the CPU (CPUID).
+ */
+inline YeeSimdISA yee_detect_simd_isa(void){
+    #ifdef YEE_KERNELS_X86_SIMD
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f")){
+            return YEE_SIMD_AVX512;
+        }
+        if(__builtin_cpu_supports("avx2")){
+            return YEE_SIMD_AVX2;
+        }
+    #endif
+    return YEE_SIMD_SCALAR;
+}
+
+inline const char *yee_simd_isa_name(YeeSimdISA isa){
+    switch(isa){
+        case YEE_SIMD_AVX512: return "AVX-512";
+        case YEE_SIMD_AVX2:   return "AVX2";
+        default:              return "SCALAR";
+    }
+}
+
+/**
+ * @brief The six components of the Yee scheme.
+ */
+typedef enum YeeComponentID{
+    YEE_HX = 0,
+    YEE_HY = 1,
+    YEE_HZ = 2,
+    YEE_EX = 3,
+    YEE_EY = 4,
+    YEE_EZ = 5
+}YeeComponentID;
+
+/**
+ * @brief Stencil of each component, known at compile time.
+ *
+ * CURL_DIR_1 (resp. CURL_DIR_2) is the direction (0 = x, 1 = y, 2 = z) of the difference A(+) - A(-)
+ * (resp. B(+) - B(-)). The magnetic field uses the nodes (+1) and (0) of the electric field (FORWARD),
+ * the electric field uses the nodes (0) and (-1) of the magnetic field.
+ */
+template<YeeComponentID ID>
+struct YeeStencil;
+
+/// Hx(mm,nn,pp) uses Ey(mm,nn,pp+1) - Ey(mm,nn,pp) and Ez(mm,nn+1,pp) - Ez(mm,nn,pp):
+template<> struct YeeStencil<YEE_HX>{ static const int CURL_DIR_1 = 2; static const int CURL_DIR_2 = 1; static const bool FORWARD = true ; };
+/// Hy(mm,nn,pp) uses Ez(mm+1,nn,pp) - Ez(mm,nn,pp) and Ex(mm,nn,pp+1) - Ex(mm,nn,pp):
+template<> struct YeeStencil<YEE_HY>{ static const int CURL_DIR_1 = 0; static const int CURL_DIR_2 = 2; static const bool FORWARD = true ; };
+/// Hz(mm,nn,pp) uses Ex(mm,nn+1,pp) - Ex(mm,nn,pp) and Ey(mm+1,nn,pp) - Ey(mm,nn,pp):
+template<> struct YeeStencil<YEE_HZ>{ static const int CURL_DIR_1 = 1; static const int CURL_DIR_2 = 0; static const bool FORWARD = true ; };
+/// Ex(mm,nn,pp) uses Hz(mm,nn,pp) - Hz(mm,nn-1,pp) and Hy(mm,nn,pp) - Hy(mm,nn,pp-1):
+template<> struct YeeStencil<YEE_EX>{ static const int CURL_DIR_1 = 1; static const int CURL_DIR_2 = 2; static const bool FORWARD = false; };
+/// Ey(mm,nn,pp) uses Hx(mm,nn,pp) - Hx(mm,nn,pp-1) and Hz(mm,nn,pp) - Hz(mm-1,nn,pp):
+template<> struct YeeStencil<YEE_EY>{ static const int CURL_DIR_1 = 2; static const int CURL_DIR_2 = 0; static const bool FORWARD = false; };
+/// Ez(mm,nn,pp) uses Hy(mm,nn,pp) - Hy(mm-1,nn,pp) and Hx(mm,nn,pp) - Hx(mm,nn-1,pp):
+template<> struct YeeStencil<YEE_EZ>{ static const int CURL_DIR_1 = 0; static const int CURL_DIR_2 = 1; static const bool FORWARD = false; };
+
+/**
+ * @brief Everything that is needed to update one component of the electric or magnetic field.
+ *
+ * All the components of the Yee scheme are updated with the same formula:
+ *      F(I,J,K) = C_self * F(I,J,K)
+ *                  + C_curl_1 * ( A(+) - A(-) )
+ *                  - C_curl_2 * ( B(+) - B(-) )
+ * where A and B are the two components of the other field involved in the curl.
+ * The (+) and (-) nodes of A and B are given by the stencil of the component (YeeStencil<id>),
+ * so that the kernels are specialised at compile time for each component.
+ *
+ * The coefficients are either given for each node (C_self[index]), or for each material
+ * (C_self[material[index]]). In the second case, 'material' must point to the material
+ * array of the updated component (e.g. GridCreator_NEW::E_x_material).
+ *
+ * The fields are stored as FIELD_TYPE (double or float). The coefficients are stored as COEF_TYPE,
+ * which is also the type in which the update is computed: with float fields and double coefficients,
+ * the loss term C_self * F(I,J,K) is accumulated in double and only the result is rounded to float.
+ *
+ * If 'uniform_row' is given, the rows (J,K) flagged by classify_yee_uniform_rows (e.g. rows of air)
+ * are updated with a constant-coefficient kernel, which does not load the coefficients of each node.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE = FIELD_TYPE>
+struct YeeComponent{
+    /// Which component is updated (selects the stencil):
+    YeeComponentID id = YEE_HX;
+
+    /// Updated component, and its sizes:
+    FIELD_TYPE *field   = NULL;
+    size_t  size_x  = 0;
+    size_t  size_y  = 0;
+    size_t  size_z  = 0;
+
+    /// First component of the curl (A):
+    const FIELD_TYPE *curl_1  = NULL;
+    size_t  size_x_1      = 0;
+    size_t  size_y_1      = 0;
+    size_t  size_z_1      = 0;
+
+    /// Second component of the curl (B):
+    const FIELD_TYPE *curl_2  = NULL;
+    size_t  size_x_2      = 0;
+    size_t  size_y_2      = 0;
+    size_t  size_z_2      = 0;
+
+    /// Coefficients of the update equation:
+    const COEF_TYPE *C_self   = NULL;
+    const COEF_TYPE *C_curl_1 = NULL;
+    const COEF_TYPE *C_curl_2 = NULL;
+
+    /// Material of each node, only used with per-material coefficients:
+    const unsigned char *material = NULL;
+
+    /// For each row (J,K), 1 if its coefficients are uniform (index J + size_y * K), or NULL:
+    const unsigned char *uniform_row = NULL;
+
+    /// Instruction set used to update the rows of nodes:
+    YeeSimdISA isa = YEE_SIMD_SCALAR;
+};
+
+/**
+ * @brief Fill a YeeComponent. The sizes are given as arrays of 3 elements (e.g. grid.size_Ex).
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+inline YeeComponent<FIELD_TYPE,COEF_TYPE> make_yee_component(
+    YeeComponentID    id,
+    FIELD_TYPE       *field,  const size_t *size,
+    const FIELD_TYPE *curl_1, const size_t *size_1,
+    const FIELD_TYPE *curl_2, const size_t *size_2,
+    const COEF_TYPE  *C_self, const COEF_TYPE *C_curl_1, const COEF_TYPE *C_curl_2,
+    const unsigned char *material,
+    const unsigned char *uniform_row,
+    YeeSimdISA    isa)
+{
+    YeeComponent<FIELD_TYPE,COEF_TYPE> comp;
+    comp.id       = id;
+    comp.field    = field;
+    comp.size_x   = size[0];
+    comp.size_y   = size[1];
+    comp.size_z   = size[2];
+
+    comp.curl_1        = curl_1;
+    comp.size_x_1      = size_1[0];
+    comp.size_y_1      = size_1[1];
+    comp.size_z_1      = size_1[2];
+
+    comp.curl_2        = curl_2;
+    comp.size_x_2      = size_2[0];
+    comp.size_y_2      = size_2[1];
+    comp.size_z_2      = size_2[2];
+
+    comp.C_self   = C_self;
+    comp.C_curl_1 = C_curl_1;
+    comp.C_curl_2 = C_curl_2;
+    comp.material = material;
+    comp.uniform_row = uniform_row;
+    comp.isa      = isa;
+    return comp;
+}
+
+/**
+ * @brief Find the rows of a component whose coefficients are uniform.
+ *
+ * A row (J,K) is uniform if all its updated nodes (1 <= I < size_x-1) have the same coefficients,
+ * which is the case of the rows lying in a single material (e.g. the air around the head).
+ * The coefficients are given for each node, or for each material if 'material' is not NULL.
+ * uniform_row[J + size_y * K] is set to 1 for such a row, 0 otherwise (size[1] * size[2] elements).
+ * Returns the number of uniform rows.
+ *
+ * Must be called outside of any OpenMP parallel region (it opens its own).
+ */
+template<typename COEF_TYPE>
+size_t classify_yee_uniform_rows(
+    const COEF_TYPE     *C_self,
+    const COEF_TYPE     *C_curl_1,
+    const COEF_TYPE     *C_curl_2,
+    const unsigned char *material,
+    const size_t        *size,
+    unsigned char       *uniform_row
+);
+
+/**
+ * @brief Range of nodes [I_beg,I_end) x [J_beg,J_end) x [K_beg,K_end) updated for one component.
+ */
+typedef struct YeeRange{
+    size_t I_beg = 0;
+    size_t I_end = 0;
+    size_t J_beg = 0;
+    size_t J_end = 0;
+    size_t K_beg = 0;
+    size_t K_end = 0;
+}YeeRange;
+
+inline YeeRange make_yee_range(
+    size_t I_beg, size_t I_end,
+    size_t J_beg, size_t J_end,
+    size_t K_beg, size_t K_end)
+{
+    YeeRange range;
+    range.I_beg = I_beg; range.I_end = I_end;
+    range.J_beg = J_beg; range.J_end = J_end;
+    range.K_beg = K_beg; range.K_end = K_end;
+    return range;
+}
+
+/**
+ * @brief Split 'range' into its interior, one node away from the sides with halo[side] set, and the
+ *        shell of the other nodes, as six boxes (some may be empty).
+ *
+ * Sides and shell boxes are ordered I low, I high, J low, J high, K low, K high. The boxes K low and
+ * K high are whole planes, J low and J high whole rows of the remaining planes, I low and I high the
+ * ends of the remaining rows: each node of 'range' is in exactly one of the seven boxes.
+ */
+inline void split_yee_range_for_halo(
+    const YeeRange &range,
+    const bool      halo[6],
+    YeeRange       &interior,
+    YeeRange        shell[6])
+{
+    const size_t beg[3] = {range.I_beg,range.J_beg,range.K_beg};
+    const size_t end[3] = {range.I_end,range.J_end,range.K_end};
+    size_t in_beg[3];
+    size_t in_end[3];
+    for(unsigned int d = 0 ; d < 3 ; d ++){
+        in_beg[d] = std::min(beg[d] + (halo[2*d] ? 1 : 0),std::max(beg[d],end[d]));
+        in_end[d] = std::max(in_beg[d],end[d] - (halo[2*d+1] && end[d] > beg[d] ? 1 : 0));
+    }
+
+    interior = make_yee_range(in_beg[0],in_end[0], in_beg[1],in_end[1], in_beg[2],in_end[2]);
+
+    shell[4] = make_yee_range(beg[0],end[0],       beg[1],end[1],       beg[2],in_beg[2]);
+    shell[5] = make_yee_range(beg[0],end[0],       beg[1],end[1],       in_end[2],end[2]);
+    shell[2] = make_yee_range(beg[0],end[0],       beg[1],in_beg[1],    in_beg[2],in_end[2]);
+    shell[3] = make_yee_range(beg[0],end[0],       in_end[1],end[1],    in_beg[2],in_end[2]);
+    shell[0] = make_yee_range(beg[0],in_beg[0],    in_beg[1],in_end[1], in_beg[2],in_end[2]);
+    shell[1] = make_yee_range(in_end[0],end[0],    in_beg[1],in_end[1], in_beg[2],in_end[2]);
+}
+
+/**
+ * @brief Update one component over its range.
+ *
+ * Must be called from inside an OpenMP parallel region: the loop is shared between
+ * the threads of the team (orphaned 'omp for', no implicit barrier at the end).
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+void update_yee_component(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    const YeeRange                           &range
+);
+
+/**
+ * @brief Update the three components of a field (H or E), tile by tile.
+ *
+ * The bounding box of the three ranges is cut into tiles of tile_size[0] x tile_size[1] x tile_size[2]
+ * nodes (0 means the whole box in this direction). Each thread updates the three components inside
+ * its tiles, so that the nodes of the other field shared by the three components stay in cache.
+ * Each node is updated exactly once with the same formula, so the result is identical to three
+ * calls to update_yee_component.
+ *
+ * Must be called from inside an OpenMP parallel region (orphaned 'omp for', no implicit barrier at the end).
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+void update_yee_field_tiled(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> comp [3],
+    const YeeRange                           range[3],
+    const size_t                             tile_size[3]
+);
+
+/**
+ * @brief Same as update_yee_field_tiled, but all the tiles are updated by the calling thread
+ *        (no 'omp for'). Used when each thread owns a part of the domain (e.g. a slab of planes).
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+void update_yee_field_by_this_thread(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> comp [3],
+    const YeeRange                           range[3],
+    const size_t                             tile_size[3]
+);
+
+/**
+ * @brief Same as above, but the coefficient storage is chosen at runtime.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+inline void update_yee_component(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    bool                                      coefficients_per_material,
+    const YeeRange                           &range)
+{
+    if(coefficients_per_material){
+        update_yee_component<true >(comp,range);
+    }else{
+        update_yee_component<false>(comp,range);
+    }
+}
+
+template<typename FIELD_TYPE, typename COEF_TYPE>
+inline void update_yee_field_tiled(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> comp [3],
+    bool                                     coefficients_per_material,
+    const YeeRange                           range[3],
+    const size_t                             tile_size[3])
+{
+    if(coefficients_per_material){
+        update_yee_field_tiled<true >(comp,range,tile_size);
+    }else{
+        update_yee_field_tiled<false>(comp,range,tile_size);
+    }
+}
+
+template<typename FIELD_TYPE, typename COEF_TYPE>
+inline void update_yee_field_by_this_thread(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> comp [3],
+    bool                                     coefficients_per_material,
+    const YeeRange                           range[3],
+    const size_t                             tile_size[3])
+{
+    if(coefficients_per_material){
+        update_yee_field_by_this_thread<true >(comp,range,tile_size);
+    }else{
+        update_yee_field_by_this_thread<false>(comp,range,tile_size);
+    }
+}
+
+/**
+ * @brief Set to zero the array of the component 'component' (0, 1, 2 for x, y, z) of a field, of
+ *        size[0] x size[1] x size[2] nodes, each OpenMP thread setting the nodes it updates.
+ *
+ * The threads share the tiles of update_yee_field_tiled over 'range' (the ranges of the three components
+ * of the field, as given to the kernel) with the same 'omp for schedule(static) collapse(3)', or the rows
+ * of range[component] as update_yee_component when the three tile sizes are 0. The nodes outside of the
+ * tiles (e.g. the first and last ones of each direction) go with the first or last tile of their direction.
+ * Used for the first touch of the arrays of the nodes (see new_yee_array_first_touch).
+ * Must be called outside of any OpenMP parallel region (it opens its own).
+ */
+template<typename T>
+void first_touch_zero_yee(
+    T              *array,
+    const size_t   *size,
+    const YeeRange  range[3],
+    unsigned int    component,
+    const size_t    tile_size[3]
+);
+
+/**
+ * @brief Index of the first node set to zero by the thread 'thread' (out of 'nbr_threads') in
+ *        first_touch_zero_yee, or size[0] * size[1] * size[2] if the thread has no node.
+ */
+inline size_t first_node_of_thread_yee(
+    const size_t   *size,
+    const YeeRange  range[3],
+    unsigned int    component,
+    const size_t    tile_size[3],
+    size_t          thread,
+    size_t          nbr_threads
+);
+
+/**
+ * @brief Same as new_aligned_array_first_touch, the nodes being set to zero by first_touch_zero_yee,
+ *        so that the pages of each thread's tiles are on the NUMA node of the thread.
+ * Must be freed with delete_aligned_array.
+ */
+template<typename T>
+T *new_yee_array_first_touch(
+    const size_t   *size,
+    const YeeRange  range[3],
+    unsigned int    component,
+    const size_t    tile_size[3])
+{
+    return new_aligned_array_first_touch<T>(size,[&](T *array){
+        first_touch_zero_yee(array,size,range,component,tile_size);
+    });
+}
+
+#include "YeeKernels.tpp"
+
+#endif
@@ -0,0 +1,714 @@
+/* Template definitions of the Yee kernels (included by YeeKernels.hpp) */
+
+/**
+ * @brief Offsets of the (+) and (-) nodes of a difference along the direction DIR (0 = x, 1 = y, 2 = z),
+ *        in an array of size size_x * size_y * size_z. FORWARD: nodes (+1) and (0), otherwise (0) and (-1).
+ */
+template<int DIR, bool FORWARD>
+inline void yee_curl_offsets(
+    size_t size_x, size_t size_y,
+    ptrdiff_t &offset_Plus, ptrdiff_t &offset_Moins)
+{
+    ptrdiff_t stride = DIR == 0 ? 1 : (DIR == 1 ? (ptrdiff_t)size_x : (ptrdiff_t)(size_x * size_y));
+    offset_Plus  = FORWARD ? stride : 0;
+    offset_Moins = FORWARD ? 0 : -stride;
+}
+
+/**
+ * Attributes of the scalar kernels. The code is compiled with -Ofast: without them, GCC may reassociate
+ * the update (e.g. differently in the loops with the coefficients of a uniform row, or when vectorizing),
+ * and the kernels would not give the same result.
+ */
+#define YEE_SCALAR_FUNCTION __attribute__((optimize("no-associative-math","fp-contract=off")))
+
+/**
+ * @brief Update the node (I,J,K) of the component ID.
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, YeeComponentID ID, typename FIELD_TYPE, typename COEF_TYPE>
+inline YEE_SCALAR_FUNCTION void update_yee_node(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I, size_t J, size_t K)
+{
+    size_t index   = I + comp.size_x   * ( J + comp.size_y   * K);
+    size_t index_1 = I + comp.size_x_1 * ( J + comp.size_y_1 * K);
+    size_t index_2 = I + comp.size_x_2 * ( J + comp.size_y_2 * K);
+
+    ptrdiff_t offset_1Plus, offset_1Moins, offset_2Plus, offset_2Moins;
+    yee_curl_offsets<YeeStencil<ID>::CURL_DIR_1,YeeStencil<ID>::FORWARD>(
+        comp.size_x_1,comp.size_y_1,offset_1Plus,offset_1Moins);
+    yee_curl_offsets<YeeStencil<ID>::CURL_DIR_2,YeeStencil<ID>::FORWARD>(
+        comp.size_x_2,comp.size_y_2,offset_2Plus,offset_2Moins);
+
+    ASSERT(index,<,comp.size_x*comp.size_y*comp.size_z);
+    ASSERT(index_1 + offset_1Plus ,<,comp.size_x_1*comp.size_y_1*comp.size_z_1);
+    ASSERT(index_1 + offset_1Moins,<,comp.size_x_1*comp.size_y_1*comp.size_z_1);
+    ASSERT(index_2 + offset_2Plus ,<,comp.size_x_2*comp.size_y_2*comp.size_z_2);
+    ASSERT(index_2 + offset_2Moins,<,comp.size_x_2*comp.size_y_2*comp.size_z_2);
+
+    /// Index inside the coefficient arrays:
+    size_t coef = COEFFICIENTS_PER_MATERIAL ? comp.material[index] : index;
+
+    /// Computed in COEF_TYPE, rounded to FIELD_TYPE when stored:
+    comp.field[index] = static_cast<FIELD_TYPE>(
+              comp.C_self[coef] * static_cast<COEF_TYPE>(comp.field[index])
+            + comp.C_curl_1[coef] * (static_cast<COEF_TYPE>(comp.curl_1[index_1 + offset_1Plus])
+                                   - static_cast<COEF_TYPE>(comp.curl_1[index_1 + offset_1Moins]))
+            - comp.C_curl_2[coef] * (static_cast<COEF_TYPE>(comp.curl_2[index_2 + offset_2Plus])
+                                   - static_cast<COEF_TYPE>(comp.curl_2[index_2 + offset_2Moins])));
+}
+
+/**
+ * @brief Same as update_yee_node, for a node of a uniform row (see classify_yee_uniform_rows):
+ *        the coefficients are given, so that no coefficient is loaded.
+ */
+template<YeeComponentID ID, typename FIELD_TYPE, typename COEF_TYPE>
+inline YEE_SCALAR_FUNCTION void update_yee_node_uniform(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I, size_t J, size_t K,
+    COEF_TYPE C_self, COEF_TYPE C_curl_1, COEF_TYPE C_curl_2)
+{
+    size_t index   = I + comp.size_x   * ( J + comp.size_y   * K);
+    size_t index_1 = I + comp.size_x_1 * ( J + comp.size_y_1 * K);
+    size_t index_2 = I + comp.size_x_2 * ( J + comp.size_y_2 * K);
+
+    ptrdiff_t offset_1Plus, offset_1Moins, offset_2Plus, offset_2Moins;
+    yee_curl_offsets<YeeStencil<ID>::CURL_DIR_1,YeeStencil<ID>::FORWARD>(
+        comp.size_x_1,comp.size_y_1,offset_1Plus,offset_1Moins);
+    yee_curl_offsets<YeeStencil<ID>::CURL_DIR_2,YeeStencil<ID>::FORWARD>(
+        comp.size_x_2,comp.size_y_2,offset_2Plus,offset_2Moins);
+
+    ASSERT(index,<,comp.size_x*comp.size_y*comp.size_z);
+
+    comp.field[index] = static_cast<FIELD_TYPE>(
+              C_self * static_cast<COEF_TYPE>(comp.field[index])
+            + C_curl_1 * (static_cast<COEF_TYPE>(comp.curl_1[index_1 + offset_1Plus])
+                        - static_cast<COEF_TYPE>(comp.curl_1[index_1 + offset_1Moins]))
+            - C_curl_2 * (static_cast<COEF_TYPE>(comp.curl_2[index_2 + offset_2Plus])
+                        - static_cast<COEF_TYPE>(comp.curl_2[index_2 + offset_2Moins])));
+}
+
+/**
+ * @brief Index, inside the coefficient arrays, of the node 'index' of the component.
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+inline size_t yee_coef_index(const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp, size_t index){
+    return COEFFICIENTS_PER_MATERIAL ? comp.material[index] : index;
+}
+
+/**
+ * @brief Update the nodes I_beg <= I < I_end of the row (J,K), one node at a time.
+ *        UNIFORM: the coefficients are the same for the whole row, they are only read once.
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, bool UNIFORM, YeeComponentID ID, typename FIELD_TYPE, typename COEF_TYPE>
+inline YEE_SCALAR_FUNCTION void update_yee_row_scalar(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I_beg, size_t I_end,
+    size_t J, size_t K)
+{
+    if(I_beg >= I_end){
+        return;
+    }
+    if(UNIFORM){
+        size_t coef = yee_coef_index<COEFFICIENTS_PER_MATERIAL>(
+            comp,I_beg + comp.size_x * ( J + comp.size_y * K));
+        const COEF_TYPE C_self   = comp.C_self  [coef];
+        const COEF_TYPE C_curl_1 = comp.C_curl_1[coef];
+        const COEF_TYPE C_curl_2 = comp.C_curl_2[coef];
+        for(size_t I = I_beg ; I < I_end ; I ++){
+            update_yee_node_uniform<ID>(comp,I,J,K,C_self,C_curl_1,C_curl_2);
+        }
+        return;
+    }
+    for(size_t I = I_beg ; I < I_end ; I ++){
+        update_yee_node<COEFFICIENTS_PER_MATERIAL,ID>(comp,I,J,K);
+    }
+}
+
+#undef YEE_SCALAR_FUNCTION
+
+#ifdef YEE_KERNELS_X86_SIMD
+
+/// Attributes of the functions used by the AVX2 and AVX-512 kernels (no FMA and no reassociation, as
+/// the scalar kernels, see YEE_SIMD_ROW_BODY):
+#define YEE_AVX2_FUNCTION   __attribute__((target("avx2")   ,optimize("no-associative-math","fp-contract=off")))
+#define YEE_AVX512_FUNCTION __attribute__((target("avx512f"),optimize("no-associative-math","fp-contract=off")))
+
+/**
+ * @brief Loads and stores of the AVX2 kernel, for fields of type FIELD_TYPE updated in COEF_TYPE.
+ *
+ * 'vec' holds LANES nodes in COEF_TYPE. The fields are converted from/to FIELD_TYPE when loaded/stored.
+ * gather_coef reads the per-material coefficients of LANES consecutive nodes, broadcast_coef
+ * copies the coefficient of a uniform row in all the lanes.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+struct YeeAVX2;
+
+template<>
+struct YeeAVX2<double,double>{
+    typedef __m256d vec;
+    static const size_t LANES = 4;
+
+    static inline YEE_AVX2_FUNCTION vec load_field(const double *p){
+        return _mm256_loadu_pd(p);
+    }
+    static inline YEE_AVX2_FUNCTION void store_field(double *p, vec v){
+        _mm256_storeu_pd(p,v);
+    }
+    static inline YEE_AVX2_FUNCTION vec load_coef(const double *p){
+        return _mm256_loadu_pd(p);
+    }
+    static inline YEE_AVX2_FUNCTION vec broadcast_coef(double c){
+        return _mm256_set1_pd(c);
+    }
+    static inline YEE_AVX2_FUNCTION vec gather_coef(const double *table, const unsigned char *material){
+        int materials;
+        memcpy(&materials,material,sizeof(int));
+        __m128i coef = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(materials));
+        __m256d all  = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        return _mm256_mask_i32gather_pd(_mm256_setzero_pd(),table,coef,all,8);
+    }
+};
+
+template<>
+struct YeeAVX2<float,double> : public YeeAVX2<double,double>{
+    static inline YEE_AVX2_FUNCTION vec load_field(const float *p){
+        return _mm256_cvtps_pd(_mm_loadu_ps(p));
+    }
+    static inline YEE_AVX2_FUNCTION void store_field(float *p, vec v){
+        _mm_storeu_ps(p,_mm256_cvtpd_ps(v));
+    }
+};
+
+template<>
+struct YeeAVX2<float,float>{
+    typedef __m256 vec;
+    static const size_t LANES = 8;
+
+    static inline YEE_AVX2_FUNCTION vec load_field(const float *p){
+        return _mm256_loadu_ps(p);
+    }
+    static inline YEE_AVX2_FUNCTION void store_field(float *p, vec v){
+        _mm256_storeu_ps(p,v);
+    }
+    static inline YEE_AVX2_FUNCTION vec load_coef(const float *p){
+        return _mm256_loadu_ps(p);
+    }
+    static inline YEE_AVX2_FUNCTION vec broadcast_coef(float c){
+        return _mm256_set1_ps(c);
+    }
+    static inline YEE_AVX2_FUNCTION vec gather_coef(const float *table, const unsigned char *material){
+        __m256i coef = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(material)));
+        __m256  all  = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        return _mm256_mask_i32gather_ps(_mm256_setzero_ps(),table,coef,all,4);
+    }
+};
+
+/**
+ * @brief Same as YeeAVX2, for the AVX-512 kernel.
+ */
+template<typename FIELD_TYPE, typename COEF_TYPE>
+struct YeeAVX512;
+
+template<>
+struct YeeAVX512<double,double>{
+    typedef __m512d vec;
+    static const size_t LANES = 8;
+
+    static inline YEE_AVX512_FUNCTION vec load_field(const double *p){
+        return _mm512_loadu_pd(p);
+    }
+    static inline YEE_AVX512_FUNCTION void store_field(double *p, vec v){
+        _mm512_storeu_pd(p,v);
+    }
+    static inline YEE_AVX512_FUNCTION vec load_coef(const double *p){
+        return _mm512_loadu_pd(p);
+    }
+    static inline YEE_AVX512_FUNCTION vec broadcast_coef(double c){
+        return _mm512_set1_pd(c);
+    }
+    static inline YEE_AVX512_FUNCTION vec gather_coef(const double *table, const unsigned char *material){
+        __m256i coef = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(material)));
+        return _mm512_mask_i32gather_pd(_mm512_setzero_pd(),0xFF,coef,table,8);
+    }
+};
+
+template<>
+struct YeeAVX512<float,double> : public YeeAVX512<double,double>{
+    static inline YEE_AVX512_FUNCTION vec load_field(const float *p){
+        return _mm512_maskz_cvtps_pd(0xFF,_mm256_loadu_ps(p));
+    }
+    static inline YEE_AVX512_FUNCTION void store_field(float *p, vec v){
+        _mm256_storeu_ps(p,_mm512_maskz_cvtpd_ps(0xFF,v));
+    }
+};
+
+template<>
+struct YeeAVX512<float,float>{
+    typedef __m512 vec;
+    static const size_t LANES = 16;
+
+    static inline YEE_AVX512_FUNCTION vec load_field(const float *p){
+        return _mm512_loadu_ps(p);
+    }
+    static inline YEE_AVX512_FUNCTION void store_field(float *p, vec v){
+        _mm512_storeu_ps(p,v);
+    }
+    static inline YEE_AVX512_FUNCTION vec load_coef(const float *p){
+        return _mm512_loadu_ps(p);
+    }
+    static inline YEE_AVX512_FUNCTION vec broadcast_coef(float c){
+        return _mm512_set1_ps(c);
+    }
+    static inline YEE_AVX512_FUNCTION vec gather_coef(const float *table, const unsigned char *material){
+        __m512i coef = _mm512_maskz_cvtepu8_epi32(0xFFFF,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(material)));
+        return _mm512_mask_i32gather_ps(_mm512_setzero_ps(),0xFFFF,coef,table,4);
+    }
+};
+
+/**
+ * @brief Body of update_yee_row_avx2 and update_yee_row_avx512, V::LANES nodes at a time
+ *        (V is YeeAVX2 or YeeAVX512).
+ *
+ * The operations are done in the same order as in update_yee_node (no FMA), so that the
+ * result is identical to the scalar kernel. A uniform row (UNIFORM) broadcasts its coefficients
+ * once instead of loading (or gathering) them for each node. The arithmetic uses the vector extensions of GCC,
+ * so that the same code serves the double and float vectors.
+ */
+#define YEE_SIMD_ROW_BODY                                                                       \
+    size_t index   = I_beg + comp.size_x   * ( J + comp.size_y   * K);                          \
+    size_t index_1 = I_beg + comp.size_x_1 * ( J + comp.size_y_1 * K);                          \
+    size_t index_2 = I_beg + comp.size_x_2 * ( J + comp.size_y_2 * K);                          \
+                                                                                                \
+    ASSERT(index   + (I_end - I_beg),<=,comp.size_x*comp.size_y*comp.size_z);                   \
+                                                                                                \
+    ptrdiff_t offset_1Plus, offset_1Moins, offset_2Plus, offset_2Moins;                         \
+    yee_curl_offsets<YeeStencil<ID>::CURL_DIR_1,YeeStencil<ID>::FORWARD>(                       \
+        comp.size_x_1,comp.size_y_1,offset_1Plus,offset_1Moins);                                \
+    yee_curl_offsets<YeeStencil<ID>::CURL_DIR_2,YeeStencil<ID>::FORWARD>(                       \
+        comp.size_x_2,comp.size_y_2,offset_2Plus,offset_2Moins);                                \
+                                                                                                \
+    FIELD_TYPE       * __restrict__ field  = comp.field + index;                                \
+    const FIELD_TYPE * __restrict__ A_plus = comp.curl_1 + index_1 + offset_1Plus;              \
+    const FIELD_TYPE * __restrict__ A_mins = comp.curl_1 + index_1 + offset_1Moins;             \
+    const FIELD_TYPE * __restrict__ B_plus = comp.curl_2 + index_2 + offset_2Plus;              \
+    const FIELD_TYPE * __restrict__ B_mins = comp.curl_2 + index_2 + offset_2Moins;             \
+                                                                                                \
+    size_t nbr_nodes = I_end - I_beg;                                                           \
+    size_t n = 0;                                                                               \
+                                                                                                \
+    /* Coefficients of a uniform row, read once: */                                             \
+    typename V::vec C_self_uniform   = V::broadcast_coef(0);                                    \
+    typename V::vec C_curl_1_uniform = V::broadcast_coef(0);                                    \
+    typename V::vec C_curl_2_uniform = V::broadcast_coef(0);                                    \
+    if(UNIFORM){                                                                                \
+        size_t coef = yee_coef_index<COEFFICIENTS_PER_MATERIAL>(comp,index);                    \
+        C_self_uniform   = V::broadcast_coef(comp.C_self  [coef]);                              \
+        C_curl_1_uniform = V::broadcast_coef(comp.C_curl_1[coef]);                              \
+        C_curl_2_uniform = V::broadcast_coef(comp.C_curl_2[coef]);                              \
+    }                                                                                           \
+                                                                                                \
+    for( ; n + V::LANES <= nbr_nodes ; n += V::LANES){                                          \
+                                                                                                \
+        typename V::vec curl_1 = V::load_field(A_plus + n) - V::load_field(A_mins + n);         \
+        typename V::vec curl_2 = V::load_field(B_plus + n) - V::load_field(B_mins + n);         \
+                                                                                                \
+        typename V::vec result;                                                                 \
+                                                                                                \
+        if(UNIFORM){                                                                            \
+            result = C_self_uniform * V::load_field(field + n);                                 \
+            result = result + C_curl_1_uniform * curl_1;                                        \
+            result = result - C_curl_2_uniform * curl_2;                                        \
+        }else{                                                                                  \
+            typename V::vec C_self, C_curl_1, C_curl_2;                                         \
+                                                                                                \
+            if(COEFFICIENTS_PER_MATERIAL){                                                      \
+                C_self   = V::gather_coef(comp.C_self  ,comp.material + index + n);             \
+                C_curl_1 = V::gather_coef(comp.C_curl_1,comp.material + index + n);             \
+                C_curl_2 = V::gather_coef(comp.C_curl_2,comp.material + index + n);             \
+            }else{                                                                              \
+                C_self   = V::load_coef(comp.C_self   + index + n);                             \
+                C_curl_1 = V::load_coef(comp.C_curl_1 + index + n);                             \
+                C_curl_2 = V::load_coef(comp.C_curl_2 + index + n);                             \
+            }                                                                                   \
+                                                                                                \
+            result = C_self * V::load_field(field + n);                                         \
+            result = result + C_curl_1 * curl_1;                                                \
+            result = result - C_curl_2 * curl_2;                                                \
+        }                                                                                       \
+                                                                                                \
+        V::store_field(field + n,result);                                                       \
+    }                                                                                           \
+                                                                                                \
+    /* Remaining nodes of the row: */                                                           \
+    update_yee_row_scalar<COEFFICIENTS_PER_MATERIAL,UNIFORM,ID>(comp,I_beg + n,I_end,J,K);
+
+/**
+ * @brief Same as update_yee_row_scalar, 4 (double) or 8 (float) nodes at a time (AVX2).
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, bool UNIFORM, YeeComponentID ID, typename FIELD_TYPE, typename COEF_TYPE>
+YEE_AVX2_FUNCTION
+void update_yee_row_avx2(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I_beg, size_t I_end,
+    size_t J, size_t K)
+{
+    typedef YeeAVX2<FIELD_TYPE,COEF_TYPE> V;
+    YEE_SIMD_ROW_BODY
+}
+
+/**
+ * @brief Same as update_yee_row_scalar, 8 (double) or 16 (float) nodes at a time (AVX-512).
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, bool UNIFORM, YeeComponentID ID, typename FIELD_TYPE, typename COEF_TYPE>
+YEE_AVX512_FUNCTION
+void update_yee_row_avx512(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I_beg, size_t I_end,
+    size_t J, size_t K)
+{
+    typedef YeeAVX512<FIELD_TYPE,COEF_TYPE> V;
+    YEE_SIMD_ROW_BODY
+}
+
+#undef YEE_SIMD_ROW_BODY
+#undef YEE_AVX2_FUNCTION
+#undef YEE_AVX512_FUNCTION
+
+#endif
+
+/**
+ * @brief Update the nodes I_beg <= I < I_end of the row (J,K) of the component ID,
+ *        with the instruction set of the component.
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, bool UNIFORM, YeeComponentID ID, typename FIELD_TYPE, typename COEF_TYPE>
+inline void update_yee_row_with_isa(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I_beg, size_t I_end,
+    size_t J, size_t K)
+{
+    #ifdef YEE_KERNELS_X86_SIMD
+    if(comp.isa == YEE_SIMD_AVX512){
+        update_yee_row_avx512<COEFFICIENTS_PER_MATERIAL,UNIFORM,ID>(comp,I_beg,I_end,J,K);
+        return;
+    }
+    if(comp.isa == YEE_SIMD_AVX2){
+        update_yee_row_avx2<COEFFICIENTS_PER_MATERIAL,UNIFORM,ID>(comp,I_beg,I_end,J,K);
+        return;
+    }
+    #endif
+    update_yee_row_scalar<COEFFICIENTS_PER_MATERIAL,UNIFORM,ID>(comp,I_beg,I_end,J,K);
+}
+
+/**
+ * @brief Update the nodes I_beg <= I < I_end of the row (J,K) of the component ID,
+ *        with the constant-coefficient kernel if the row is uniform.
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, YeeComponentID ID, typename FIELD_TYPE, typename COEF_TYPE>
+inline void update_yee_row_of_component(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I_beg, size_t I_end,
+    size_t J, size_t K)
+{
+    if(comp.uniform_row != NULL && comp.uniform_row[J + comp.size_y * K]){
+        update_yee_row_with_isa<COEFFICIENTS_PER_MATERIAL,true ,ID>(comp,I_beg,I_end,J,K);
+    }else{
+        update_yee_row_with_isa<COEFFICIENTS_PER_MATERIAL,false,ID>(comp,I_beg,I_end,J,K);
+    }
+}
+
+/**
+ * @brief Update the nodes I_beg <= I < I_end of the row (J,K), with the kernel specialised
+ *        for the component.
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+inline void update_yee_row(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    size_t I_beg, size_t I_end,
+    size_t J, size_t K)
+{
+    switch(comp.id){
+        case YEE_HX: update_yee_row_of_component<COEFFICIENTS_PER_MATERIAL,YEE_HX>(comp,I_beg,I_end,J,K); break;
+        case YEE_HY: update_yee_row_of_component<COEFFICIENTS_PER_MATERIAL,YEE_HY>(comp,I_beg,I_end,J,K); break;
+        case YEE_HZ: update_yee_row_of_component<COEFFICIENTS_PER_MATERIAL,YEE_HZ>(comp,I_beg,I_end,J,K); break;
+        case YEE_EX: update_yee_row_of_component<COEFFICIENTS_PER_MATERIAL,YEE_EX>(comp,I_beg,I_end,J,K); break;
+        case YEE_EY: update_yee_row_of_component<COEFFICIENTS_PER_MATERIAL,YEE_EY>(comp,I_beg,I_end,J,K); break;
+        case YEE_EZ: update_yee_row_of_component<COEFFICIENTS_PER_MATERIAL,YEE_EZ>(comp,I_beg,I_end,J,K); break;
+    }
+}
+
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+void update_yee_component(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> &comp,
+    const YeeRange                           &range)
+{
+    if(range.I_beg >= range.I_end){
+        return;
+    }
+
+    #pragma omp for schedule(static) collapse(2) nowait
+    for(size_t K = range.K_beg ; K < range.K_end ; K ++){
+        for(size_t J = range.J_beg ; J < range.J_end ; J ++){
+            update_yee_row<COEFFICIENTS_PER_MATERIAL>(comp,range.I_beg,range.I_end,J,K);
+        }
+    }
+}
+
+/**
+ * @brief Tiles of the bounding box of the three ranges (see update_yee_field_tiled).
+ */
+typedef struct YeeTiling{
+    size_t box_beg  [3];
+    size_t tile     [3];
+    size_t nbr_tiles[3];
+}YeeTiling;
+
+inline YeeTiling make_yee_tiling(
+    const YeeRange range[3],
+    const size_t   tile_size[3])
+{
+    YeeTiling tiling;
+
+    /// Bounding box of the three components:
+    size_t box_end[3] = {range[0].I_end,range[0].J_end,range[0].K_end};
+    tiling.box_beg[0] = range[0].I_beg;
+    tiling.box_beg[1] = range[0].J_beg;
+    tiling.box_beg[2] = range[0].K_beg;
+    for(unsigned int c = 1 ; c < 3 ; c ++){
+        tiling.box_beg[0] = std::min(tiling.box_beg[0],range[c].I_beg);
+        tiling.box_beg[1] = std::min(tiling.box_beg[1],range[c].J_beg);
+        tiling.box_beg[2] = std::min(tiling.box_beg[2],range[c].K_beg);
+        box_end[0] = std::max(box_end[0],range[c].I_end);
+        box_end[1] = std::max(box_end[1],range[c].J_end);
+        box_end[2] = std::max(box_end[2],range[c].K_end);
+    }
+
+    /// Size and number of tiles in each direction:
+    for(unsigned int d = 0 ; d < 3 ; d ++){
+        size_t extent = box_end[d] > tiling.box_beg[d] ? box_end[d] - tiling.box_beg[d] : 0;
+        tiling.tile[d] = (tile_size[d] == 0 || tile_size[d] > extent) ? extent : tile_size[d];
+        if(tiling.tile[d] == 0){
+            tiling.tile[d] = 1;
+        }
+        tiling.nbr_tiles[d] = (extent + tiling.tile[d] - 1) / tiling.tile[d];
+    }
+    return tiling;
+}
+
+/**
+ * @brief Update the three components inside the tile (tI,tJ,tK).
+ */
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+inline void update_yee_tile(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> comp [3],
+    const YeeRange                           range[3],
+    const YeeTiling                          &tiling,
+    size_t tI, size_t tJ, size_t tK)
+{
+    size_t tile_beg[3] = {
+        tiling.box_beg[0] + tI * tiling.tile[0],
+        tiling.box_beg[1] + tJ * tiling.tile[1],
+        tiling.box_beg[2] + tK * tiling.tile[2]
+    };
+
+    for(unsigned int c = 0 ; c < 3 ; c ++){
+        size_t I_beg = std::max(tile_beg[0],range[c].I_beg);
+        size_t J_beg = std::max(tile_beg[1],range[c].J_beg);
+        size_t K_beg = std::max(tile_beg[2],range[c].K_beg);
+        size_t I_end = std::min(tile_beg[0] + tiling.tile[0],range[c].I_end);
+        size_t J_end = std::min(tile_beg[1] + tiling.tile[1],range[c].J_end);
+        size_t K_end = std::min(tile_beg[2] + tiling.tile[2],range[c].K_end);
+
+        if(I_beg >= I_end){
+            continue;
+        }
+        for(size_t K = K_beg ; K < K_end ; K ++){
+            for(size_t J = J_beg ; J < J_end ; J ++){
+                update_yee_row<COEFFICIENTS_PER_MATERIAL>(comp[c],I_beg,I_end,J,K);
+            }
+        }
+    }
+}
+
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+void update_yee_field_tiled(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> comp [3],
+    const YeeRange                           range[3],
+    const size_t                             tile_size[3])
+{
+    YeeTiling tiling = make_yee_tiling(range,tile_size);
+
+    #pragma omp for schedule(static) collapse(3) nowait
+    for(size_t tK = 0 ; tK < tiling.nbr_tiles[2] ; tK ++){
+        for(size_t tJ = 0 ; tJ < tiling.nbr_tiles[1] ; tJ ++){
+            for(size_t tI = 0 ; tI < tiling.nbr_tiles[0] ; tI ++){
+                update_yee_tile<COEFFICIENTS_PER_MATERIAL>(comp,range,tiling,tI,tJ,tK);
+            }
+        }
+    }
+}
+
+template<bool COEFFICIENTS_PER_MATERIAL, typename FIELD_TYPE, typename COEF_TYPE>
+void update_yee_field_by_this_thread(
+    const YeeComponent<FIELD_TYPE,COEF_TYPE> comp [3],
+    const YeeRange                           range[3],
+    const size_t                             tile_size[3])
+{
+    YeeTiling tiling = make_yee_tiling(range,tile_size);
+
+    for(size_t tK = 0 ; tK < tiling.nbr_tiles[2] ; tK ++){
+        for(size_t tJ = 0 ; tJ < tiling.nbr_tiles[1] ; tJ ++){
+            for(size_t tI = 0 ; tI < tiling.nbr_tiles[0] ; tI ++){
+                update_yee_tile<COEFFICIENTS_PER_MATERIAL>(comp,range,tiling,tI,tJ,tK);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tiles shared by the threads in first_touch_zero_yee: those of update_yee_field_tiled, or the rows
+ *        of update_yee_component (tiles of one row) when the three tile sizes are 0.
+ */
+inline YeeTiling make_yee_first_touch_tiling(
+    const YeeRange range[3],
+    unsigned int   component,
+    const size_t   tile_size[3])
+{
+    if(tile_size[0] != 0 || tile_size[1] != 0 || tile_size[2] != 0){
+        return make_yee_tiling(range,tile_size);
+    }
+    const YeeRange rows[3]     = {range[component],range[component],range[component]};
+    const size_t   row_size[3] = {0,1,1};
+    return make_yee_tiling(rows,row_size);
+}
+
+/**
+ * @brief Nodes [beg,end) of an array of size[0] x size[1] x size[2] nodes set to zero with the tile (tI,tJ,tK).
+ *        The first and last tiles of each direction go to the beginning and to the end of the array.
+ */
+inline void yee_first_touch_bounds(
+    const YeeTiling &tiling,
+    const size_t    *size,
+    size_t tI, size_t tJ, size_t tK,
+    size_t beg[3],
+    size_t end[3])
+{
+    const size_t tile_index[3] = {tI,tJ,tK};
+    for(unsigned int d = 0 ; d < 3 ; d ++){
+        const size_t t = tile_index[d];
+        beg[d] = t == 0                       ? 0       : tiling.box_beg[d] + t * tiling.tile[d];
+        end[d] = t + 1 == tiling.nbr_tiles[d] ? size[d] : tiling.box_beg[d] + (t + 1) * tiling.tile[d];
+        end[d] = std::min(end[d],size[d]);
+        beg[d] = std::min(beg[d],end[d]);
+    }
+}
+
+template<typename T>
+void first_touch_zero_yee(
+    T              *array,
+    const size_t   *size,
+    const YeeRange  range[3],
+    unsigned int    component,
+    const size_t    tile_size[3])
+{
+    const YeeTiling tiling = make_yee_first_touch_tiling(range,component,tile_size);
+
+    /// Nothing updated (e.g. an empty range): the rows are shared as in first_touch_zero.
+    if(tiling.nbr_tiles[0] == 0 || tiling.nbr_tiles[1] == 0 || tiling.nbr_tiles[2] == 0){
+        first_touch_zero(array,size);
+        return;
+    }
+
+    #pragma omp parallel for default(none) shared(array,size,tiling) schedule(static) collapse(3)
+    for(size_t tK = 0 ; tK < tiling.nbr_tiles[2] ; tK ++){
+        for(size_t tJ = 0 ; tJ < tiling.nbr_tiles[1] ; tJ ++){
+            for(size_t tI = 0 ; tI < tiling.nbr_tiles[0] ; tI ++){
+                size_t beg[3];
+                size_t end[3];
+                yee_first_touch_bounds(tiling,size,tI,tJ,tK,beg,end);
+                for(size_t K = beg[2] ; K < end[2] ; K ++){
+                    for(size_t J = beg[1] ; J < end[1] ; J ++){
+                        memset(array + beg[0] + size[0] * ( J + size[1] * K),0,(end[0] - beg[0]) * sizeof(T));
+                    }
+                }
+            }
+        }
+    }
+}
+
+inline size_t first_node_of_thread_yee(
+    const size_t   *size,
+    const YeeRange  range[3],
+    unsigned int    component,
+    const size_t    tile_size[3],
+    size_t          thread,
+    size_t          nbr_threads)
+{
+    const size_t    nbr_nodes = size[0] * size[1] * size[2];
+    const YeeTiling tiling    = make_yee_first_touch_tiling(range,component,tile_size);
+    const size_t    nbr_tiles = tiling.nbr_tiles[0] * tiling.nbr_tiles[1] * tiling.nbr_tiles[2];
+
+    if(nbr_tiles == 0){
+        size_t first_row = omp_static_chunk_begin(size[1] * size[2],thread,nbr_threads);
+        return first_row < size[1] * size[2] ? first_row * size[0] : nbr_nodes;
+    }
+
+    /// Tiles of the thread with 'omp for schedule(static)', in the order of the collapsed loop (tK,tJ,tI):
+    for(size_t tile  = omp_static_chunk_begin(nbr_tiles,thread  ,nbr_threads) ;
+               tile  < omp_static_chunk_begin(nbr_tiles,thread+1,nbr_threads) ; tile ++){
+        size_t beg[3];
+        size_t end[3];
+        yee_first_touch_bounds(tiling,size,
+            tile % tiling.nbr_tiles[0],
+            (tile / tiling.nbr_tiles[0]) % tiling.nbr_tiles[1],
+            tile / (tiling.nbr_tiles[0] * tiling.nbr_tiles[1]),
+            beg,end);
+        if(beg[0] < end[0] && beg[1] < end[1] && beg[2] < end[2]){
+            return beg[0] + size[0] * ( beg[1] + size[1] * beg[2]);
+        }
+    }
+    return nbr_nodes;
+}
+
+template<typename COEF_TYPE>
+size_t classify_yee_uniform_rows(
+    const COEF_TYPE     *C_self,
+    const COEF_TYPE     *C_curl_1,
+    const COEF_TYPE     *C_curl_2,
+    const unsigned char *material,
+    const size_t        *size,
+    unsigned char       *uniform_row)
+{
+    const size_t size_x = size[0];
+    const size_t size_y = size[1];
+    const size_t size_z = size[2];
+
+    size_t nbr_uniform_rows = 0;
+
+    #pragma omp parallel for schedule(static) collapse(2) reduction(+:nbr_uniform_rows)
+    for(size_t K = 0 ; K < size_z ; K ++){
+        for(size_t J = 0 ; J < size_y ; J ++){
+
+            /// Only the nodes 1 <= I < size_x-1 are updated (the first and last ones are neighbours):
+            bool is_uniform = size_x > 2;
+
+            size_t index = 1 + size_x * ( J + size_y * K);
+            size_t first = material != NULL ? material[index] : index;
+
+            for(size_t I = 1 ; is_uniform && I < size_x - 1 ; I ++){
+                size_t coef = material != NULL ? material[index + I - 1] : index + I - 1;
+                is_uniform = C_self  [coef] == C_self  [first]
+                          && C_curl_1[coef] == C_curl_1[first]
+                          && C_curl_2[coef] == C_curl_2[first];
+            }
+
+            uniform_row[J + size_y * K] = is_uniform ? 1 : 0;
+            if(is_uniform){
+                nbr_uniform_rows ++;
+            }
+        }
+    }
+    return nbr_uniform_rows;
+}
@@ -8,6 +8,8 @@
 #include <vector>
 #include <iostream>
 #include <map>
+#include <iterator>
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 #include "swapbytes.h"
@@ -20,6 +22,12 @@
 
 #include "omp.h"
 
+#if defined(__SSE__)
+// the buffers of the fields are filled with non-temporal stores:
+#define VTL_STREAMING_STORES
+#include <xmmintrin.h>
+#endif
+
 using namespace vtl;
 
 #ifdef USE_ZLIB
@@ -30,6 +38,9 @@ using namespace vtl;
 #define uLongf size_t
 #endif
 
+// size of the blocks compressed separately (and in parallel) by zlib, in bytes (as VTK):
+#define VTL_ZLIB_BLOCK_SIZE 32768
+
 const int __one__ = 1;
 const bool isCpuLittleEndian = 1 == *(char *)(&__one__); // CPU endianness
 
@@ -278,20 +289,88 @@ size_t write_vectorXML(std::ofstream &f, std::vector<double> const &pos, bool us
     return written;
 }
 
-size_t write_vectorXML_custom_GridCreatorNew(
-    std::ofstream &f, 
+// copies n floats to dst with non-temporal stores (where dst is aligned on 16 bytes): the
+//  buffers of the fields are only read again to be compressed or written, after the whole field
+
+static inline void stream_floats(float *dst, const float *src, size_t n)
+{
+#ifdef VTL_STREAMING_STORES
+    size_t i = 0;
+    for (; i < n && ((uintptr_t)(dst + i) & 15) != 0; ++i)
+        dst[i] = src[i];
+    for (; i + 4 <= n; i += 4)
+        _mm_stream_ps(dst + i, _mm_loadu_ps(src + i));
+    for (; i < n; ++i)
+        dst[i] = src[i];
+#else
+    std::memcpy(dst, src, n * sizeof(float));
+#endif
+}
+
+// fills the interleaved buffer of a vector field (E or H) in one pass, row by row along x: the three
+//  components of a row are gathered in a small row of the thread (which stays in cache), and the row
+//  is then streamed to the buffer. The rows are shared by the OpenMP threads.
+//  Only the nodes of this process are written (not the ghost layers). The nodes missing in a
+//  staggered component (at the end of the whole grid) are set to 0.
+
+template<typename FIELD_TYPE>
+void fill_interleaved_buffer(
+    GridCreator_NEW &grid,
+    FIELD_TYPE *const component[3],
+    const std::vector<size_t> *const size_component[3],
+    float *buffer)
+{
+    const std::vector<size_t> &size = grid.sizes_EH;
+    const std::vector<size_t> &before = grid.ghost_layers_before;
+    const std::vector<size_t> &after  = grid.ghost_layers_after;
+
+    // Number of nodes of each component written along x, y and z (at most the nodes of this process):
+    size_t nbr_nodes[3][3];
+    for (unsigned int c = 0; c < 3; ++c)
+        for (unsigned int d = 0; d < 3; ++d)
+            nbr_nodes[c][d] = (*size_component[c])[d] - before[d] - after[d];
+
+    #pragma omp parallel
+    {
+        std::vector<float> row(3 * size[0]);
+
+        #pragma omp for collapse(2) schedule(static)
+        for (size_t K = 0; K < size[2]; ++K)
+        {
+            for (size_t J = 0; J < size[1]; ++J)
+            {
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    const std::vector<size_t> &size_c = *size_component[c];
+                    size_t nbr_I = (J < nbr_nodes[c][1] && K < nbr_nodes[c][2]) ? nbr_nodes[c][0] : 0;
+                    const FIELD_TYPE *src = component[c]
+                        + before[0] + size_c[0] * (J + before[1] + size_c[1] * (K + before[2]));
+
+                    for (size_t I = 0; I < nbr_I; ++I)
+                        row[3 * I + c] = (float)src[I];
+                    for (size_t I = nbr_I; I < size[0]; ++I)
+                        row[3 * I + c] = 0.0f;
+                }
+                stream_floats(buffer + 3 * size[0] * (J + size[1] * K), row.data(), row.size());
+            }
+        }
+#ifdef VTL_STREAMING_STORES
+        _mm_sfence();
+#endif
+    }
+}
+
+// fills 'buffer' with the nodes of this process of a field of the grid, as floats
+//  (components interleaved for the vector fields), and returns its number of floats
+//  (also used to take the snapshots of the asynchronous outputs, see InterfaceToParaviewer)
+//  The buffer is only reallocated if the number of nodes of this process changes.
+
+VTL_API size_t vtl::fill_buffer_custom_GridCreatorNew(
     GridCreator_NEW &grid, 
     std::string fieldName, 
     char vecORsca, 
-    bool usez)
+    std::vector<float> &buffer)
 {
-    check_omp_nested_enabled();
-    // Size written in file:
-    size_t written = 0;
-
-    // Buffer of floats:
-    std::vector<float> buffer;
-
     // Size of the written field:
     size_t size_field = 0;
     
@@ -309,22 +388,9 @@ size_t write_vectorXML_custom_GridCreatorNew(
             size_field = size[0]*size[1]*size[2];
             buffer.resize(size_field);
 
-            size_t index   = 0;
-
-            size_t I,J,K;
-
-            for(K = 0 ; K < size[2] ; K ++){
-                for(J = 0 ; J < size[1] ; J ++){
-                    for(I = 0 ; I < size[0] ; I ++){
-
-                        index = I + size[0] * (J + K * size[1]);
-
-                        ASSERT(index,<,grid.size_Thermal[0]*grid.size_Thermal[1]*grid.size_Thermal[2]);
-
-                        buffer[index] = (float)grid.temperature[index];
-                        
-                    }
-                }
+            #pragma omp parallel for schedule(static)
+            for(size_t index = 0 ; index < size_field ; index ++){
+                buffer[index] = (float)grid.temperature[index];
             }
 
         }else{
@@ -333,182 +399,70 @@ size_t write_vectorXML_custom_GridCreatorNew(
         }
     }else if(vecORsca == 'v'){
         // Example: electric and magnetic fields:
-        if(fieldName == "ElectricField"){
-
-            #ifndef NDEBUG
-                std::cout << "\n\t>>> Writing VTI electric field...\n";
-            #endif
-
-            // Get size M, N, P:
-            std::vector<size_t> size = grid.sizes_EH;
-            
-            // Get the sizes:
-            // Ex of size (M − 1) × N × P
-            // Ey of size M × (N − 1) × P
-            // Ez of size M × N × (P − 1)
-
-            size_field = ( size[0] * size[1] * size[2] ) * 3;
-            
-            buffer.resize(size_field);
-
-            size_t index   = 0;
-            size_t buff_index = 0;
-
-            size_t I,J,K;
-
-
-            // EX field:
-            for(K = 1 ; K < grid.size_Ex[2]-1 ; K ++){
-                for(J = 1 ; J < grid.size_Ex[1]-1 ; J ++ ){
-                    for(I = 1 ; I < grid.size_Ex[0]-1 ; I ++){
-
-                        
-
-                        index = I + grid.size_Ex[0] * ( J + grid.size_Ex[1] * K );
-                        ASSERT(index,<,grid.size_Ex[0]*grid.size_Ex[1]*grid.size_Ex[2]);
-
-                        buff_index = I-1 + grid.sizes_EH[0] * ( J-1 + grid.sizes_EH[1] * (K-1) );
-                        ASSERT(buff_index,<,buffer.size());
-
-                        buffer[3*buff_index] = grid.E_x[index];
-                        
-                    }
-                }
-            }
-
-            // EY field:
-            for(size_t K = 1 ; K < grid.size_Ey[2]-1 ; K ++){
-                for(size_t J = 1 ; J < grid.size_Ey[1]-1 ; J ++ ){
-                    for(size_t I = 1 ; I < grid.size_Ey[0]-1 ; I ++){
-
-                        index = I + grid.size_Ey[0] * ( J + grid.size_Ey[1] * K );
-                        ASSERT(index,<,grid.size_Ey[0]*grid.size_Ey[1]*grid.size_Ey[2]);
-
-                        buff_index = I-1 + grid.sizes_EH[0] * ( J-1 + grid.sizes_EH[1] * (K-1) );
-                        ASSERT(buff_index,<,buffer.size());
-
-                        buffer[3*buff_index+1] = grid.E_y[index];
-                        
-                    }
-                }
-            }
-
-            // EZ field:
-            for(size_t K = 1 ; K < grid.size_Ez[2]-1 ; K ++){
-                for(size_t J = 1 ; J < grid.size_Ez[1]-1 ; J ++ ){
-                    for(size_t I = 1 ; I < grid.size_Ez[0]-1 ; I ++){
-
-                        index = I + grid.size_Ez[0] * ( J + grid.size_Ez[1] * K );
-                        ASSERT(index,<,grid.size_Ez[0]*grid.size_Ez[1]*grid.size_Ez[2]);
-
-                        buff_index = I-1 + grid.sizes_EH[0] * ( J-1 + grid.sizes_EH[1] * (K-1) );
-                        ASSERT(buff_index,<,buffer.size());
-
-                        buffer[3*buff_index+2] = grid.E_z[index];
-                
-                    }
-                }
-            }
-
-            // END OF ELECTRIC FIELD
-
-        }else if(fieldName == "MagneticField"){
-
-            const size_t DECALAGE_H = 1;
-
-            std::vector<size_t> size = grid.sizes_EH;
-
-            #ifndef NDEBUG
-                std::cout << "\n\t>>> Writing VTI magnetic field...\n";
-            #endif
-
-            // Get the sizes:
-            // Hx of size M × (N − 1) × (P − 1)
-            // Hy of size (M − 1) × N × (P − 1)
-            // Hz of size (M − 1) × (N − 1) × P
-
-            size_field = (size[0])*
-                    (size[1])*(size[2])*3;
-
-            buffer.resize(size_field);
-
-            size_t index   = 0;
-            size_t buff_index = 0;
-
-            size_t I,J,K;
-
-            const size_t RM = 1;
-
-            // HX field:
-            for(K = 1 ; K < grid.size_Hx[2]-DECALAGE_H ; K ++){
-                for(J = 1 ; J < grid.size_Hx[1]-DECALAGE_H ; J ++ ){
-                    for(I = 1 ; I < grid.size_Hx[0]-DECALAGE_H ; I ++){
-
-                        index = I + grid.size_Hx[0] * ( J + grid.size_Hx[1] * K );
-                        ASSERT(index,<,grid.size_Hx[0]*grid.size_Hx[1]*grid.size_Hx[2]);
-
-                        buff_index = I-RM
-                                + grid.sizes_EH[0] * ( J-RM
-                                    + grid.sizes_EH[1] * (K-RM) );
-
-                        ASSERT(buff_index,<,buffer.size());
-
-                        buffer[3*buff_index] = grid.H_x[index];
-                        
-                    }
-                }
-            }
-
-            // HY field:
-            for(K = 1 ; K < grid.size_Hy[2]-DECALAGE_H ; K ++){
-                for(J = 1 ; J < grid.size_Hy[1]-DECALAGE_H ; J ++ ){
-                    for(I = 1 ; I < grid.size_Hy[0]-DECALAGE_H ; I ++){
-
-                        index = I + grid.size_Hy[0] * ( J + grid.size_Hy[1] * K );
-                        ASSERT(index,<,grid.size_Hy[0]*grid.size_Hy[1]*grid.size_Hy[2]);
-
-                        buff_index = I-RM
-                                + grid.sizes_EH[0] * ( J-RM
-                                     + grid.sizes_EH[1] * (K-RM) );
-
-                        ASSERT(buff_index,<,buffer.size());
-
-                        buffer[3*buff_index+1] = grid.H_y[index];
-                        
-                    }
-                }
-            }
-
-            // HZ field:
-            for(size_t K = 1 ; K < grid.size_Hz[2]-DECALAGE_H ; K ++){
-                for(size_t J = 1 ; J < grid.size_Hz[1]-DECALAGE_H ; J ++ ){
-                    for(size_t I = 1 ; I < grid.size_Hz[0]-DECALAGE_H ; I ++){
-
-                        index = I + grid.size_Hz[0] * ( J + grid.size_Hz[1] * K );
-                        ASSERT(index,<,grid.size_Hz[0]*grid.size_Hz[1]*grid.size_Hz[2]);
-
-                        buff_index = I-RM
-                                + grid.sizes_EH[0] * ( J-RM
-                                     + grid.sizes_EH[1] * (K-RM) );
-                        ASSERT(buff_index,<,buffer.size());
-
-                        buffer[3*buff_index+2] = grid.H_z[index];
-                        
-                    }
-                }
-            }
+        bool is_electric = fieldName == "ElectricField";
+        if(!is_electric && fieldName != "MagneticField"){
+            printf("vtl::write_vectorXML_custom::ERROR in vector field name. Has %s\n",fieldName.c_str());
+            std::abort();
+        }
 
-            /* END OF MAGNETIC FIELD */
+        #ifndef NDEBUG
+            std::cout << "\n\t>>> Writing VTI " << (is_electric ? "electric" : "magnetic") << " field...\n";
+        #endif
 
+        // Get the sizes:
+        // Ex of size (M − 1) × N × P,     Hx of size M × (N − 1) × (P − 1)
+        // Ey of size M × (N − 1) × P,     Hy of size (M − 1) × N × (P − 1)
+        // Ez of size M × N × (P − 1),     Hz of size (M − 1) × (N − 1) × P
+        const std::vector<size_t> *size_component[3] = {
+            is_electric ? &grid.size_Ex : &grid.size_Hx,
+            is_electric ? &grid.size_Ey : &grid.size_Hy,
+            is_electric ? &grid.size_Ez : &grid.size_Hz};
+
+        size_field = ( grid.sizes_EH[0] * grid.sizes_EH[1] * grid.sizes_EH[2] ) * 3;
+        buffer.resize(size_field);
+
+        if(grid.fields_in_float){
+            float *E[3], *H[3];
+            grid.get_field_arrays(E,H);
+            fill_interleaved_buffer(grid, is_electric ? E : H, size_component, buffer.data());
         }else{
-            printf("vtl::write_vectorXML_custom::ERROR in vector field name. Has %s\n",fieldName.c_str());
-            std::abort();
+            double *E[3], *H[3];
+            grid.get_field_arrays(E,H);
+            fill_interleaved_buffer(grid, is_electric ? E : H, size_component, buffer.data());
         }
+
     }else{
         printf("vtl::write_vectorXML_custom::ERROR on vecORsca\n");
         std::abort();
     }
 
+    return size_field;
+}
+
+// sends a field of the grid in binary XML/format into stream f
+//  snapshot: nodes of the field gathered beforehand, or NULL to gather them from the grid
+
+size_t write_vectorXML_custom_GridCreatorNew(
+    std::ostream &f, 
+    GridCreator_NEW &grid, 
+    std::string fieldName, 
+    char vecORsca, 
+    bool usez,
+    std::vector<float> const *snapshot)
+{
+    check_omp_nested_enabled();
+    // Size written in file:
+    size_t written = 0;
+
+    // Buffer of floats, allocated once per thread and reused at each output:
+    static thread_local std::vector<float> gathered;
+    if (snapshot == NULL)
+        fill_buffer_custom_GridCreatorNew(grid,fieldName,vecORsca,gathered);
+    std::vector<float> const &buffer = snapshot == NULL ? gathered : *snapshot;
+
+    // Size of the written field:
+    size_t size_field = buffer.size();
+
     if (!usez)
     {
         // data block size
@@ -522,42 +476,66 @@ size_t write_vectorXML_custom_GridCreatorNew(
     }
     else
     {
-        //uLong sourcelen = (uLong)pos.size() * sizeof(float);
+        // the buffer is cut into blocks of VTL_ZLIB_BLOCK_SIZE bytes (the last one may be smaller),
+        // which are compressed in parallel, then written one after the other
         uLong sourcelen = (uLong) size_field * sizeof(float);
-        uLongf destlen = uLongf(sourcelen * 1.001) + 12; // see doc
-        char *destbuffer = new char[destlen];
+        size_t nblocks = (sourcelen + VTL_ZLIB_BLOCK_SIZE - 1) / VTL_ZLIB_BLOCK_SIZE;
+        int level = grid.input_parser.OUTPUT_COMPRESSION_LEVEL;
 #ifdef USE_ZLIB
-        int status = compress2((Bytef *)destbuffer, &destlen,
-                               (Bytef *)&(buffer[0]), sourcelen, Z_DEFAULT_COMPRESSION);
+        uLongf destblocklen = compressBound(VTL_ZLIB_BLOCK_SIZE);
 #else
-        int status = Z_OK + 1;
+        uLongf destblocklen = 0;
 #endif
+        std::vector<char> destbuffer(nblocks * destblocklen);
+        std::vector<uLongf> destlen(nblocks,destblocklen);
+        int status = Z_OK;
+
+        #pragma omp parallel for schedule(dynamic)
+        for (long b = 0; b < (long)nblocks; ++b)
+        {
+            uLong blocklen = std::min((uLong)VTL_ZLIB_BLOCK_SIZE, sourcelen - b * VTL_ZLIB_BLOCK_SIZE);
+#ifdef USE_ZLIB
+            int block_status = compress2((Bytef *)&destbuffer[b * destblocklen], &destlen[b],
+                                   (Bytef *)&(buffer[0]) + b * VTL_ZLIB_BLOCK_SIZE, blocklen, level);
+#else
+            int block_status = Z_OK + 1;
+#endif
+            if (block_status != Z_OK)
+            {
+                #pragma omp critical
+                status = block_status;
+            }
+        }
+
         if (status != Z_OK)
         {
             std::cout << "ERROR: zlib Error status=" << zlibstatus(status) << "\n";
         }
         else
         {
-            //std::cout << "block of size " << sourcelen << " compressed to " << destlen << '\n';
             // blocks description
-            uint32_t nblocks = 1;
-            f.write((char *)&nblocks, sizeof(uint32_t));
+            uint32_t nblocks32 = (uint32_t)nblocks;
+            f.write((char *)&nblocks32, sizeof(uint32_t));
             written += sizeof(uint32_t);
-            uint32_t srclen = (uint32_t)sourcelen;
-            f.write((char *)&srclen, sizeof(uint32_t));
+            uint32_t blocklen = VTL_ZLIB_BLOCK_SIZE;
+            f.write((char *)&blocklen, sizeof(uint32_t));
             written += sizeof(uint32_t);
-            uint32_t lastblocklen = 0;
+            uint32_t lastblocklen = (uint32_t)(sourcelen % VTL_ZLIB_BLOCK_SIZE);
             f.write((char *)&lastblocklen, sizeof(uint32_t));
             written += sizeof(uint32_t);
-            uint32_t szblocki = (uint32_t)destlen;
-            f.write((char *)&szblocki, sizeof(uint32_t));
-            written += sizeof(uint32_t);
+            for (size_t b = 0; b < nblocks; ++b)
+            {
+                uint32_t szblocki = (uint32_t)destlen[b];
+                f.write((char *)&szblocki, sizeof(uint32_t));
+                written += sizeof(uint32_t);
+            }
             // data
-            f.write(destbuffer, destlen);
-            written += destlen;
+            for (size_t b = 0; b < nblocks; ++b)
+            {
+                f.write(&destbuffer[b * destblocklen], destlen[b]);
+                written += destlen[b];
+            }
         }
-
-        delete[] destbuffer;
     }
 
     return written;
@@ -1022,7 +1000,8 @@ VTL_API void vtl::export_spoints_XMLP(std::string const &filename,
 
         f << "Source=\"";
         std::stringstream s;
-        s << filename;
+        // the pieces are next to the .pvti file:
+        s << filename.substr(filename.rfind('/') + 1);
         
         s << "_r" << it->id;
         s << '_' << std::setw(8) << std::setfill('0') << step << ".vti";
@@ -1096,7 +1075,8 @@ VTL_API void vtl::export_spoints_XML_custom_GridCreator_NEW(
     vtl::SPoints &grid,
     vtl::SPoints &my_grid,
     GridCreator_NEW &grid_Creator_NEW,
-    Zip zip
+    Zip zip,
+    std::vector<std::vector<float> > const *snapshot
 ){
     if(strcmp(type.c_str(),"ELECTRO") == 0){
         /**
@@ -1109,7 +1089,8 @@ VTL_API void vtl::export_spoints_XML_custom_GridCreator_NEW(
             grid, 
             my_grid,
             grid_Creator_NEW,
-            zip);
+            zip,
+            snapshot);
     }else if(strcmp(type.c_str(),"THERMAL") == 0){
         /**
          * @brief The MPI process writes its thermal grid.
@@ -1121,20 +1102,26 @@ VTL_API void vtl::export_spoints_XML_custom_GridCreator_NEW(
             grid, 
             my_grid,
             grid_Creator_NEW,
-            zip);
+            zip,
+            snapshot);
     }else{
         fprintf(stderr,"File %s:%d\n",__FILE__,__LINE__);
         abort();
     }
 }
 
+/**
+ * @brief Writes the .vti file of this MPI process. The fields are gathered from the grid, or taken from
+ *        'snapshot' if given (in the order of mygrid.vectors or mygrid.scalars).
+ */
 VTL_API void vtl::export_spoints_XML_GridCreatorNew(
     std::string const &filename,
     size_t step,
     SPoints const &grid, 
     SPoints const &mygrid,
     GridCreator_NEW &grid_creatorObj,
-    Zip zip)
+    Zip zip,
+    std::vector<std::vector<float> > const *snapshot)
 {
 #if !defined(USE_ZLIB)
     if (zip==ZIPPED)
@@ -1155,18 +1142,14 @@ VTL_API void vtl::export_spoints_XML_GridCreatorNew(
         abort();
     }
     s << '_' << std::setw(8) << std::setfill('0') << step << ".vti";
-    std::stringstream s2;
-    s2 << filename;
-    if (mygrid.id >= 0)
-        s2 << "r_" << mygrid.id;
-    s2 << '_' << std::setw(8) << std::setfill('0') << step << ".vti.tmp";
 
     // open file
     #ifndef NDEBUG
         std::cout << "writing results to " << s.str() << '\n';
     #endif
     std::ofstream f(s.str().c_str(), std::ios::binary | std::ios::out);
-    std::ofstream f2(s2.str().c_str(), std::ios::binary | std::ios::out); // temp binary file
+    // the appended data is kept in memory until the header (with the offsets) is written
+    std::ostringstream f2(std::ios::binary | std::ios::out);
     f << std::scientific;
 
     size_t offset = 0;
@@ -1213,7 +1196,8 @@ VTL_API void vtl::export_spoints_XML_GridCreatorNew(
             f << " RangeMax=\"1\" ";
             f << " offset=\"" << offset << "\" />\n";
             offset += write_vectorXML_custom_GridCreatorNew(
-                f2, grid_creatorObj, it->first ,'s', (zip==ZIPPED));
+                f2, grid_creatorObj, it->first ,'s', (zip==ZIPPED),
+                snapshot == NULL ? NULL : &(*snapshot)[std::distance(mygrid.scalars.begin(),it)]);
         }
     }else if(filename.find("ELECTRO") != std::string::npos){
 
@@ -1231,7 +1215,8 @@ VTL_API void vtl::export_spoints_XML_GridCreatorNew(
             offset += write_vectorXML_custom_GridCreatorNew(f2, 
                         grid_creatorObj, 
                         it->first, 'v', 
-                        (zip==ZIPPED));
+                        (zip==ZIPPED),
+                        snapshot == NULL ? NULL : &(*snapshot)[std::distance(mygrid.vectors.begin(),it)]);
         }
     }else{
         fprintf(stderr,"Cannot find thermal or electro in the filename (has %s)\n",
@@ -1246,8 +1231,6 @@ VTL_API void vtl::export_spoints_XML_GridCreatorNew(
     f << "      <PointData>\n";
     f << "      </PointData>\n";
 
-    f2.close();
-
     // ------------------------------------------------------------------------------------
     f << "    </Piece>\n";
     f << "  </ImageData>\n";
@@ -1255,12 +1238,9 @@ VTL_API void vtl::export_spoints_XML_GridCreatorNew(
     f << "  <AppendedData encoding=\"raw\">\n";
     f << "    _";
 
-    // copy temp binary file as "appended" data
-    std::ifstream f3(s2.str().c_str(), std::ios::binary | std::ios::in);
-    f << f3.rdbuf();
-    f3.close();
-    // remove temp file
-    std::remove(s2.str().c_str());
+    // "appended" data, written after the header in the same pass
+    const std::string &appended = f2.str();
+    f.write(appended.data(), appended.size());
 
     f << "  </AppendedData>\n";
     f << "</VTKFile>\n";
@@ -1268,3 +1248,176 @@ VTL_API void vtl::export_spoints_XML_GridCreatorNew(
     f.close();
 }
 
+
+
+/**
+ * @brief Count given to an MPI-IO call for 'file'. The counts of MPI are int: aborts if 'count' does not fit.
+ */
+static int mpi_io_count(size_t count, std::string const &file)
+{
+    if(count > (size_t)INT_MAX){
+        fprintf(stderr,"In %s :: count %zu is too large for MPI-IO (%s). Aborting.\n",
+            __FUNCTION__,count,file.c_str());
+        fprintf(stderr,"In %s:%d\n",__FILE__,__LINE__);
+        MPI_Abort(MPI_COMM_WORLD,-1);
+    }
+    return (int)count;
+}
+
+/**
+ * @brief This function is called by all MPI processes, with GridCreator_NEW type: they write together
+ *        a single .vti file for the whole grid, with collective MPI-IO (no .pvti).
+ *
+ * The data is appended uncompressed (the nodes of a process are not contiguous in the arrays of the
+ * whole grid, so they cannot be put in zlib blocks). The root process writes the XML header, the
+ * size of each array and the end of the file. Each process writes its nodes inside each array, at
+ * the place given by its extent (see InterfaceToParaviewer::initializeAll).
+ * The fields are gathered from the grid, or taken from 'snapshot' if given. All the processes of
+ * 'comm' must call the function.
+ */
+VTL_API void vtl::export_spoints_XML_MPIIO_custom_GridCreator_NEW(
+    std::string type /* THERMAL or ELECTRO */,
+    std::string outputFileName,
+    size_t currentStep,
+    vtl::SPoints &grid,
+    vtl::SPoints &my_grid,
+    GridCreator_NEW &grid_Creator_NEW,
+    MPI_Comm comm,
+    std::vector<std::vector<float> > const *snapshot)
+{
+    /// Fields written, with their number of components:
+    std::vector<std::string> fieldNames;
+    char vecORsca;
+    if(strcmp(type.c_str(),"ELECTRO") == 0){
+        outputFileName.append("_ELECTRO");
+        for (auto it = my_grid.vectors.begin(); it != my_grid.vectors.end(); ++it){
+            fieldNames.push_back(it->first);
+        }
+        vecORsca = 'v';
+    }else if(strcmp(type.c_str(),"THERMAL") == 0){
+        outputFileName.append("_THERMAL");
+        for (auto it = my_grid.scalars.begin(); it != my_grid.scalars.end(); ++it){
+            fieldNames.push_back(it->first);
+        }
+        vecORsca = 's';
+    }else{
+        fprintf(stderr,"File %s:%d\n",__FILE__,__LINE__);
+        abort();
+    }
+    int nbr_components = vecORsca == 'v' ? 3 : 1;
+
+    /// Number of cells of the whole grid and of this process, and first cell of this process (z, y, x order):
+    int sizes[4], subsizes[4], starts[4];
+    for(int k = 0 ; k < 3 ; k ++){
+        sizes   [2-k] = grid.np2[k] - grid.np1[k];
+        subsizes[2-k] = my_grid.np2[k] - my_grid.np1[k];
+        starts  [2-k] = my_grid.np1[k] - grid.np1[k];
+    }
+    sizes[3] = subsizes[3] = nbr_components;
+    starts[3] = 0;
+    uint64_t size_array = (uint64_t)sizes[0] * sizes[1] * sizes[2] * nbr_components * sizeof(float);
+
+    // build file name + stepno + vtk extension
+    std::stringstream s;
+    s << outputFileName << '_' << std::setw(8) << std::setfill('0') << currentStep << ".vti";
+
+    /// The header is the same on all processes, which need its length:
+    std::stringstream f;
+    f << std::scientific;
+    f << "<?xml version=\"1.0\"?>\n";
+
+    f << "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"";
+    f << (isCpuLittleEndian ? "LittleEndian" : "BigEndian") << "\" ";
+    f << "header_type=\"UInt64\">\n";
+
+    f << "  <ImageData ";
+    f << "WholeExtent=\""
+      << grid.np1[0] << ' ' << grid.np2[0] << ' '
+      << grid.np1[1] << ' ' << grid.np2[1] << ' '
+      << grid.np1[2] << ' ' << grid.np2[2] << "\" ";
+    f << "Origin=\"" << grid.o[0] << ' ' << grid.o[1] << ' ' << grid.o[2] << "\" ";
+    f << "Spacing=\"" << grid.dx[0] << ' ' << grid.dx[1] << ' ' << grid.dx[2] << "\">\n";
+
+    f << "    <Piece ";
+    f << "Extent=\""
+      << grid.np1[0] << ' ' << grid.np2[0] << ' '
+      << grid.np1[1] << ' ' << grid.np2[1] << ' '
+      << grid.np1[2] << ' ' << grid.np2[2] << "\">\n";
+
+    f << "      <CellData>\n";
+    for(size_t a = 0 ; a < fieldNames.size() ; a ++){
+        f << "        <DataArray type=\"Float32\" ";
+        f << " Name=\"" << fieldNames[a] << "\" ";
+        if(vecORsca == 'v')
+            f << " NumberOfComponents=\"3\" ";
+        f << " format=\"appended\" ";
+        f << " offset=\"" << a * (sizeof(uint64_t) + size_array) << "\" />\n";
+    }
+    f << "      </CellData>\n";
+    f << "      <PointData>\n";
+    f << "      </PointData>\n";
+    f << "    </Piece>\n";
+    f << "  </ImageData>\n";
+    f << "  <AppendedData encoding=\"raw\">\n";
+    f << "    _";
+    std::string header = f.str();
+    std::string footer = "\n  </AppendedData>\n</VTKFile>\n";
+
+    MPI_Offset size_file = header.size() + fieldNames.size() * (sizeof(uint64_t) + size_array) + footer.size();
+
+    MPI_File file;
+    int status = MPI_File_open(comm,s.str().c_str(),MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                    MPI_INFO_NULL,&file);
+    if(status != MPI_SUCCESS){
+        fprintf(stderr,"In %s :: cannot open %s. Aborting.\n",__FUNCTION__,s.str().c_str());
+        fprintf(stderr,"In %s:%d\n",__FILE__,__LINE__);
+        MPI_Abort(MPI_COMM_WORLD,-1);
+    }
+    /// An older file of the same name may be longer:
+    MPI_File_set_size(file,size_file);
+
+    if(grid_Creator_NEW.MPI_communicator.isRootProcess() != INT_MIN){
+        MPI_File_write_at(file,0,header.c_str(),mpi_io_count(header.size(),s.str()),MPI_CHAR,MPI_STATUS_IGNORE);
+        for(size_t a = 0 ; a < fieldNames.size() ; a ++){
+            MPI_Offset offset = header.size() + a * (sizeof(uint64_t) + size_array);
+            MPI_File_write_at(file,offset,&size_array,1,MPI_UINT64_T,MPI_STATUS_IGNORE);
+        }
+        MPI_File_write_at(file,size_file - footer.size(),footer.c_str(),mpi_io_count(footer.size(),s.str()),
+            MPI_CHAR,MPI_STATUS_IGNORE);
+    }
+
+    /// Nodes of this process inside the arrays of the whole grid:
+    MPI_Datatype my_nodes;
+    MPI_Type_create_subarray(4,sizes,subsizes,starts,MPI_ORDER_C,MPI_FLOAT,&my_nodes);
+    MPI_Type_commit(&my_nodes);
+
+    /// The nodes of this process are written by rows along x, so that the count of the writes is the number
+    /// of rows (the number of floats of a process may not fit in an int):
+    size_t       row_size = (size_t)subsizes[2] * subsizes[3];
+    size_t       nbr_rows = (size_t)subsizes[0] * subsizes[1];
+    MPI_Datatype my_row;
+    MPI_Type_contiguous(mpi_io_count(row_size,s.str()),MPI_FLOAT,&my_row);
+    MPI_Type_commit(&my_row);
+
+    /// Buffer of floats, allocated once per thread and reused at each output:
+    static thread_local std::vector<float> gathered;
+    for(size_t a = 0 ; a < fieldNames.size() ; a ++){
+        if(snapshot == NULL)
+            fill_buffer_custom_GridCreatorNew(grid_Creator_NEW,fieldNames[a],vecORsca,gathered);
+        std::vector<float> const &buffer = snapshot == NULL ? gathered : (*snapshot)[a];
+        if(buffer.size() != nbr_rows * row_size){
+            fprintf(stderr,"In %s :: %zu floats for the %zu nodes of %s. Aborting.\n",
+                __FUNCTION__,buffer.size(),nbr_rows * row_size,fieldNames[a].c_str());
+            fprintf(stderr,"In %s:%d\n",__FILE__,__LINE__);
+            MPI_Abort(MPI_COMM_WORLD,-1);
+        }
+
+        MPI_Offset offset = header.size() + a * (sizeof(uint64_t) + size_array) + sizeof(uint64_t);
+        MPI_File_set_view(file,offset,MPI_FLOAT,my_nodes,"native",MPI_INFO_NULL);
+        MPI_File_write_all(file,buffer.data(),mpi_io_count(nbr_rows,s.str()),my_row,MPI_STATUS_IGNORE);
+    }
+
+    MPI_Type_free(&my_row);
+    MPI_Type_free(&my_nodes);
+    MPI_File_close(&file);
+}
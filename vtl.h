@@ -95,6 +95,12 @@ VTL_API void export_spoints_XMLP_custom_GridCreator_NEW(
 );
 
 
+VTL_API size_t fill_buffer_custom_GridCreatorNew(
+    GridCreator_NEW &grid, 
+    std::string fieldName, 
+    char vecORsca, 
+    std::vector<float> &buffer);
+
 VTL_API void export_spoints_XML_custom_GridCreator_NEW(
     std::string type /* THERMAL or ELECTRO */,
     std::string outputFileName,
@@ -102,7 +108,8 @@ VTL_API void export_spoints_XML_custom_GridCreator_NEW(
     vtl::SPoints &grid,
     vtl::SPoints &my_grid,
     GridCreator_NEW &grid_Creator_NEW,
-    Zip zip);
+    Zip zip,
+    std::vector<std::vector<float> > const *snapshot = NULL);
 
 VTL_API void export_spoints_XML_GridCreatorNew(
     std::string const &filename,
@@ -110,7 +117,18 @@ VTL_API void export_spoints_XML_GridCreatorNew(
     SPoints const &grid, 
     SPoints const &mygrid,
     GridCreator_NEW &grid_creatorObj,
-    Zip zip);
+    Zip zip,
+    std::vector<std::vector<float> > const *snapshot = NULL);
+
+VTL_API void export_spoints_XML_MPIIO_custom_GridCreator_NEW(
+    std::string type /* THERMAL or ELECTRO */,
+    std::string outputFileName,
+    size_t currentStep,
+    vtl::SPoints &grid,
+    vtl::SPoints &my_grid,
+    GridCreator_NEW &grid_Creator_NEW,
+    MPI_Comm comm,
+    std::vector<std::vector<float> > const *snapshot = NULL);
     
 
 /**